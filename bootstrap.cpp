@@ -0,0 +1,153 @@
+#include "bootstrap.h"
+
+#include <algorithm>  // max, min, nth_element
+#include <functional>
+#include <thread>
+
+BatchHistogram::BatchHistogram()
+    : count(result_size * bootstrap_batch_num, 0.0),
+      trial_count(bootstrap_batch_num, 0.0),
+      batch_num(0),
+      last_result(result_size, 0),
+      last_target_star6_count(0) {}
+
+void BatchHistogram::record_batch(const SimulationState& state) {
+  if (batch_num >= bootstrap_batch_num) {
+    return;
+  }
+  for (size_t i = 1; i < result_size; ++i) {
+    count[i * bootstrap_batch_num + batch_num] =
+        static_cast<double>(state.result[i] - last_result[i]);
+    last_result[i] = state.result[i];
+  }
+  trial_count[batch_num] =
+      static_cast<double>(state.target_star6_count - last_target_star6_count);
+  last_target_star6_count = state.target_star6_count;
+  batch_num++;
+}
+
+unsigned long long int simulate_in_batches(
+    const std::string& kernel_name, SimulationState& state,
+    const SimulationParameter& parameter, std::mt19937_64& mt,
+    PullDistribution& dist, unsigned long long int pull_time,
+    BatchHistogram& batch_histogram, const RunControl& run_control) {
+  // Runs shorter than bootstrap_batch_num pulls use a batch per pull
+  const unsigned long long int batch_num =
+      std::min<unsigned long long int>(bootstrap_batch_num, pull_time);
+  unsigned long long int completed_pull_time = 0;
+  for (unsigned long long int k = 0; k < batch_num; ++k) {
+    if (run_control.should_stop()) {
+      break;
+    }
+    // Spread the remainder over the first batches
+    const unsigned long long int batch_pull_time =
+        pull_time / batch_num + (k < pull_time % batch_num ? 1 : 0);
+    simulate(kernel_name, state, parameter, mt, dist, batch_pull_time);
+    batch_histogram.record_batch(state);
+    completed_pull_time += batch_pull_time;
+  }
+  return completed_pull_time;
+}
+
+// Return the value at the given quantile of values, which is reordered
+static double select_quantile(std::vector<double>& values, double quantile) {
+  const size_t index = static_cast<size_t>(quantile * (values.size() - 1) + 0.5);
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+// Calculate the intervals of the trial lengths in [begin, end). weight holds
+// how many times each batch is drawn by each resample
+static void calc_interval_range(const BatchHistogram& batch_histogram,
+                                const std::vector<double>& cumulated_count,
+                                const std::vector<double>& weight,
+                                const std::vector<double>& resample_trial_count,
+                                size_t begin, size_t end,
+                                BootstrapInterval& interval) {
+  const size_t resample_num = resample_trial_count.size();
+  const unsigned int batch_num = batch_histogram.batch_num;
+  const double tail = (1.0 - bootstrap_confidence_level) / 2.0;
+  std::vector<double> s(resample_num);
+  std::vector<double> w(resample_num);
+
+  for (size_t i = begin; i < end; ++i) {
+    const double* count = &batch_histogram.count[i * bootstrap_batch_num];
+    const double* cumulated = &cumulated_count[i * bootstrap_batch_num];
+    for (size_t b = 0; b < resample_num; ++b) {
+      const double* resample_weight = &weight[b * bootstrap_batch_num];
+      double s_count = 0.0;
+      double w_count = 0.0;
+      for (unsigned int k = 0; k < batch_num; ++k) {
+        s_count += resample_weight[k] * count[k];
+        w_count += resample_weight[k] * cumulated[k];
+      }
+      const double trial_count = resample_trial_count[b];
+      s[b] = trial_count > 0.0 ? 100.0 * s_count / trial_count : 0.0;
+      w[b] = trial_count > 0.0 ? 100.0 * w_count / trial_count : 0.0;
+    }
+    interval.lower_s[i] = select_quantile(s, tail);
+    interval.upper_s[i] = select_quantile(s, 1.0 - tail);
+    interval.lower_w[i] = select_quantile(w, tail);
+    interval.upper_w[i] = select_quantile(w, 1.0 - tail);
+  }
+}
+
+BootstrapInterval calc_bootstrap_interval(
+    const BatchHistogram& batch_histogram,
+    unsigned long long int resample_num, uint_fast64_t seed,
+    unsigned int thread_num) {
+  const unsigned int batch_num = batch_histogram.batch_num;
+
+  BootstrapInterval interval;
+  interval.resample_num = resample_num;
+  interval.batch_num = batch_num;
+  interval.lower_s.assign(result_size, 0.0);
+  interval.upper_s.assign(result_size, 0.0);
+  interval.lower_w.assign(result_size, 0.0);
+  interval.upper_w.assign(result_size, 0.0);
+  if (batch_num == 0 || resample_num == 0) {
+    return interval;
+  }
+
+  // Draw all resamples up front with a single generator, so that the
+  // intervals do not depend on the number of threads
+  std::mt19937_64 mt(seed);
+  std::uniform_int_distribution<unsigned int> batch_dist(0, batch_num - 1);
+  std::vector<double> weight(resample_num * bootstrap_batch_num, 0.0);
+  std::vector<double> resample_trial_count(resample_num, 0.0);
+  for (unsigned long long int b = 0; b < resample_num; ++b) {
+    for (unsigned int k = 0; k < batch_num; ++k) {
+      const unsigned int drawn = batch_dist(mt);
+      weight[b * bootstrap_batch_num + drawn] += 1.0;
+      resample_trial_count[b] += batch_histogram.trial_count[drawn];
+    }
+  }
+
+  // cumulated_count[i * bootstrap_batch_num + k]: times that a trial of at
+  // most i pulls finished in the k-th batch
+  std::vector<double> cumulated_count(batch_histogram.count.size(), 0.0);
+  for (size_t i = 1; i < result_size; ++i) {
+    for (unsigned int k = 0; k < batch_num; ++k) {
+      cumulated_count[i * bootstrap_batch_num + k] =
+          cumulated_count[(i - 1) * bootstrap_batch_num + k] +
+          batch_histogram.count[i * bootstrap_batch_num + k];
+    }
+  }
+
+  // Split the trial lengths across the threads
+  thread_num = std::max(1u, thread_num);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < thread_num; ++t) {
+    const size_t begin = 1 + (result_size - 1) * t / thread_num;
+    const size_t end = 1 + (result_size - 1) * (t + 1) / thread_num;
+    threads.push_back(std::thread(
+        calc_interval_range, std::cref(batch_histogram),
+        std::cref(cumulated_count), std::cref(weight),
+        std::cref(resample_trial_count), begin, end, std::ref(interval)));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return interval;
+}
@@ -0,0 +1,75 @@
+#ifndef BOOTSTRAP_H
+#define BOOTSTRAP_H
+
+#include <random>
+#include <vector>
+
+#include "run_control.h"
+#include "simulation_kernel.h"
+
+// Bootstrap confidence intervals of the estimated probabilities.
+//
+// The simulation is split into a fixed number of batches, and the part of
+// the result histogram that each batch contributes is recorded. After the
+// run, the batches are resampled with replacement, and Pr(S_i) and Pr(W_i)
+// of every resample are computed from the recorded histograms, so that no
+// extra pull needs to be simulated.
+
+// The number of batches that a run is split into
+const unsigned int bootstrap_batch_num = 100;
+// The maximum valid value of --bootstrap
+const unsigned long long int max_bootstrap_resample_num = 100000;
+// Confidence level of the reported percentile intervals
+const double bootstrap_confidence_level = 0.95;
+
+// The result histograms of the batches of a run
+class BatchHistogram {
+ public:
+  // count[i * bootstrap_batch_num + k]: times that a trial of i pulls
+  // finished in the k-th batch, stored by i so that the batches of the same
+  // trial length are contiguous
+  std::vector<double> count;
+  // trial_count[k]: number of trials finished in the k-th batch, including
+  // the rare events that the histogram does not cover
+  std::vector<double> trial_count;
+  // The number of batches recorded so far
+  unsigned int batch_num;
+
+  // The counters of the state when the previous batch finished
+  std::vector<unsigned long long int> last_result;
+  unsigned long long int last_target_star6_count;
+
+  BatchHistogram();
+
+  // Record what the state gained since the previous call as a new batch
+  void record_batch(const SimulationState& state);
+};
+
+// Percentile intervals of the estimated probabilities, indexed like
+// SimulationState::result, in percent
+class BootstrapInterval {
+ public:
+  unsigned long long int resample_num;
+  unsigned int batch_num;
+  std::vector<double> lower_s, upper_s;
+  std::vector<double> lower_w, upper_w;
+};
+
+// Run the kernel for pull_time pulls in bootstrap_batch_num batches, and
+// record the histogram of each batch into batch_histogram. Stops between the
+// batches if run_control says so. Return the number of pulls simulated
+unsigned long long int simulate_in_batches(
+    const std::string& kernel_name, SimulationState& state,
+    const SimulationParameter& parameter, std::mt19937_64& mt,
+    PullDistribution& dist, unsigned long long int pull_time,
+    BatchHistogram& batch_histogram, const RunControl& run_control);
+
+// Draw resample_num bootstrap resamples of the batches with a generator
+// seeded by seed, and calculate the percentile intervals of Pr(S_i) and
+// Pr(W_i) with thread_num threads
+BootstrapInterval calc_bootstrap_interval(
+    const BatchHistogram& batch_histogram,
+    unsigned long long int resample_num, uint_fast64_t seed,
+    unsigned int thread_num);
+
+#endif  // BOOTSTRAP_H
@@ -0,0 +1,593 @@
+#include "chunk_lease.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>  // strerror
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>  // min, max
+#include <cctype>     // isdigit, isspace
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+
+// Bytes of the type and the length of a message
+static const size_t chunk_message_header_size = 16;
+// Bytes read by one receive call
+static const size_t chunk_receive_size = 65536;
+// Pending connections of the listening socket
+static const int chunk_listen_backlog = 64;
+
+// The words of a result message before the result histogram
+static const size_t chunk_result_header_word_num = 5;
+
+ChunkLease::ChunkLease() : chunk_index(0), seed(0), pull_time(0) {}
+
+ChunkResult::ChunkResult()
+    : chunk_index(0),
+      pull_time(0),
+      elapsed_ns(0),
+      star6_count(0),
+      target_star6_count(0),
+      result(result_size, 0) {}
+
+ChunkLeaseTable::ChunkLeaseTable(unsigned long long int _total_pull_time,
+                                 unsigned long long int _chunk_pull_time,
+                                 unsigned long long int _seed)
+    : total_pull_time(_total_pull_time),
+      chunk_pull_time(_chunk_pull_time),
+      chunk_num(std::max(_total_pull_time / _chunk_pull_time, 1ULL)),
+      seed(_seed),
+      is_merged(chunk_num, false),
+      next_chunk_index(0),
+      merged_chunk_num(0),
+      merged_pull_time(0),
+      reissued_lease_num(0) {}
+
+bool ChunkLeaseTable::lease_next(ChunkLease& lease) {
+  // Skip the expired chunks that a slow worker has finished meanwhile
+  while (!expired_chunk.empty() && is_merged[expired_chunk.front()]) {
+    expired_chunk.pop_front();
+  }
+  if (!expired_chunk.empty()) {
+    lease.chunk_index = expired_chunk.front();
+    expired_chunk.pop_front();
+    reissued_lease_num++;
+  } else if (next_chunk_index < chunk_num) {
+    lease.chunk_index = next_chunk_index++;
+  } else {
+    return false;
+  }
+  lease.seed = derive_chunk_seed(seed, lease.chunk_index);
+  lease.pull_time = get_pull_time(lease.chunk_index);
+  return true;
+}
+
+unsigned long long int ChunkLeaseTable::get_pull_time(
+    unsigned long long int chunk_index) const {
+  // The last chunk also takes the pulls left over
+  return chunk_index + 1 < chunk_num
+             ? chunk_pull_time
+             : total_pull_time - chunk_index * chunk_pull_time;
+}
+
+void ChunkLeaseTable::expire(unsigned long long int chunk_index) {
+  if (!is_merged[chunk_index]) {
+    expired_chunk.push_back(chunk_index);
+  }
+}
+
+bool ChunkLeaseTable::merge(unsigned long long int chunk_index) {
+  if (is_merged[chunk_index]) {
+    return false;
+  }
+  is_merged[chunk_index] = true;
+  merged_chunk_num++;
+  merged_pull_time += get_pull_time(chunk_index);
+  return true;
+}
+
+bool ChunkLeaseTable::is_finished() const {
+  return merged_chunk_num == chunk_num;
+}
+
+unsigned long long int derive_chunk_seed(unsigned long long int seed,
+                                         unsigned long long int chunk_index) {
+  // The finalizer of splitmix64 on a Weyl sequence, so that the seeds of the
+  // neighbouring chunks share no bit pattern
+  unsigned long long int z = seed + (chunk_index + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+bool parse_chunk_address(const std::string& address, std::string& host,
+                         unsigned int& port) {
+  const size_t colon = address.rfind(':');
+  if (colon == std::string::npos || colon == 0 ||
+      colon + 1 == address.size() || address.size() - colon - 1 > 5) {
+    return false;
+  }
+  host = address.substr(0, colon);
+  // An IPv6 address is written in brackets, e.g., [::1]:7000
+  if (host.front() == '[' && host.back() == ']') {
+    host = host.substr(1, host.size() - 2);
+  }
+  if (host.empty()) {
+    return false;
+  }
+  for (char c : host) {
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      return false;
+    }
+  }
+  unsigned long int value = 0;
+  for (size_t i = colon + 1; i < address.size(); ++i) {
+    if (!std::isdigit(static_cast<unsigned char>(address[i]))) {
+      return false;
+    }
+    value = value * 10 + (address[i] - '0');
+  }
+  if (value > 65535) {
+    return false;
+  }
+  port = static_cast<unsigned int>(value);
+  return true;
+}
+
+bool is_valid_worker_address(const std::string& address) {
+  std::string host;
+  unsigned int port = 0;
+  return parse_chunk_address(address, host, port) && port != 0;
+}
+
+std::vector<unsigned long long int> encode_simulation_settings(
+    const SimulationParameter& parameter, const std::string& kernel_name,
+    bool recycle_bits) {
+  // The lanes kernel falls back to the branchy one without the tables
+  const bool is_lanes = kernel_name == kernel_lanes &&
+                        !parameter.star6_threshold_table.empty();
+  std::vector<unsigned long long int> words = {
+      is_lanes,
+      recycle_bits,
+      parameter.init_star6_threshold,
+      parameter.init_target_star6_threshold,
+      parameter.delta_star6_threshold,
+      parameter.delta_target_star6_threshold,
+      parameter.pity_starting_point,
+      parameter.current_pull,
+      parameter.has_pity_curve,
+      parameter.star6_threshold_table.size()};
+  words.insert(words.end(), parameter.star6_threshold_table.begin(),
+               parameter.star6_threshold_table.end());
+  words.insert(words.end(), parameter.target_star6_threshold_table.begin(),
+               parameter.target_star6_threshold_table.end());
+  return words;
+}
+
+std::vector<unsigned long long int> encode_worker_hello(
+    const SimulationParameter& parameter, const std::string& kernel_name,
+    bool recycle_bits) {
+  std::vector<unsigned long long int> words = {
+      chunk_lease_magic, chunk_lease_version,
+      static_cast<unsigned long long int>(getpid())};
+  const std::vector<unsigned long long int> settings =
+      encode_simulation_settings(parameter, kernel_name, recycle_bits);
+  words.insert(words.end(), settings.begin(), settings.end());
+  return words;
+}
+
+std::vector<unsigned long long int> encode_chunk_result(
+    const ChunkLease& lease, const SimulationState& state,
+    unsigned long long int elapsed_ns) {
+  std::vector<unsigned long long int> words = {
+      lease.chunk_index, lease.pull_time, elapsed_ns, state.star6_count,
+      state.target_star6_count};
+  words.insert(words.end(), state.result.begin(), state.result.end());
+  for (const auto& p : state.rare_event) {
+    words.push_back(p.first);
+    words.push_back(p.second);
+  }
+  return words;
+}
+
+bool decode_chunk_result(const std::vector<unsigned long long int>& words,
+                         ChunkResult& chunk_result) {
+  const size_t histogram_end = chunk_result_header_word_num + result_size;
+  if (words.size() < histogram_end ||
+      (words.size() - histogram_end) % 2 != 0) {
+    return false;
+  }
+  chunk_result.chunk_index = words[0];
+  chunk_result.pull_time = words[1];
+  chunk_result.elapsed_ns = words[2];
+  chunk_result.star6_count = words[3];
+  chunk_result.target_star6_count = words[4];
+  chunk_result.result.assign(words.begin() + chunk_result_header_word_num,
+                             words.begin() + histogram_end);
+  chunk_result.rare_event.assign(words.begin() + histogram_end, words.end());
+  return true;
+}
+
+void merge_chunk_result(SimulationState& state,
+                        const ChunkResult& chunk_result) {
+  state.star6_count += chunk_result.star6_count;
+  state.target_star6_count += chunk_result.target_star6_count;
+  for (size_t i = 0; i < result_size; ++i) {
+    state.result[i] += chunk_result.result[i];
+  }
+  for (size_t i = 0; i + 1 < chunk_result.rare_event.size(); i += 2) {
+    const unsigned long long int pull_count = chunk_result.rare_event[i];
+    if (state.rare_event.count(pull_count) > 0 ||
+        state.rare_event.size() < max_rare_event_map_size) {
+      state.rare_event[pull_count] += chunk_result.rare_event[i + 1];
+    }
+  }
+}
+
+// Store word into 8 bytes in little-endian order, and load it back
+static void store_word(unsigned long long int word, unsigned char* bytes) {
+  for (unsigned int i = 0; i < 8; ++i) {
+    bytes[i] = static_cast<unsigned char>(word >> (8 * i));
+  }
+}
+
+static unsigned long long int load_word(const unsigned char* bytes) {
+  unsigned long long int word = 0;
+  for (unsigned int i = 0; i < 8; ++i) {
+    word |= static_cast<unsigned long long int>(bytes[i]) << (8 * i);
+  }
+  return word;
+}
+
+ChunkConnection::ChunkConnection() : fd(-1) {}
+
+ChunkConnection::ChunkConnection(int _fd) : fd(_fd) {}
+
+bool ChunkConnection::connect(const std::string& address) {
+  std::string host;
+  unsigned int port = 0;
+  if (!parse_chunk_address(address, host, port)) {
+    unavailable_reason = "invalid address " + address;
+    return false;
+  }
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* addresses = nullptr;
+  const int error =
+      getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints,
+                  &addresses);
+  if (error != 0) {
+    unavailable_reason = std::string("getaddrinfo: ") + gai_strerror(error);
+    return false;
+  }
+  for (struct addrinfo* p = addresses; p != nullptr; p = p->ai_next) {
+    fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+    if (fd == -1) {
+      unavailable_reason = std::string("socket: ") + strerror(errno);
+      continue;
+    }
+    if (::connect(fd, p->ai_addr, p->ai_addrlen) == 0) {
+      break;
+    }
+    unavailable_reason = std::string("connect: ") + strerror(errno);
+    ::close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  if (fd == -1) {
+    return false;
+  }
+  // The messages are small and answered at once, hence are not delayed
+  const int enabled = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+  return true;
+}
+
+bool ChunkConnection::send_message(
+    unsigned long long int type,
+    const std::vector<unsigned long long int>& words) {
+  if (fd == -1) {
+    return false;
+  }
+  std::vector<unsigned char> bytes(chunk_message_header_size +
+                                   8 * words.size());
+  store_word(type, bytes.data());
+  store_word(words.size(), bytes.data() + 8);
+  for (size_t i = 0; i < words.size(); ++i) {
+    store_word(words[i], bytes.data() + chunk_message_header_size + 8 * i);
+  }
+  size_t sent = 0;
+  while (sent < bytes.size()) {
+    // A peer that is gone fails the call instead of raising SIGPIPE
+    const ssize_t n =
+        send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      unavailable_reason = std::string("send: ") + strerror(errno);
+      close();
+      return false;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool ChunkConnection::receive_available() {
+  if (fd == -1) {
+    return false;
+  }
+  unsigned char buffer[chunk_receive_size];
+  while (true) {
+    const ssize_t n = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (n > 0) {
+      received.insert(received.end(), buffer, buffer + n);
+    } else if (n == 0) {
+      unavailable_reason = "the connection is closed by the peer";
+      close();
+      return false;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return true;
+    } else if (errno != EINTR) {
+      unavailable_reason = std::string("recv: ") + strerror(errno);
+      close();
+      return false;
+    }
+  }
+}
+
+bool ChunkConnection::pop_message(unsigned long long int& type,
+                                  std::vector<unsigned long long int>& words) {
+  if (received.size() < chunk_message_header_size) {
+    return false;
+  }
+  const unsigned long long int word_num = load_word(received.data() + 8);
+  if (word_num > max_chunk_message_word_num) {
+    unavailable_reason = "a malformed message is received";
+    received.clear();
+    close();
+    return false;
+  }
+  const size_t message_size = chunk_message_header_size + 8 * word_num;
+  if (received.size() < message_size) {
+    return false;
+  }
+  type = load_word(received.data());
+  words.resize(word_num);
+  for (size_t i = 0; i < word_num; ++i) {
+    words[i] = load_word(received.data() + chunk_message_header_size + 8 * i);
+  }
+  received.erase(received.begin(), received.begin() + message_size);
+  return true;
+}
+
+bool ChunkConnection::receive_message(
+    unsigned long long int& type, std::vector<unsigned long long int>& words) {
+  unsigned char buffer[chunk_receive_size];
+  while (!pop_message(type, words)) {
+    if (fd == -1) {
+      return false;
+    }
+    const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      received.insert(received.end(), buffer, buffer + n);
+    } else if (n == 0) {
+      unavailable_reason = "the connection is closed by the peer";
+      close();
+      return false;
+    } else {
+      // Including EINTR, so that a stop signal is not ignored while waiting
+      unavailable_reason = std::string("recv: ") + strerror(errno);
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ChunkConnection::is_open() const { return fd != -1; }
+
+void ChunkConnection::close() {
+  if (fd != -1) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+// Display the chunks that this worker simulated for the coordinator, whose
+// results are merged and displayed by the coordinator
+static void display_worker_summary(unsigned long long int chunk_num,
+                                   unsigned long long int total_pull_time,
+                                   double busy_time) {
+  std::cout << "WORKER SUMMARY" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Chunks simulated: " << chunk_num << std::endl;
+  std::cout << "Pulls completed: " << total_pull_time << std::endl;
+  std::cout << "Time spent on the chunks: " << busy_time << "s" << std::endl;
+  if (busy_time > 0.0) {
+    std::cout << "Pulls per second: " << total_pull_time / busy_time
+              << std::endl;
+  }
+}
+
+// Simulate a leased chunk from a fresh state, reporting the progress after
+// every run_chunk_pull_time pulls. Return false if the chunk is not
+// finished, i.e., a stop signal is received or the coordinator is lost
+static bool simulate_chunk(ChunkConnection& connection,
+                           const ChunkLease& lease,
+                           const SimulationParameter& parameter,
+                           const std::string& kernel_name, bool recycle_bits,
+                           SimulationState& chunk_state) {
+  std::mt19937_64 chunk_mt(lease.seed);
+  PullDistribution chunk_dist(dist_left_border, dist_right_border);
+  RecycledPullGenerator chunk_generator(lease.seed);
+  unsigned long long int chunk_pull_time = 0;
+  while (chunk_pull_time < lease.pull_time && !is_stop_signal_received()) {
+    const unsigned long long int piece_pull_time =
+        std::min(run_chunk_pull_time, lease.pull_time - chunk_pull_time);
+    if (recycle_bits) {
+      simulate_recycled(kernel_name, chunk_state, parameter, chunk_generator,
+                        piece_pull_time);
+    } else {
+      simulate(kernel_name, chunk_state, parameter, chunk_mt, chunk_dist,
+               piece_pull_time);
+    }
+    chunk_pull_time += piece_pull_time;
+    if (chunk_pull_time < lease.pull_time &&
+        !connection.send_message(chunk_message_progress,
+                                 {lease.chunk_index, chunk_pull_time})) {
+      return false;
+    }
+  }
+  return chunk_pull_time == lease.pull_time;
+}
+
+bool run_chunk_worker(const std::string& address,
+                      const SimulationParameter& parameter,
+                      const std::string& kernel_name, bool recycle_bits) {
+  ChunkConnection connection;
+  if (!connection.connect(address)) {
+    std::cerr << "Cannot connect to the coordinator ("
+              << connection.unavailable_reason << ")\n"
+              << std::endl;
+    return false;
+  }
+  connection.send_message(
+      chunk_message_hello,
+      encode_worker_hello(parameter, kernel_name, recycle_bits));
+  std::cout << "Now will simulate the chunks leased by the coordinator...\n"
+            << std::endl;
+
+  // A stopped worker drops its current chunk, which the coordinator leases
+  // again to another worker
+  install_stop_signal_handler();
+
+  unsigned long long int chunk_num = 0;
+  unsigned long long int worker_pull_time = 0;
+  double busy_time = 0.0;
+  bool finished = false;
+  unsigned long long int type = 0;
+  std::vector<unsigned long long int> words;
+  while (!is_stop_signal_received() &&
+         connection.receive_message(type, words)) {
+    if (type == chunk_message_finish) {
+      finished = true;
+      break;
+    }
+    if (type == chunk_message_reject) {
+      std::cerr << "The coordinator rejected this worker - its banner "
+                   "settings, --kernel lanes or --recycle-bits differ from "
+                   "the ones of the other workers\n"
+                << std::endl;
+      break;
+    }
+    if (type != chunk_message_lease || words.size() != 3) {
+      std::cerr << "Note: An unexpected message is received from the "
+                   "coordinator, will stop\n"
+                << std::endl;
+      break;
+    }
+    ChunkLease lease;
+    lease.chunk_index = words[0];
+    lease.seed = words[1];
+    lease.pull_time = words[2];
+
+    SimulationState chunk_state(parameter);
+    const auto chunk_start = std::chrono::steady_clock::now();
+    if (!simulate_chunk(connection, lease, parameter, kernel_name,
+                        recycle_bits, chunk_state)) {
+      break;
+    }
+    const double chunk_time = std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() -
+                                  chunk_start)
+                                  .count();
+    if (!connection.send_message(
+            chunk_message_result,
+            encode_chunk_result(
+                lease, chunk_state,
+                static_cast<unsigned long long int>(chunk_time * 1e9)))) {
+      break;
+    }
+    chunk_num++;
+    worker_pull_time += lease.pull_time;
+    busy_time += chunk_time;
+  }
+  if (!finished && !connection.is_open() && !is_stop_signal_received()) {
+    std::cerr << "Note: Lost the coordinator ("
+              << connection.unavailable_reason << ")\n"
+              << std::endl;
+  }
+  connection.close();
+
+  if (is_stop_signal_received()) {
+    std::cout << "Note: Interrupted by a signal, the current chunk is "
+                 "dropped\n"
+              << std::endl;
+  }
+  display_worker_summary(chunk_num, worker_pull_time, busy_time);
+  return finished || is_stop_signal_received();
+}
+
+int open_chunk_listener(const std::string& address, unsigned int& port,
+                        std::string& reason) {
+  std::string host;
+  if (!parse_chunk_address(address, host, port)) {
+    reason = "invalid address " + address;
+    return -1;
+  }
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  struct addrinfo* addresses = nullptr;
+  const int error = getaddrinfo(host.c_str(), std::to_string(port).c_str(),
+                                &hints, &addresses);
+  if (error != 0) {
+    reason = std::string("getaddrinfo: ") + gai_strerror(error);
+    return -1;
+  }
+  int fd = -1;
+  for (struct addrinfo* p = addresses; p != nullptr; p = p->ai_next) {
+    fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+    if (fd == -1) {
+      reason = std::string("socket: ") + strerror(errno);
+      continue;
+    }
+    // Allow a restarted coordinator to listen to the same port at once
+    const int enabled = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+    if (bind(fd, p->ai_addr, p->ai_addrlen) == -1) {
+      reason = std::string("bind: ") + strerror(errno);
+    } else if (listen(fd, chunk_listen_backlog) == -1) {
+      reason = std::string("listen: ") + strerror(errno);
+    } else {
+      break;
+    }
+    ::close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  if (fd == -1) {
+    return -1;
+  }
+
+  struct sockaddr_storage bound;
+  socklen_t bound_size = sizeof(bound);
+  if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&bound),
+                  &bound_size) == 0) {
+    if (bound.ss_family == AF_INET) {
+      port = ntohs(reinterpret_cast<struct sockaddr_in*>(&bound)->sin_port);
+    } else if (bound.ss_family == AF_INET6) {
+      port = ntohs(reinterpret_cast<struct sockaddr_in6*>(&bound)->sin6_port);
+    }
+  }
+  return fd;
+}
@@ -0,0 +1,229 @@
+#ifndef CHUNK_LEASE_H
+#define CHUNK_LEASE_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "run_control.h"
+#include "simulation_kernel.h"
+
+// Distribute the pulls of one simulation over worker processes, which may
+// run on hosts of different speed and may die at any time.
+//
+// ./simulation_coordinator splits the pulls into chunks and leases one chunk
+// at a time to every ./simulation_sequential --worker <host:port> connected
+// over TCP, i.e., a fast worker simply comes back for its next chunk sooner.
+// Every chunk is an independent simulation seeded with its own seed derived
+// from the seed of the coordinator and the index of the chunk, hence the
+// merged results only depend on the seed and the chunk size, no matter which
+// worker ran which chunk. As at the end of any simulation, the trial that is
+// unfinished at the end of a chunk is dropped.
+//
+// A worker reports the progress of its chunk after every run_chunk_pull_time
+// pulls, and sends the result histogram of the chunk when it is done. A
+// lease expires when its worker disconnects or does not report for the lease
+// timeout, and the chunk is leased again to the next idle worker. The first
+// result of a chunk is merged, a later one is dropped.
+//
+// A message is a frame of 64-bit little-endian words: the type of the
+// message, the number of words that follow, and the words.
+
+// Identifies the protocol in the hello message of a worker
+const unsigned long long int chunk_lease_magic = 0x41524b534c454153ULL;
+const unsigned long long int chunk_lease_version = 2;
+
+// The messages. A worker sends the hello message once connected, which is
+// answered by a lease or a reject message. A worker sends progress messages
+// and a result message for every lease, until it gets a finish message
+const unsigned long long int chunk_message_hello = 1;
+const unsigned long long int chunk_message_lease = 2;
+const unsigned long long int chunk_message_progress = 3;
+const unsigned long long int chunk_message_result = 4;
+const unsigned long long int chunk_message_finish = 5;
+const unsigned long long int chunk_message_reject = 6;
+
+// The maximum number of words of a message, i.e., 8 MiB
+const unsigned long long int max_chunk_message_word_num = 1ULL << 20;
+
+// The default pulls of a chunk, i.e., a fraction of a second of simulation
+const unsigned long long int default_chunk_pull_time = 1ULL << 24;
+// The minimum pulls of a chunk. Every chunk starts its first trial from a
+// fresh state and drops its unfinished trial, which biases the merged
+// results toward short trials by about one trial per chunk, i.e., one in
+// about 10000 trials of the default banner from this size on
+const unsigned long long int min_chunk_pull_time = run_chunk_pull_time;
+// The default and the maximum seconds that a lease is kept without any
+// report from its worker
+const unsigned long long int default_lease_timeout = 30;
+const unsigned long long int max_lease_timeout = 86400;
+
+// A chunk of pulls leased to a worker
+class ChunkLease {
+ public:
+  unsigned long long int chunk_index;
+  // The seed of the generator of the chunk
+  unsigned long long int seed;
+  unsigned long long int pull_time;
+
+  ChunkLease();
+};
+
+// The result of a chunk sent back by a worker
+class ChunkResult {
+ public:
+  unsigned long long int chunk_index;
+  unsigned long long int pull_time;
+  // Wall clock nanoseconds that the worker spent on the chunk
+  unsigned long long int elapsed_ns;
+  unsigned long long int star6_count;
+  unsigned long long int target_star6_count;
+  std::vector<unsigned long long int> result;
+  // The rare events as pairs of (pulls of the trial, times)
+  std::vector<unsigned long long int> rare_event;
+
+  ChunkResult();
+};
+
+// The chunks of a simulation and their leases, on the coordinator
+class ChunkLeaseTable {
+ public:
+  unsigned long long int total_pull_time;
+  // The pulls of every chunk but the last one, which also takes the pulls
+  // left over, so that no chunk is shorter unless the whole simulation is
+  unsigned long long int chunk_pull_time;
+  unsigned long long int chunk_num;
+  unsigned long long int seed;
+
+  // True for the chunks whose result is merged
+  std::vector<bool> is_merged;
+  // The first chunk that has never been leased
+  unsigned long long int next_chunk_index;
+  // The chunks whose lease expired, to be leased again first
+  std::deque<unsigned long long int> expired_chunk;
+
+  unsigned long long int merged_chunk_num;
+  unsigned long long int merged_pull_time;
+  unsigned long long int reissued_lease_num;
+
+  ChunkLeaseTable(unsigned long long int _total_pull_time,
+                  unsigned long long int _chunk_pull_time,
+                  unsigned long long int _seed);
+
+  // Take the next chunk to lease, the expired ones first. Return false if
+  // every chunk is merged or leased
+  bool lease_next(ChunkLease& lease);
+
+  // The pulls of the chunk, chunk_pull_time but for the last chunk
+  unsigned long long int get_pull_time(unsigned long long int chunk_index) const;
+
+  // The lease of the chunk expired, hence lease it again unless it is merged
+  void expire(unsigned long long int chunk_index);
+
+  // Mark the chunk as merged. Return false if it is already merged, i.e.,
+  // the result is a duplicate to be dropped
+  bool merge(unsigned long long int chunk_index);
+
+  bool is_finished() const;
+};
+
+// The seed of a chunk, which differs for every index and base seed
+unsigned long long int derive_chunk_seed(unsigned long long int seed,
+                                         unsigned long long int chunk_index);
+
+// Split "<host>:<port>" into its host and port. Return false if the address
+// is not of this form or the port is not in [0, 65535]
+bool parse_chunk_address(const std::string& address, std::string& host,
+                         unsigned int& port);
+
+// Return true if address can be given to --worker, i.e., "<host>:<port>"
+// with a port in [1, 65535]
+bool is_valid_worker_address(const std::string& address);
+
+// The words that identify the settings that decide the results of a chunk
+// of a seed: the banner settings of parameter, whether the lanes kernel
+// takes the pulls (its trials take them in another order than the other
+// kernels), and whether they are drawn from the random stream of
+// --recycle-bits. The workers of a simulation must send the same ones
+std::vector<unsigned long long int> encode_simulation_settings(
+    const SimulationParameter& parameter, const std::string& kernel_name,
+    bool recycle_bits);
+
+// The words of the hello message of this worker process, i.e., the magic,
+// the version, the process id and the settings of the chunks
+const size_t chunk_hello_header_word_num = 3;
+std::vector<unsigned long long int> encode_worker_hello(
+    const SimulationParameter& parameter, const std::string& kernel_name,
+    bool recycle_bits);
+
+// The words of the result message of a chunk simulated into state, which
+// started from SimulationState(parameter)
+std::vector<unsigned long long int> encode_chunk_result(
+    const ChunkLease& lease, const SimulationState& state,
+    unsigned long long int elapsed_ns);
+
+// Parse the words of a result message. Return false if they are malformed
+bool decode_chunk_result(const std::vector<unsigned long long int>& words,
+                         ChunkResult& chunk_result);
+
+// Add the counters and the histograms of a chunk to state
+void merge_chunk_result(SimulationState& state,
+                        const ChunkResult& chunk_result);
+
+// A TCP connection that carries the messages
+class ChunkConnection {
+ public:
+  // -1 if closed
+  int fd;
+  // The bytes received but not parsed yet
+  std::vector<unsigned char> received;
+  // The reason why the connection is lost
+  std::string unavailable_reason;
+
+  ChunkConnection();
+  explicit ChunkConnection(int _fd);
+
+  // Connect to the coordinator listening at "<host>:<port>"
+  bool connect(const std::string& address);
+
+  // Send a whole message, waiting until it is written
+  bool send_message(unsigned long long int type,
+                    const std::vector<unsigned long long int>& words);
+
+  // Append the bytes that have arrived to received without waiting. Return
+  // false if the peer closed the connection or it failed
+  bool receive_available();
+
+  // Take the first complete message out of received. Return false if there
+  // is none yet. A malformed frame closes the connection
+  bool pop_message(unsigned long long int& type,
+                   std::vector<unsigned long long int>& words);
+
+  // Wait until a complete message is received
+  bool receive_message(unsigned long long int& type,
+                       std::vector<unsigned long long int>& words);
+
+  bool is_open() const;
+
+  void close();
+};
+
+// Simulate the chunks that the coordinator listening at "<host>:<port>"
+// leases with the given kernel (on the random stream of --recycle-bits if
+// recycle_bits), until the coordinator finishes or SIGINT/SIGTERM is
+// received, then print the chunks simulated. Every chunk starts from a
+// fresh state with its own seed, and its progress is reported between the
+// pieces of run_chunk_pull_time pulls so that the coordinator keeps the
+// lease. Return false if the worker cannot connect, is rejected or loses
+// the coordinator
+bool run_chunk_worker(const std::string& address,
+                      const SimulationParameter& parameter,
+                      const std::string& kernel_name, bool recycle_bits);
+
+// Listen for the workers at "<host>:<port>", where the port 0 picks a free
+// one. Return the listening socket and set port to the one listened to, or
+// return -1 and set reason if failed
+int open_chunk_listener(const std::string& address, unsigned int& port,
+                        std::string& reason);
+
+#endif  // CHUNK_LEASE_H
@@ -0,0 +1,224 @@
+#include "control_variate.h"
+
+#include <algorithm>  // copy, max
+#include <cmath>      // sqrt
+
+#include "markov_chain.h"
+#include "table_kernel.h"
+
+// The probability that a run ends with the target star 6 operator, and the
+// mean length of the run
+static void calc_run_moments(const RunDistribution& run, double& target_prob,
+                             double& mean_length) {
+  target_prob = 0.0;
+  mean_length = 0.0;
+  for (size_t j = 1; j < run.target.size(); ++j) {
+    target_prob += run.target[j];
+    mean_length += j * (run.target[j] + run.off_target[j]);
+  }
+}
+
+ControlVariateModel::ControlVariateModel(const SimulationParameter& parameter) {
+  // A run ends at the guaranteed star 6 operator at the latest, i.e., within
+  // the length of the tables
+  const size_t max_length = parameter.star6_threshold_table.size() + 1;
+  double start_target_prob = 0.0;
+  double start_mean_length = 0.0;
+  calc_run_moments(
+      calc_run_distribution(parameter, parameter.current_pull, max_length),
+      start_target_prob, start_mean_length);
+  double reset_target_prob = 0.0;
+  double reset_mean_length = 0.0;
+  calc_run_moments(calc_run_distribution(parameter, 0, max_length),
+                   reset_target_prob, reset_mean_length);
+
+  // The runs after an off-target star 6 operator until the target one. The
+  // runs are empty without the tables, which are checked before simulating
+  const double reset_run_num =
+      reset_target_prob > 0.0
+          ? (1.0 - start_target_prob) / reset_target_prob
+          : 0.0;
+  mean[control_variate_pull] =
+      start_mean_length + reset_run_num * reset_mean_length;
+  mean[control_variate_star6] = 1.0 + reset_run_num;
+}
+
+ControlVariateStatistics::ControlVariateStatistics()
+    : trial_num(0),
+      control_sum(),
+      product_sum(),
+      result_star6_sum(result_size, 0),
+      trial_start_star6_count(0) {}
+
+// Add the controls of a finished trial to the sums
+static void add_trial(ControlVariateStatistics& statistics,
+                      unsigned long long int pull_count,
+                      unsigned long long int trial_star6_count) {
+  const unsigned long long int control[control_variate_num] = {
+      pull_count, trial_star6_count};
+  statistics.trial_num++;
+  for (unsigned int a = 0; a < control_variate_num; ++a) {
+    statistics.control_sum[a] += control[a];
+    for (unsigned int b = 0; b < control_variate_num; ++b) {
+      statistics.product_sum[a * control_variate_num + b] +=
+          control[a] * control[b];
+    }
+  }
+  if (pull_count < result_size) {
+    statistics.result_star6_sum[pull_count] += trial_star6_count;
+  }
+}
+
+// Adds the controls of every trial that the table kernel finishes
+class ControlVariateHook {
+ public:
+  ControlVariateStatistics& statistics;
+
+  explicit ControlVariateHook(ControlVariateStatistics& _statistics)
+      : statistics(_statistics) {}
+
+  inline void begin(unsigned long long int) {}
+  inline void star6(unsigned long long int pull_count,
+                    unsigned long long int star6_count,
+                    unsigned long long int, bool is_target) {
+    if (is_target) {
+      add_trial(statistics, pull_count,
+                star6_count - statistics.trial_start_star6_count);
+      statistics.trial_start_star6_count = star6_count;
+    }
+  }
+  inline void end(unsigned long long int) {}
+};
+
+void simulate_control_variates(SimulationState& state,
+                               ControlVariateStatistics& statistics,
+                               const SimulationParameter& parameter,
+                               std::mt19937_64& mt, PullDistribution& dist,
+                               unsigned long long int pull_time) {
+  FilledPullSource source(mt, dist);
+  ControlVariateHook hook(statistics);
+  simulate_table_impl(state, parameter, source, hook, pull_time);
+}
+
+// Solve covariance * beta = cross_covariance by Gaussian elimination. The
+// covariance matrix of the controls is positive semi-definite, and a control
+// that is (almost) a linear combination of the previous ones, e.g., the star
+// 6 operators when every one of them is the target one, gets a zero
+// coefficient instead of a division by zero
+static void solve_coefficients(const double* covariance,
+                               const double* cross_covariance, double* beta) {
+  const unsigned int n = control_variate_num;
+  // The pivots smaller than this share of the variance are regarded as zero
+  const double min_pivot_share = 1e-12;
+  double matrix[control_variate_num * control_variate_num];
+  double vector[control_variate_num];
+  bool is_used[control_variate_num];
+  std::copy(covariance, covariance + n * n, matrix);
+  std::copy(cross_covariance, cross_covariance + n, vector);
+
+  for (unsigned int k = 0; k < n; ++k) {
+    const double pivot = matrix[k * n + k];
+    is_used[k] = pivot > min_pivot_share * covariance[k * n + k] &&
+                 covariance[k * n + k] > 0.0;
+    if (!is_used[k]) {
+      continue;
+    }
+    for (unsigned int r = k + 1; r < n; ++r) {
+      const double factor = matrix[r * n + k] / pivot;
+      for (unsigned int c = k; c < n; ++c) {
+        matrix[r * n + c] -= factor * matrix[k * n + c];
+      }
+      vector[r] -= factor * vector[k];
+    }
+  }
+  for (unsigned int k = n; k-- > 0;) {
+    beta[k] = 0.0;
+    if (!is_used[k]) {
+      continue;
+    }
+    double sum = vector[k];
+    for (unsigned int c = k + 1; c < n; ++c) {
+      sum -= matrix[k * n + c] * beta[c];
+    }
+    beta[k] = sum / matrix[k * n + k];
+  }
+}
+
+ControlVariateEstimate estimate_control_variates(
+    const SimulationState& state, const ControlVariateStatistics& statistics,
+    const ControlVariateModel& model) {
+  ControlVariateEstimate estimate;
+  estimate.prob_s.assign(result_size, 0.0);
+  estimate.standard_error_s.assign(result_size, 0.0);
+  estimate.variance_ratio_s.assign(result_size, 1.0);
+  estimate.prob_w.assign(result_size, 0.0);
+  estimate.standard_error_w.assign(result_size, 0.0);
+  estimate.variance_ratio_w.assign(result_size, 1.0);
+  for (unsigned int a = 0; a < control_variate_num; ++a) {
+    estimate.observed_mean[a] = 0.0;
+  }
+  if (statistics.trial_num < 2) {
+    return estimate;
+  }
+
+  const unsigned int n_control = control_variate_num;
+  const double n = static_cast<double>(statistics.trial_num);
+  double control_mean[control_variate_num];
+  for (unsigned int a = 0; a < n_control; ++a) {
+    control_mean[a] = statistics.control_sum[a] / n;
+    estimate.observed_mean[a] = control_mean[a];
+  }
+  double covariance[control_variate_num * control_variate_num];
+  for (unsigned int a = 0; a < n_control; ++a) {
+    for (unsigned int b = 0; b < n_control; ++b) {
+      covariance[a * n_control + b] =
+          (statistics.product_sum[a * n_control + b] -
+           n * control_mean[a] * control_mean[b]) /
+          (n - 1.0);
+    }
+  }
+
+  // The corrected mean of the indicator Y of count trials, whose controls
+  // sum up to y_control_sum, its standard error and its variance ratio
+  auto correct = [&](double count, const double* y_control_sum,
+                     double& prob, double& standard_error,
+                     double& variance_ratio) {
+    const double y_mean = count / n;
+    const double y_variance = (count - n * y_mean * y_mean) / (n - 1.0);
+    double cross_covariance[control_variate_num];
+    for (unsigned int a = 0; a < n_control; ++a) {
+      cross_covariance[a] =
+          (y_control_sum[a] - n * control_mean[a] * y_mean) / (n - 1.0);
+    }
+    double beta[control_variate_num];
+    solve_coefficients(covariance, cross_covariance, beta);
+
+    prob = y_mean;
+    double explained_variance = 0.0;
+    for (unsigned int a = 0; a < n_control; ++a) {
+      prob -= beta[a] * (control_mean[a] - model.mean[a]);
+      explained_variance += beta[a] * cross_covariance[a];
+    }
+    const double residual_variance =
+        std::max(y_variance - explained_variance, 0.0);
+    standard_error = std::sqrt(residual_variance / n);
+    variance_ratio = y_variance > 0.0 ? residual_variance / y_variance : 1.0;
+  };
+
+  double cumulated_count = 0.0;
+  double cumulated_control_sum[control_variate_num] = {};
+  for (size_t i = 1; i < result_size; ++i) {
+    const double count = static_cast<double>(state.result[i]);
+    const double control_sum[control_variate_num] = {
+        i * count, static_cast<double>(statistics.result_star6_sum[i])};
+    correct(count, control_sum, estimate.prob_s[i],
+            estimate.standard_error_s[i], estimate.variance_ratio_s[i]);
+    cumulated_count += count;
+    for (unsigned int a = 0; a < n_control; ++a) {
+      cumulated_control_sum[a] += control_sum[a];
+    }
+    correct(cumulated_count, cumulated_control_sum, estimate.prob_w[i],
+            estimate.standard_error_w[i], estimate.variance_ratio_w[i]);
+  }
+  return estimate;
+}
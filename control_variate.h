@@ -0,0 +1,100 @@
+#ifndef CONTROL_VARIATE_H
+#define CONTROL_VARIATE_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// Pr(S_i) and Pr(W_i) corrected by control variates, estimated by
+// --control-variates from the trials of the same simulation.
+//
+// Some statistics of a trial have exactly known means: the pulls of the
+// trial N and its star 6 operators K (their ratio is the pulls per star 6
+// operator, the inverse of the star 6 rate). A trial is a run from the pity
+// counter c that trials start with, followed by runs from the pity counter 0
+// until a run ends with the target star 6 operator, hence by Wald's identity
+//     E[K] = 1 + (1 - r_c) / r_0
+//     E[N] = m_c + (1 - r_c) / r_0 * m_0
+// where r_p is the probability that a run from the pity counter p ends with
+// the target star 6 operator, and m_p is its mean length, both computed from
+// the thresholds (see markov_chain.h).
+//
+// A simulation that got more star 6 operators or shorter trials than
+// expected also got the short trials more often than expected, so the
+// estimate of a probability P = E[Y] (Y = 1{N = i} or 1{N <= i}) is moved
+// against the deviation of the controls C = (N, K) from their means:
+//     P' = mean(Y) - beta * (mean(C) - E[C])
+// with the regression coefficients beta = Cov(C, C)^-1 Cov(C, Y) of the same
+// trials, which minimize the variance of P'. The variance becomes
+// (1 - R^2) times the one of mean(Y), where R^2 is the share of the variance
+// of Y explained by C, i.e., the same precision needs 1 - R^2 times the
+// pulls.
+
+// The controls
+const unsigned int control_variate_pull = 0;
+const unsigned int control_variate_star6 = 1;
+const unsigned int control_variate_num = 2;
+
+const std::string control_variate_name[control_variate_num] = {
+    "pulls per trial", "star 6 operators per trial"};
+
+// The exact means of the controls, for the threshold tables of parameter,
+// which must end at the guaranteed star 6 operator
+class ControlVariateModel {
+ public:
+  double mean[control_variate_num];
+
+  explicit ControlVariateModel(const SimulationParameter& parameter);
+};
+
+// The sums of the controls over the finished trials
+class ControlVariateStatistics {
+ public:
+  unsigned long long int trial_num;
+  // The sums of the controls and of their products, i.e.,
+  // product_sum[a * control_variate_num + b] sums C_a * C_b
+  unsigned long long int control_sum[control_variate_num];
+  unsigned long long int product_sum[control_variate_num *
+                                     control_variate_num];
+  // The star 6 operators of the trials that ended at the pull i (the sum of
+  // their pulls is i * result[i])
+  std::vector<unsigned long long int> result_star6_sum;
+  // star6_count of the simulation when the current trial started
+  unsigned long long int trial_start_star6_count;
+
+  ControlVariateStatistics();
+};
+
+// The corrected Pr(S_i) and Pr(W_i) for i in [1, result_size) (the index 0
+// is unused), their standard errors, and their variances relative to the
+// ones of the plain estimates, i.e., 1 - R^2
+class ControlVariateEstimate {
+ public:
+  std::vector<double> prob_s;
+  std::vector<double> standard_error_s;
+  std::vector<double> variance_ratio_s;
+  std::vector<double> prob_w;
+  std::vector<double> standard_error_w;
+  std::vector<double> variance_ratio_w;
+  // The observed means of the controls
+  double observed_mean[control_variate_num];
+};
+
+// Simulate pull_time pulls with the table kernel (table_kernel.h), and add
+// the controls of the finished trials to statistics. Updates state exactly
+// as the other kernels do. Can be called several times to continue a
+// simulation
+void simulate_control_variates(SimulationState& state,
+                               ControlVariateStatistics& statistics,
+                               const SimulationParameter& parameter,
+                               std::mt19937_64& mt, PullDistribution& dist,
+                               unsigned long long int pull_time);
+
+// Correct the results of the simulation by the deviation of the controls
+ControlVariateEstimate estimate_control_variates(
+    const SimulationState& state, const ControlVariateStatistics& statistics,
+    const ControlVariateModel& model);
+
+#endif  // CONTROL_VARIATE_H
@@ -0,0 +1,102 @@
+#include "current_pull_table.h"
+
+#include <algorithm>  // min
+
+const unsigned long long int CurrentPullTable::no_visit;
+
+CurrentPullTable::CurrentPullTable()
+    : state_num(0),
+      run_start_pity(0),
+      run_start_pull(0),
+      started_trial_count(0) {}
+
+CurrentPullTable::CurrentPullTable(const SimulationParameter& parameter)
+    : state_num(1),
+      run_start_pity(0),
+      run_start_pull(0),
+      started_trial_count(1) {
+  // The pull after pity counter state_num - 1 is guaranteed to be a star 6
+  // operator
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  while (state_num < max_current_pull_table_state_num &&
+         parameter.calc_star6_threshold(state_num - 1) < dist_size) {
+    state_num++;
+  }
+
+  result.assign(state_num * result_size, 0);
+  trial_count.assign(state_num, 0);
+  for (unsigned long long int c = 0; c < state_num; ++c) {
+    star6_threshold.push_back(parameter.calc_star6_threshold(c));
+    target_star6_threshold.push_back(parameter.calc_target_star6_threshold(c));
+  }
+  first_visit.assign(state_num, no_visit);
+}
+
+// Record the first visits of the run that ends at the end_pull-th pull of
+// the current trial
+static void record_run(CurrentPullTable& table,
+                       unsigned long long int end_pull) {
+  const unsigned long long int run_end_pity =
+      std::min(table.run_start_pity + (end_pull - table.run_start_pull),
+               table.state_num);
+  for (unsigned long long int c = table.run_start_pity; c < run_end_pity;
+       ++c) {
+    if (table.first_visit[c] == CurrentPullTable::no_visit) {
+      table.first_visit[c] = table.run_start_pull + (c - table.run_start_pity);
+      table.visited.push_back(c);
+    }
+  }
+}
+
+void simulate_current_pull_table(CurrentPullTable& table,
+                                 SimulationState& state,
+                                 const SimulationParameter& parameter,
+                                 std::mt19937_64& mt, PullDistribution& dist,
+                                 unsigned long long int pull_time) {
+  for (unsigned long long int i = 0; i < pull_time; ++i) {
+    unsigned int rand_num = dist(mt);
+    state.current_pull_count++;
+    if (rand_num < state.star6_threshold) {
+      state.star6_count++;
+      record_run(table, state.current_pull_count);
+      if (rand_num < state.target_star6_threshold) {
+        state.target_star6_count++;
+        if (state.current_pull_count < state.result.size()) {
+          state.result[state.current_pull_count]++;
+        } else if (state.rare_event.size() < max_rare_event_map_size) {
+          state.rare_event[state.current_pull_count]++;
+        }
+        // Every reached pity counter gets a sample of the remaining pulls
+        for (unsigned long long int c : table.visited) {
+          const unsigned long long int length =
+              state.current_pull_count - table.first_visit[c];
+          if (length < result_size) {
+            table.result[c * result_size + length]++;
+          }
+          table.trial_count[c]++;
+          table.first_visit[c] = CurrentPullTable::no_visit;
+        }
+        table.visited.clear();
+
+        // Start the next trial with the next pity counter in turn
+        state.current_pull_count = 0;
+        state.pity_count = table.started_trial_count % table.state_num;
+        table.started_trial_count++;
+      } else {
+        state.pity_count = 0;
+      }
+      table.run_start_pity = state.pity_count;
+      table.run_start_pull = state.current_pull_count;
+      state.star6_threshold = table.star6_threshold[state.pity_count];
+      state.target_star6_threshold =
+          table.target_star6_threshold[state.pity_count];
+    } else {
+      state.pity_count++;
+      if (state.pity_count >= parameter.pity_starting_point) {
+        state.star6_threshold += parameter.delta_star6_threshold;
+        state.target_star6_threshold += parameter.delta_target_star6_threshold;
+      }
+    }
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef CURRENT_PULL_TABLE_H
+#define CURRENT_PULL_TABLE_H
+
+#include <random>
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// Measure the trial distribution of every value of -c|--current-pull in a
+// single run.
+//
+// The pity system is a Markov chain on the pity counter, hence whenever the
+// pity counter of a trial becomes c, the remaining pulls until the target
+// star 6 operator follow the same distribution as a trial that starts with
+// current_pull = c. The run records, for every c, the remaining pulls from
+// the first time each trial reaches pity counter c. One sample per trial
+// and per c keeps the samples of each c independent.
+//
+// Pity counters near the guarantee are almost never reached naturally, so
+// the trials start with the pity counters 0, 1, ..., state_num - 1 in turn,
+// which gives every c at least (number of trials / state_num) samples.
+
+// The maximum number of starting pity counters of a table
+const unsigned long long int max_current_pull_table_state_num = 1000;
+
+class CurrentPullTable {
+ public:
+  // The valid starting pity counters are [0, state_num), i.e., every pity
+  // counter before the pull that is guaranteed to be a star 6 operator
+  unsigned long long int state_num;
+
+  // result[c * result_size + i]: times that the target star 6 operator is
+  // got at the i-th pull after the trial reached pity counter c
+  std::vector<unsigned long long int> result;
+  // trial_count[c]: number of samples of c, including the ones longer than
+  // result_size pulls that the histogram does not cover
+  std::vector<unsigned long long int> trial_count;
+
+  // The thresholds of each pity counter
+  std::vector<unsigned long long int> star6_threshold;
+  std::vector<unsigned long long int> target_star6_threshold;
+
+  // first_visit[c]: the pull of the current trial after which the pity
+  // counter first became c, or no_visit
+  std::vector<unsigned long long int> first_visit;
+  // The pity counters that the current trial has reached
+  std::vector<unsigned long long int> visited;
+  // The pity counter that the current run starts with, and the pull of the
+  // current trial after which it starts
+  unsigned long long int run_start_pity;
+  unsigned long long int run_start_pull;
+  // Number of trials started, which decides the pity counter of the next one
+  unsigned long long int started_trial_count;
+
+  static const unsigned long long int no_visit = ~0ULL;
+
+  // An empty table, for the runs without --all-current-pull
+  CurrentPullTable();
+  explicit CurrentPullTable(const SimulationParameter& parameter);
+};
+
+// Simulate pull_time pulls and record the remaining pulls of every reached
+// pity counter into table. state keeps the counters and the pity system of
+// the run; its result histogram mixes all starting pity counters. Can be
+// called several times to continue a simulation
+void simulate_current_pull_table(CurrentPullTable& table,
+                                 SimulationState& state,
+                                 const SimulationParameter& parameter,
+                                 std::mt19937_64& mt, PullDistribution& dist,
+                                 unsigned long long int pull_time);
+
+#endif  // CURRENT_PULL_TABLE_H
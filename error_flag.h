@@ -33,9 +33,64 @@ class ErrorFlag {
   bool err_missing_value_for_current_pull_ctrl_arg;
   bool err_missing_value_for_current_pull_long_name_ctrl_arg;
 
+  bool err_invalid_value_for_kernel_ctrl_arg;
+  bool err_missing_value_for_kernel_ctrl_arg;
+
+  bool err_invalid_value_for_analyze_ctrl_arg;
+  bool err_missing_value_for_analyze_ctrl_arg;
+
+  bool err_invalid_value_for_bootstrap_ctrl_arg;
+  bool err_missing_value_for_bootstrap_ctrl_arg;
+
+  bool err_invalid_value_for_time_budget_ctrl_arg;
+  bool err_missing_value_for_time_budget_ctrl_arg;
+
+  bool err_invalid_value_for_shm_ctrl_arg;
+  bool err_missing_value_for_shm_ctrl_arg;
+
+  bool err_invalid_value_for_strategy_ctrl_arg;
+  bool err_missing_value_for_strategy_ctrl_arg;
+  bool err_invalid_value_for_strategy_targets_ctrl_arg;
+  bool err_missing_value_for_strategy_targets_ctrl_arg;
+
+  bool err_invalid_value_for_pity_curve_ctrl_arg;
+  bool err_missing_value_for_pity_curve_ctrl_arg;
+
+  bool err_invalid_value_for_trace_ctrl_arg;
+  bool err_missing_value_for_trace_ctrl_arg;
+
+  bool err_invalid_value_for_worker_ctrl_arg;
+  bool err_missing_value_for_worker_ctrl_arg;
+
+  bool err_invalid_value_for_isa_ctrl_arg;
+  bool err_missing_value_for_isa_ctrl_arg;
+
   bool err_conflict_ctrl_arg_flag;
+  bool err_conflict_all_current_pull_ctrl_arg;
+  bool err_conflict_rarity_ctrl_arg;
+  bool err_conflict_time_budget_ctrl_arg;
+  bool err_conflict_shm_ctrl_arg;
+  bool err_conflict_strategy_ctrl_arg;
+  bool err_strategy_targets_without_strategy;
+  bool err_conflict_pity_curve_ctrl_arg;
+  bool err_conflict_trace_ctrl_arg;
+  bool err_conflict_pipeline_ctrl_arg;
+  bool err_conflict_instant_ctrl_arg;
+  bool err_conflict_recycle_bits_ctrl_arg;
+  bool err_conflict_sensitivity_ctrl_arg;
+  bool err_conflict_control_variates_ctrl_arg;
+  bool err_conflict_worker_ctrl_arg;
   bool err_unexpected_value_for_ctrl_arg_limited;
   bool err_unexpected_value_for_ctrl_arg_standard;
+  bool err_unexpected_value_for_ctrl_arg_perf_stats;
+  bool err_unexpected_value_for_ctrl_arg_all_current_pull;
+  bool err_unexpected_value_for_ctrl_arg_kernel_info;
+  bool err_unexpected_value_for_ctrl_arg_rarity;
+  bool err_unexpected_value_for_ctrl_arg_pipeline;
+  bool err_unexpected_value_for_ctrl_arg_instant;
+  bool err_unexpected_value_for_ctrl_arg_recycle_bits;
+  bool err_unexpected_value_for_ctrl_arg_sensitivity;
+  bool err_unexpected_value_for_ctrl_arg_control_variates;
   bool err_unexpected_arguments_at_the_beginning;
   bool err_help_ctrl_arg_with_other_args;
   bool err_invalid_ctrl_args;
@@ -69,9 +124,64 @@ class ErrorFlag {
         err_missing_value_for_current_pull_ctrl_arg(false),
         err_missing_value_for_current_pull_long_name_ctrl_arg(false),
 
+        err_invalid_value_for_kernel_ctrl_arg(false),
+        err_missing_value_for_kernel_ctrl_arg(false),
+
+        err_invalid_value_for_analyze_ctrl_arg(false),
+        err_missing_value_for_analyze_ctrl_arg(false),
+
+        err_invalid_value_for_bootstrap_ctrl_arg(false),
+        err_missing_value_for_bootstrap_ctrl_arg(false),
+
+        err_invalid_value_for_time_budget_ctrl_arg(false),
+        err_missing_value_for_time_budget_ctrl_arg(false),
+
+        err_invalid_value_for_shm_ctrl_arg(false),
+        err_missing_value_for_shm_ctrl_arg(false),
+
+        err_invalid_value_for_strategy_ctrl_arg(false),
+        err_missing_value_for_strategy_ctrl_arg(false),
+        err_invalid_value_for_strategy_targets_ctrl_arg(false),
+        err_missing_value_for_strategy_targets_ctrl_arg(false),
+
+        err_invalid_value_for_pity_curve_ctrl_arg(false),
+        err_missing_value_for_pity_curve_ctrl_arg(false),
+
+        err_invalid_value_for_trace_ctrl_arg(false),
+        err_missing_value_for_trace_ctrl_arg(false),
+
+        err_invalid_value_for_worker_ctrl_arg(false),
+        err_missing_value_for_worker_ctrl_arg(false),
+
+        err_invalid_value_for_isa_ctrl_arg(false),
+        err_missing_value_for_isa_ctrl_arg(false),
+
         err_conflict_ctrl_arg_flag(false),
+        err_conflict_all_current_pull_ctrl_arg(false),
+        err_conflict_rarity_ctrl_arg(false),
+        err_conflict_time_budget_ctrl_arg(false),
+        err_conflict_shm_ctrl_arg(false),
+        err_conflict_strategy_ctrl_arg(false),
+        err_strategy_targets_without_strategy(false),
+        err_conflict_pity_curve_ctrl_arg(false),
+        err_conflict_trace_ctrl_arg(false),
+        err_conflict_pipeline_ctrl_arg(false),
+        err_conflict_instant_ctrl_arg(false),
+        err_conflict_recycle_bits_ctrl_arg(false),
+        err_conflict_sensitivity_ctrl_arg(false),
+        err_conflict_control_variates_ctrl_arg(false),
+        err_conflict_worker_ctrl_arg(false),
         err_unexpected_value_for_ctrl_arg_limited(false),
         err_unexpected_value_for_ctrl_arg_standard(false),
+        err_unexpected_value_for_ctrl_arg_perf_stats(false),
+        err_unexpected_value_for_ctrl_arg_all_current_pull(false),
+        err_unexpected_value_for_ctrl_arg_kernel_info(false),
+        err_unexpected_value_for_ctrl_arg_rarity(false),
+        err_unexpected_value_for_ctrl_arg_pipeline(false),
+        err_unexpected_value_for_ctrl_arg_instant(false),
+        err_unexpected_value_for_ctrl_arg_recycle_bits(false),
+        err_unexpected_value_for_ctrl_arg_sensitivity(false),
+        err_unexpected_value_for_ctrl_arg_control_variates(false),
         err_unexpected_arguments_at_the_beginning(false),
         err_help_ctrl_arg_with_other_args(false),
         err_invalid_ctrl_args(false) {}
@@ -104,9 +214,64 @@ class ErrorFlag {
            err_missing_value_for_current_pull_ctrl_arg ||
            err_missing_value_for_current_pull_long_name_ctrl_arg ||
 
+           err_invalid_value_for_kernel_ctrl_arg ||
+           err_missing_value_for_kernel_ctrl_arg ||
+
+           err_invalid_value_for_analyze_ctrl_arg ||
+           err_missing_value_for_analyze_ctrl_arg ||
+
+           err_invalid_value_for_bootstrap_ctrl_arg ||
+           err_missing_value_for_bootstrap_ctrl_arg ||
+
+           err_invalid_value_for_time_budget_ctrl_arg ||
+           err_missing_value_for_time_budget_ctrl_arg ||
+
+           err_invalid_value_for_shm_ctrl_arg ||
+           err_missing_value_for_shm_ctrl_arg ||
+
+           err_invalid_value_for_strategy_ctrl_arg ||
+           err_missing_value_for_strategy_ctrl_arg ||
+           err_invalid_value_for_strategy_targets_ctrl_arg ||
+           err_missing_value_for_strategy_targets_ctrl_arg ||
+
+           err_invalid_value_for_pity_curve_ctrl_arg ||
+           err_missing_value_for_pity_curve_ctrl_arg ||
+
+           err_invalid_value_for_trace_ctrl_arg ||
+           err_missing_value_for_trace_ctrl_arg ||
+
+           err_invalid_value_for_worker_ctrl_arg ||
+           err_missing_value_for_worker_ctrl_arg ||
+
+           err_invalid_value_for_isa_ctrl_arg ||
+           err_missing_value_for_isa_ctrl_arg ||
+
            err_conflict_ctrl_arg_flag ||
+           err_conflict_all_current_pull_ctrl_arg ||
+           err_conflict_rarity_ctrl_arg ||
+           err_conflict_time_budget_ctrl_arg ||
+           err_conflict_shm_ctrl_arg ||
+           err_conflict_strategy_ctrl_arg ||
+           err_strategy_targets_without_strategy ||
+           err_conflict_pity_curve_ctrl_arg ||
+           err_conflict_trace_ctrl_arg ||
+           err_conflict_pipeline_ctrl_arg ||
+           err_conflict_instant_ctrl_arg ||
+           err_conflict_recycle_bits_ctrl_arg ||
+           err_conflict_sensitivity_ctrl_arg ||
+           err_conflict_control_variates_ctrl_arg ||
+           err_conflict_worker_ctrl_arg ||
            err_unexpected_value_for_ctrl_arg_limited ||
            err_unexpected_value_for_ctrl_arg_standard ||
+           err_unexpected_value_for_ctrl_arg_perf_stats ||
+           err_unexpected_value_for_ctrl_arg_all_current_pull ||
+           err_unexpected_value_for_ctrl_arg_kernel_info ||
+           err_unexpected_value_for_ctrl_arg_rarity ||
+           err_unexpected_value_for_ctrl_arg_pipeline ||
+           err_unexpected_value_for_ctrl_arg_instant ||
+           err_unexpected_value_for_ctrl_arg_recycle_bits ||
+           err_unexpected_value_for_ctrl_arg_sensitivity ||
+           err_unexpected_value_for_ctrl_arg_control_variates ||
            err_unexpected_arguments_at_the_beginning ||
            err_help_ctrl_arg_with_other_args ||
            err_invalid_ctrl_args;
@@ -0,0 +1,119 @@
+#include "instant_table.h"
+
+// The rates of the default banners that simulation_sequential starts with
+constexpr double instant_base_star6_rate = 0.02;
+constexpr double instant_delta_star6_rate = 0.02;
+
+constexpr unsigned long long int instant_dist_size =
+    dist_right_border - dist_left_border + 1;
+
+// The thresholds of a default banner and its trial distributions
+class InstantTable {
+ public:
+  // The thresholds as ProbabilityWrapper derives them, with the same
+  // expressions evaluated at build time
+  unsigned long long int init_star6_threshold;
+  unsigned long long int init_target_star6_threshold;
+  unsigned int delta_star6_threshold;
+  unsigned int delta_target_star6_threshold;
+
+  // prob[c][i] is Pr(S_i) of a trial that starts with the pity counter c
+  double prob[instant_pity_num][result_size];
+
+  constexpr InstantTable(double conditional_rate,
+                         unsigned int banner_operator_num)
+      : init_star6_threshold(static_cast<unsigned long long int>(
+            instant_dist_size * instant_base_star6_rate)),
+        init_target_star6_threshold(static_cast<unsigned long long int>(
+            instant_dist_size * instant_base_star6_rate * conditional_rate /
+            banner_operator_num)),
+        delta_star6_threshold(static_cast<unsigned int>(
+            instant_dist_size * instant_delta_star6_rate)),
+        delta_target_star6_threshold(static_cast<unsigned int>(
+            delta_star6_threshold * conditional_rate / banner_operator_num)),
+        prob{} {
+    // A trial that starts with the pity counter p ends at its first pull
+    // with the target star 6 operator, restarts from the pity counter 0 with
+    // another star 6 operator, or continues from p + 1, hence
+    //     Pr(S_1 | p) = T_p
+    //     Pr(S_i | p) = (1 - S_p) Pr(S_{i-1} | p + 1)
+    //                   + (S_p - T_p) Pr(S_{i-1} | 0)
+    // where S_p (T_p) is the probability of a (the target) star 6 operator
+    // after p failed pulls. The last pity counter always gets a star 6
+    // operator, hence never continues
+    double fail_prob[instant_pity_num] = {};
+    double off_target_prob[instant_pity_num] = {};
+    for (unsigned long long int p = 0; p < instant_pity_num; ++p) {
+      const double star6_prob =
+          static_cast<double>(calc_star6_threshold(p)) / instant_dist_size;
+      const double target_prob =
+          static_cast<double>(calc_target_star6_threshold(p)) /
+          instant_dist_size;
+      fail_prob[p] = 1.0 - star6_prob;
+      off_target_prob[p] = star6_prob - target_prob;
+      prob[p][1] = target_prob;
+    }
+    for (size_t i = 2; i < result_size; ++i) {
+      for (unsigned long long int p = 0; p + 1 < instant_pity_num; ++p) {
+        prob[p][i] = fail_prob[p] * prob[p + 1][i - 1] +
+                     off_target_prob[p] * prob[0][i - 1];
+      }
+      prob[instant_pity_num - 1][i] =
+          off_target_prob[instant_pity_num - 1] * prob[0][i - 1];
+    }
+  }
+
+  // The thresholds after pity_count failed pulls, as SimulationParameter
+  // calculates them
+  constexpr unsigned long long int calc_star6_threshold(
+      unsigned long long int pity_count) const {
+    return init_star6_threshold +
+           calc_raise_num(instant_pity_starting_point, pity_count) *
+               delta_star6_threshold;
+  }
+  constexpr unsigned long long int calc_target_star6_threshold(
+      unsigned long long int pity_count) const {
+    return init_target_star6_threshold +
+           calc_raise_num(instant_pity_starting_point, pity_count) *
+               delta_target_star6_threshold;
+  }
+
+  // Return true if the last pity counter of the table is exactly the one of
+  // the guaranteed star 6 operator
+  constexpr bool is_complete() const {
+    return calc_star6_threshold(instant_pity_num - 2) < instant_dist_size &&
+           calc_star6_threshold(instant_pity_num - 1) >= instant_dist_size;
+  }
+};
+
+// Evaluated by the compiler, which takes a few seconds
+static constexpr InstantTable instant_tables[] = {
+    InstantTable(limited_banner_on_banner_star6_conditional_rate, 1),
+    InstantTable(limited_banner_on_banner_star6_conditional_rate, 2),
+    InstantTable(standard_banner_on_banner_star6_conditional_rate, 1),
+    InstantTable(standard_banner_on_banner_star6_conditional_rate, 2)};
+
+static_assert(instant_tables[0].is_complete() &&
+                  instant_tables[1].is_complete() &&
+                  instant_tables[2].is_complete() &&
+                  instant_tables[3].is_complete(),
+              "instant_pity_num must end at the guaranteed star 6 operator");
+
+const double* find_instant_distribution(const SimulationParameter& parameter) {
+  if (parameter.has_pity_curve ||
+      parameter.pity_starting_point != instant_pity_starting_point ||
+      parameter.current_pull >= instant_pity_num) {
+    return nullptr;
+  }
+  for (const InstantTable& table : instant_tables) {
+    if (table.init_star6_threshold == parameter.init_star6_threshold &&
+        table.init_target_star6_threshold ==
+            parameter.init_target_star6_threshold &&
+        table.delta_star6_threshold == parameter.delta_star6_threshold &&
+        table.delta_target_star6_threshold ==
+            parameter.delta_target_star6_threshold) {
+      return table.prob[parameter.current_pull];
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,33 @@
+#ifndef INSTANT_TABLE_H
+#define INSTANT_TABLE_H
+
+#include "simulation_kernel.h"
+
+// Exact trial distributions of the default banners, computed at build time
+// by constexpr evaluation and embedded into the program, so that --instant
+// answers them without running a simulation.
+//
+// The default banners are the limited and the standard banners with 1 or 2
+// rate-up operators, the base rate of 2 % and the pity system raising it by
+// 2 % from the 50th failed pull. For each of them and every pity counter
+// that a trial can start with (-c|--current-pull), the tables hold Pr(S_i)
+// for i in [1, result_size), the same probabilities that the exact Markov
+// chain (see markov_chain.h) calculates at run time.
+//
+// The tables are computed from the same integer thresholds that the kernels
+// use, and a setting is looked up by its thresholds, so a custom setting
+// never gets the table of a different one.
+
+// The pity starting point of the default banners
+const unsigned int instant_pity_starting_point = 50;
+// The pity counters that a trial of a default banner can start with, i.e.,
+// the pity starting point plus the 49 raises before the guaranteed star 6
+// operator
+const unsigned long long int instant_pity_num = 99;
+
+// Return Pr(S_i) for i in [0, result_size) (the index 0 is unused) of a
+// trial that starts with parameter.current_pull, or nullptr if the parameter
+// is not one of a default banner
+const double* find_instant_distribution(const SimulationParameter& parameter);
+
+#endif  // INSTANT_TABLE_H
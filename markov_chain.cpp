@@ -0,0 +1,71 @@
+#include "markov_chain.h"
+
+#include <algorithm>  // min
+
+RunDistribution calc_run_distribution(const SimulationParameter& parameter,
+                                      unsigned long long int start_pity,
+                                      size_t max_length) {
+  const double dist_size = dist_right_border - dist_left_border + 1;
+
+  RunDistribution run;
+  run.target.push_back(0.0);
+  run.off_target.push_back(0.0);
+
+  // Follow the same state transitions of a failed pull as the kernels
+  unsigned long long int pity_count = start_pity;
+  unsigned long long int star6_threshold =
+      parameter.calc_star6_threshold(start_pity);
+  unsigned long long int target_star6_threshold =
+      parameter.calc_target_star6_threshold(start_pity);
+  // Probability that the run has not ended before the current pull
+  double survival = 1.0;
+  for (size_t j = 1; j < max_length && survival > 0.0; ++j) {
+    const double star6_prob =
+        std::min<double>(star6_threshold, dist_size) / dist_size;
+    const double target_prob =
+        std::min<double>(target_star6_threshold, dist_size) / dist_size;
+    run.target.push_back(survival * target_prob);
+    run.off_target.push_back(survival * (star6_prob - target_prob));
+    survival *= 1.0 - star6_prob;
+
+    pity_count++;
+    star6_threshold = parameter.calc_star6_threshold(pity_count);
+    target_star6_threshold = parameter.calc_target_star6_threshold(pity_count);
+  }
+
+  return run;
+}
+
+std::vector<double> calc_exact_trial_distribution(
+    const SimulationParameter& parameter, unsigned long long int start_pity,
+    size_t length) {
+  // Runs after the first one of a trial start with a zero pity counter
+  const RunDistribution first_run =
+      calc_run_distribution(parameter, start_pity, length);
+  const RunDistribution reset_run = calc_run_distribution(parameter, 0, length);
+
+  // reset_trial[i]: Pr(S_i) of a trial that starts with a zero pity counter,
+  // by conditioning on the end of its first run:
+  // reset_trial[i] = target[i] + sum_{j < i} off_target[j] * reset_trial[i - j]
+  std::vector<double> reset_trial(length, 0.0);
+  for (size_t i = 1; i < length; ++i) {
+    double prob = i < reset_run.target.size() ? reset_run.target[i] : 0.0;
+    const size_t max_j = std::min(i, reset_run.off_target.size());
+    for (size_t j = 1; j < max_j; ++j) {
+      prob += reset_run.off_target[j] * reset_trial[i - j];
+    }
+    reset_trial[i] = prob;
+  }
+
+  std::vector<double> trial(length, 0.0);
+  for (size_t i = 1; i < length; ++i) {
+    double prob = i < first_run.target.size() ? first_run.target[i] : 0.0;
+    const size_t max_j = std::min(i, first_run.off_target.size());
+    for (size_t j = 1; j < max_j; ++j) {
+      prob += first_run.off_target[j] * reset_trial[i - j];
+    }
+    trial[i] = prob;
+  }
+
+  return trial;
+}
@@ -0,0 +1,42 @@
+#ifndef MARKOV_CHAIN_H
+#define MARKOV_CHAIN_H
+
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// Exact probabilities of the pity system, computed from the same integer
+// thresholds that the simulation kernels use, so that they can be compared
+// with the simulation results without any modelling error.
+//
+// A "run" is a sequence of pulls that starts with a pity counter (and the
+// thresholds after that many failed pulls) and ends at the first star 6
+// operator. A trial (getting the target
+// star 6 operator) is a run that starts with the pity counter of the trial,
+// followed by runs that start with a zero pity counter until the star 6
+// operator of a run is the target one.
+
+// The distribution of the end of a run
+class RunDistribution {
+ public:
+  // target[j] (off_target[j]) is the probability that the first star 6
+  // operator of the run is (is not) the target one and is got at the j-th
+  // pull of the run. The index 0 is unused
+  std::vector<double> target;
+  std::vector<double> off_target;
+};
+
+// Calculate the distribution of a run that starts with the given pity
+// counter. The run is truncated after max_length pulls if it can be longer
+RunDistribution calc_run_distribution(const SimulationParameter& parameter,
+                                      unsigned long long int start_pity,
+                                      size_t max_length);
+
+// Calculate Pr(S_i), i.e., the probability of getting the target star 6
+// operator at the i-th pull of a trial that starts with the given pity
+// counter, for i in [1, length). The index 0 is unused and set to 0
+std::vector<double> calc_exact_trial_distribution(
+    const SimulationParameter& parameter, unsigned long long int start_pity,
+    size_t length);
+
+#endif  // MARKOV_CHAIN_H
@@ -0,0 +1,155 @@
+#include "perf_counter.h"
+
+#include <string.h>  // strerror
+#include <unistd.h>
+
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+PerfCounter::PerfCounter()
+    : cycles_fd(-1),
+      instructions_fd(-1),
+      branch_misses_fd(-1),
+      cache_misses_fd(-1),
+      cycles(0),
+      instructions(0),
+      branch_misses(0),
+      cache_misses(0) {}
+
+PerfCounter::~PerfCounter() {
+  const int fds[] = {cycles_fd, instructions_fd, branch_misses_fd,
+                     cache_misses_fd};
+  for (int fd : fds) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+}
+
+int PerfCounter::open_counter(unsigned long long int config) {
+#ifdef __linux__
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = 1;
+  // Only count the simulation itself, which also allows the counters to be
+  // opened under the default perf_event_paranoid setting
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // Also count the threads started after the counter is opened, e.g., the
+  // producer of --pipeline that runs the random number generator
+  attr.inherit = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  if (fd == -1 && unavailable_reason.empty()) {
+    unavailable_reason = std::string("perf_event_open: ") + strerror(errno);
+  }
+  return fd;
+#else
+  (void)config;
+  if (unavailable_reason.empty()) {
+    unavailable_reason = "perf_event_open is only supported on Linux";
+  }
+  return -1;
+#endif
+}
+
+unsigned long long int PerfCounter::read_counter(int fd) {
+  // Layout of read_format = TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING
+  unsigned long long int buf[3] = {0, 0, 0};
+  if (fd == -1 || read(fd, buf, sizeof(buf)) != sizeof(buf)) {
+    return 0;
+  }
+  if (buf[2] == 0) {  // never scheduled on the PMU
+    return 0;
+  }
+  if (buf[2] < buf[1]) {
+    return static_cast<unsigned long long int>(
+        static_cast<double>(buf[0]) * buf[1] / buf[2]);
+  }
+  return buf[0];
+}
+
+bool PerfCounter::open() {
+#ifdef __linux__
+  cycles_fd = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+  instructions_fd = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+  branch_misses_fd = open_counter(PERF_COUNT_HW_BRANCH_MISSES);
+  cache_misses_fd = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+#else
+  open_counter(0);
+#endif
+  return is_cycles_available() || is_instructions_available() ||
+         is_branch_misses_available() || is_cache_misses_available();
+}
+
+void PerfCounter::start() {
+#ifdef __linux__
+  const int fds[] = {cycles_fd, instructions_fd, branch_misses_fd,
+                     cache_misses_fd};
+  for (int fd : fds) {
+    if (fd != -1) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void PerfCounter::stop() {
+#ifdef __linux__
+  const int fds[] = {cycles_fd, instructions_fd, branch_misses_fd,
+                     cache_misses_fd};
+  for (int fd : fds) {
+    if (fd != -1) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+#endif
+  cycles = read_counter(cycles_fd);
+  instructions = read_counter(instructions_fd);
+  branch_misses = read_counter(branch_misses_fd);
+  cache_misses = read_counter(cache_misses_fd);
+}
+
+// Getters
+bool PerfCounter::is_cycles_available() const { return cycles_fd != -1; }
+
+bool PerfCounter::is_instructions_available() const {
+  return instructions_fd != -1;
+}
+
+bool PerfCounter::is_branch_misses_available() const {
+  return branch_misses_fd != -1;
+}
+
+bool PerfCounter::is_cache_misses_available() const {
+  return cache_misses_fd != -1;
+}
+
+const unsigned long long int PerfCounter::get_cycles() const { return cycles; }
+
+const unsigned long long int PerfCounter::get_instructions() const {
+  return instructions;
+}
+
+const unsigned long long int PerfCounter::get_branch_misses() const {
+  return branch_misses;
+}
+
+const unsigned long long int PerfCounter::get_cache_misses() const {
+  return cache_misses;
+}
+
+const std::string& PerfCounter::get_unavailable_reason() const {
+  return unavailable_reason;
+}
@@ -0,0 +1,76 @@
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#include <string>
+
+// A thin wrapper of the Linux perf_event_open interface which counts the
+// hardware events of the calling thread, and of the threads that it starts
+// after open(), between start() and stop().
+// Each counter is opened independently, so that the counters which are
+// available can still be used when others are not (e.g., running inside
+// a container or a virtual machine without PMU access)
+class PerfCounter {
+ private:
+  // File descriptors of the counters, -1 if the counter is unavailable
+  int cycles_fd;
+  int instructions_fd;
+  int branch_misses_fd;
+  int cache_misses_fd;
+
+  // Counter values read after stop()
+  unsigned long long int cycles;
+  unsigned long long int instructions;
+  unsigned long long int branch_misses;
+  unsigned long long int cache_misses;
+
+  // The reason why (some of) the counters cannot be opened
+  std::string unavailable_reason;
+
+  // Open a single counting-mode hardware counter for the calling thread and
+  // the threads that it starts later. Return -1 and record the reason if
+  // failed
+  int open_counter(unsigned long long int config);
+
+  // Read the value of a counter, scaled by the time it was actually running
+  // if the kernel multiplexed it with other events
+  unsigned long long int read_counter(int fd);
+
+ public:
+  PerfCounter();
+
+  ~PerfCounter();
+
+  // Owns file descriptors, hence not copyable
+  PerfCounter(const PerfCounter&) = delete;
+  PerfCounter& operator=(const PerfCounter&) = delete;
+
+  // Open all counters. Return true if at least one counter is available
+  bool open();
+
+  // Reset and enable the opened counters
+  void start();
+
+  // Disable the opened counters and read their values
+  void stop();
+
+  // Getters
+  bool is_cycles_available() const;
+
+  bool is_instructions_available() const;
+
+  bool is_branch_misses_available() const;
+
+  bool is_cache_misses_available() const;
+
+  const unsigned long long int get_cycles() const;
+
+  const unsigned long long int get_instructions() const;
+
+  const unsigned long long int get_branch_misses() const;
+
+  const unsigned long long int get_cache_misses() const;
+
+  const std::string& get_unavailable_reason() const;
+};
+
+#endif  // PERF_COUNTER_H
@@ -0,0 +1,97 @@
+#include "pity_curve.h"
+
+#include <cctype>  // isdigit
+#include <cmath>   // isfinite
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "simulation_kernel.h"
+
+// Parse a whole token as a non-negative integer. Return false if it is not
+static bool parse_pity_count(const std::string& token,
+                             unsigned long long int& pity_count) {
+  if (token.empty() || !isdigit(static_cast<unsigned char>(token[0]))) {
+    return false;
+  }
+  char* p_end = nullptr;
+  pity_count = strtoull(token.c_str(), &p_end, 10);
+  return *p_end == '\0';
+}
+
+// Parse a whole token as a probability in [0, 1]. Return false if it is not
+static bool parse_star6_rate(const std::string& token, double& star6_rate) {
+  char* p_end = nullptr;
+  star6_rate = strtod(token.c_str(), &p_end);
+  return !token.empty() && *p_end == '\0' && std::isfinite(star6_rate) &&
+         star6_rate >= 0.0 && star6_rate <= 1.0;
+}
+
+bool load_pity_curve(const std::string& path, PityCurve& pity_curve,
+                     std::string& reason) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    reason = "cannot open " + path;
+    return false;
+  }
+
+  pity_curve.star6_rate.clear();
+  std::string line;
+  unsigned long long int line_num = 0;
+  while (std::getline(file, line)) {
+    line_num++;
+    const std::string location = path + ":" + std::to_string(line_num) + ": ";
+    for (char& c : line) {
+      if (c == ',') {
+        c = ' ';
+      }
+    }
+    std::istringstream line_stream(line);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (line_stream >> token) {
+      tokens.push_back(token);
+    }
+    if (tokens.empty() || tokens[0][0] == '#') {
+      continue;
+    }
+
+    unsigned long long int pity_count = 0;
+    double star6_rate = 0.0;
+    if (tokens.size() != 2) {
+      reason = location + "expect \"<pity counter> <probability>\"";
+      return false;
+    }
+    if (!parse_pity_count(tokens[0], pity_count) ||
+        pity_count >= max_threshold_table_length) {
+      reason = location + "the pity counter must be an integer between [0, " +
+               std::to_string(max_threshold_table_length - 1) + "]";
+      return false;
+    }
+    if (!parse_star6_rate(tokens[1], star6_rate)) {
+      reason = location + "the probability must be a number between [0, 1]";
+      return false;
+    }
+    if (pity_curve.star6_rate.empty() && pity_count != 0) {
+      reason = location + "the first pity counter must be 0";
+      return false;
+    }
+    if (!pity_curve.star6_rate.empty() &&
+        pity_count < pity_curve.star6_rate.size()) {
+      reason = location + "the pity counters must strictly increase";
+      return false;
+    }
+
+    // The previous point holds until this one
+    if (!pity_curve.star6_rate.empty()) {
+      pity_curve.star6_rate.resize(pity_count, pity_curve.star6_rate.back());
+    }
+    pity_curve.star6_rate.push_back(star6_rate);
+  }
+
+  if (pity_curve.star6_rate.empty()) {
+    reason = path + ": no point in the pity curve";
+    return false;
+  }
+  return true;
+}
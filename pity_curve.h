@@ -0,0 +1,39 @@
+#ifndef PITY_CURVE_H
+#define PITY_CURVE_H
+
+#include <string>
+#include <vector>
+
+// Custom pity rules loaded by --pity-curve, e.g., soft pity curves, hard caps
+// or other increments, which are studied without recompiling.
+//
+// A pity curve is a text file of the probability of getting a star 6
+// operator after a number of continuously failed pulls (the pity counter),
+// one point per line:
+//     <pity counter> <probability of getting a star 6 operator>
+// The pity counters start from 0 and strictly increase, and the
+// probabilities are in [0, 1]. A point holds until the next one, and the last
+// one holds for every larger pity counter, e.g., the built-in rule is
+//     0 0.02
+//     50 0.04
+//     51 0.06
+//     ...
+//     98 1
+// The numbers are separated by spaces, tabs or commas. Empty lines and lines
+// starting with '#' are ignored. The probabilities are rounded to the
+// resolution of the pulls, i.e., 0.1 %, when the curve is compiled into the
+// thresholds of SimulationParameter.
+
+class PityCurve {
+ public:
+  // star6_rate[p] is the probability of getting a star 6 operator after p
+  // continuously failed pulls, for every p until the last point
+  std::vector<double> star6_rate;
+};
+
+// Load the pity curve at path. Return false and the reason (with the line
+// number) if the file cannot be read or is not a valid pity curve
+bool load_pity_curve(const std::string& path, PityCurve& pity_curve,
+                     std::string& reason);
+
+#endif  // PITY_CURVE_H
@@ -1,6 +1,12 @@
 #ifndef PROBABILITY_WRAPPER_H
 #define PROBABILITY_WRAPPER_H
 
+// Pre-defined parameters for Arknights
+// Pr(get a on-banner star 6 operator | get a star 6 operator) in a limited and
+// in a standard banner
+constexpr double limited_banner_on_banner_star6_conditional_rate = 0.7;
+constexpr double standard_banner_on_banner_star6_conditional_rate = 0.5;
+
 class ProbabilityWrapper {
  private:
   // The probability of getting a star 6 operator in one pull
@@ -0,0 +1,445 @@
+#include "pull_log_analyzer.h"
+
+#include <fcntl.h>
+#include <string.h>  // memchr
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include "markov_chain.h"
+
+// The lengths of the trials covered by the exact distribution. Longer trials
+// have a probability of less than 1e-12
+const size_t luck_model_trial_length = 2 * result_size;
+// The number of trials covered by the exact tables of LuckModel. Players
+// with more trials use the normal approximation
+const unsigned long long int luck_model_exact_trial_num = 16;
+
+// Resolution of the histograms used for the population percentiles
+const size_t luck_histogram_size = 10000;
+const size_t pulls_histogram_bins_per_pull = 10;
+const size_t pulls_histogram_size =
+    luck_model_trial_length * pulls_histogram_bins_per_pull;
+
+// Maximum number of the luckiest/unluckiest players to show
+const size_t outlier_showing_limit = 10;
+
+// Release the pages of the log that have been parsed every this many bytes,
+// so that the resident memory stays small however big the log is
+const size_t released_block_size = 64 * 1024 * 1024;
+
+LuckModel::LuckModel(const SimulationParameter& parameter)
+    : trial_mean(0.0), trial_variance(0.0) {
+  const std::vector<double> single = calc_exact_trial_distribution(
+      parameter, parameter.current_pull, luck_model_trial_length);
+  for (size_t t = 1; t < single.size(); ++t) {
+    trial_mean += t * single[t];
+  }
+  for (size_t t = 1; t < single.size(); ++t) {
+    trial_variance += (t - trial_mean) * (t - trial_mean) * single[t];
+  }
+
+  // Index 0 is unused
+  lucky_table.resize(luck_model_exact_trial_num + 1);
+  unlucky_table.resize(luck_model_exact_trial_num + 1);
+  std::vector<double> pmf = single;
+  for (unsigned long long int k = 1; k <= luck_model_exact_trial_num; ++k) {
+    if (k > 1) {
+      // Distribution of T_k = T_(k - 1) + T_1
+      std::vector<double> next(pmf.size() + single.size() - 1, 0.0);
+      for (size_t t = 1; t < pmf.size(); ++t) {
+        if (pmf[t] == 0.0) {
+          continue;
+        }
+        for (size_t u = 1; u < single.size(); ++u) {
+          next[t + u] += pmf[t] * single[u];
+        }
+      }
+      pmf.swap(next);
+    }
+    std::vector<double>& lucky = lucky_table[k];
+    std::vector<double>& unlucky = unlucky_table[k];
+    lucky.assign(pmf.size(), 0.0);
+    unlucky.assign(pmf.size(), 0.0);
+    double cumulated = 0.0;
+    for (size_t t = 0; t < pmf.size(); ++t) {
+      cumulated += pmf[t];
+      lucky[t] = cumulated;
+    }
+    // Sum from the right so that the tiny tail probabilities keep their
+    // precision
+    cumulated = 0.0;
+    for (size_t t = pmf.size(); t-- > 0;) {
+      cumulated += pmf[t];
+      unlucky[t] = cumulated;
+    }
+  }
+}
+
+double LuckModel::get_trial_mean() const { return trial_mean; }
+
+double LuckModel::calc_lucky_probability(unsigned long long int trial_num,
+                                         unsigned long long int pulls) const {
+  if (trial_num <= luck_model_exact_trial_num) {
+    const std::vector<double>& lucky = lucky_table[trial_num];
+    return pulls < lucky.size() ? lucky[pulls] : 1.0;
+  }
+  // Normal approximation with continuity correction
+  const double z = (pulls + 0.5 - trial_num * trial_mean) /
+                   std::sqrt(trial_num * trial_variance);
+  return 0.5 * std::erfc(-z / std::sqrt(2.0));
+}
+
+double LuckModel::calc_unlucky_probability(unsigned long long int trial_num,
+                                           unsigned long long int pulls) const {
+  if (trial_num <= luck_model_exact_trial_num) {
+    const std::vector<double>& unlucky = unlucky_table[trial_num];
+    return pulls < unlucky.size() ? unlucky[pulls] : 0.0;
+  }
+  const double z = (pulls - 0.5 - trial_num * trial_mean) /
+                   std::sqrt(trial_num * trial_variance);
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+// The luck of a player
+class PlayerLuck {
+ public:
+  std::string player_id;
+  unsigned long long int trial_num;
+  unsigned long long int pull_num;
+  // Pr(at least this lucky) or Pr(at least this unlucky)
+  double probability;
+};
+
+// Keep the outliers with the smallest probabilities on a max-heap
+static bool compare_player_luck(const PlayerLuck& lhs,
+                                const PlayerLuck& rhs) {
+  return lhs.probability < rhs.probability;
+}
+
+static void push_outlier(std::vector<PlayerLuck>& outliers,
+                         const PlayerLuck& player) {
+  if (outliers.size() < outlier_showing_limit) {
+    outliers.push_back(player);
+    std::push_heap(outliers.begin(), outliers.end(), compare_player_luck);
+  } else if (player.probability < outliers.front().probability) {
+    std::pop_heap(outliers.begin(), outliers.end(), compare_player_luck);
+    outliers.back() = player;
+    std::push_heap(outliers.begin(), outliers.end(), compare_player_luck);
+  }
+}
+
+// The statistics of (a part of) the pull log. Each thread owns one and they
+// are merged after all threads finish
+class PullLogStatistics {
+ public:
+  unsigned long long int player_num;
+  unsigned long long int trial_num;
+  unsigned long long int pull_num;
+  unsigned long long int malformed_line_num;
+
+  // Histogram of the average pulls per target star 6 operator of the players
+  std::vector<unsigned long long int> pulls_histogram;
+  // Histogram of Pr(T_k <= observed pulls) of the players
+  std::vector<unsigned long long int> luck_histogram;
+
+  std::vector<PlayerLuck> luckiest;
+  std::vector<PlayerLuck> unluckiest;
+
+  PullLogStatistics()
+      : player_num(0),
+        trial_num(0),
+        pull_num(0),
+        malformed_line_num(0),
+        pulls_histogram(pulls_histogram_size + 1),
+        luck_histogram(luck_histogram_size + 1) {}
+
+  void merge(const PullLogStatistics& other) {
+    player_num += other.player_num;
+    trial_num += other.trial_num;
+    pull_num += other.pull_num;
+    malformed_line_num += other.malformed_line_num;
+    for (size_t i = 0; i < pulls_histogram.size(); ++i) {
+      pulls_histogram[i] += other.pulls_histogram[i];
+    }
+    for (size_t i = 0; i < luck_histogram.size(); ++i) {
+      luck_histogram[i] += other.luck_histogram[i];
+    }
+    for (const PlayerLuck& player : other.luckiest) {
+      push_outlier(luckiest, player);
+    }
+    for (const PlayerLuck& player : other.unluckiest) {
+      push_outlier(unluckiest, player);
+    }
+  }
+};
+
+static inline bool is_separator(char c) {
+  return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+// Parse a line [p, line_end) of the pull log and add it to the statistics
+static void parse_pull_log_line(const char* p, const char* line_end,
+                                const LuckModel& luck_model,
+                                PullLogStatistics& statistics) {
+  while (p < line_end && is_separator(*p)) {
+    ++p;
+  }
+  if (p == line_end || *p == '#') {
+    return;
+  }
+  const char* id_begin = p;
+  while (p < line_end && !is_separator(*p)) {
+    ++p;
+  }
+  const char* id_end = p;
+
+  unsigned long long int trial_num = 0;
+  unsigned long long int pull_num = 0;
+  while (true) {
+    while (p < line_end && is_separator(*p)) {
+      ++p;
+    }
+    if (p == line_end) {
+      break;
+    }
+    unsigned long long int pulls = 0;
+    int digit_num = 0;
+    while (p < line_end && *p >= '0' && *p <= '9') {
+      pulls = pulls * 10 + (*p - '0');
+      ++digit_num;
+      ++p;
+    }
+    // Not a number, zero pulls, or too big to be a trial length
+    if (digit_num == 0 || digit_num > 9 || pulls == 0 ||
+        (p < line_end && !is_separator(*p))) {
+      statistics.malformed_line_num++;
+      return;
+    }
+    trial_num++;
+    pull_num += pulls;
+  }
+  if (trial_num == 0) {
+    statistics.malformed_line_num++;
+    return;
+  }
+
+  statistics.player_num++;
+  statistics.trial_num += trial_num;
+  statistics.pull_num += pull_num;
+
+  const double average = static_cast<double>(pull_num) / trial_num;
+  statistics.pulls_histogram[std::min<size_t>(
+      static_cast<size_t>(average * pulls_histogram_bins_per_pull),
+      pulls_histogram_size)]++;
+
+  PlayerLuck player;
+  player.trial_num = trial_num;
+  player.pull_num = pull_num;
+  player.probability = luck_model.calc_lucky_probability(trial_num, pull_num);
+  statistics.luck_histogram[std::min<size_t>(
+      static_cast<size_t>(player.probability * luck_histogram_size),
+      luck_histogram_size)]++;
+  // Only copy the id when the player can be an outlier
+  if (statistics.luckiest.size() < outlier_showing_limit ||
+      player.probability < statistics.luckiest.front().probability) {
+    player.player_id.assign(id_begin, id_end);
+    push_outlier(statistics.luckiest, player);
+  }
+  player.probability = luck_model.calc_unlucky_probability(trial_num, pull_num);
+  if (statistics.unluckiest.size() < outlier_showing_limit ||
+      player.probability < statistics.unluckiest.front().probability) {
+    player.player_id.assign(id_begin, id_end);
+    push_outlier(statistics.unluckiest, player);
+  }
+}
+
+// Parse the lines that start in [begin, end) of the mapped log
+static void parse_pull_log_range(const char* map_begin,
+                                 const char* map_end, const char* begin,
+                                 const char* end, const LuckModel& luck_model,
+                                 PullLogStatistics& statistics) {
+  // A line belongs to the range where it starts
+  if (begin != map_begin && begin[-1] != '\n') {
+    const char* newline =
+        static_cast<const char*>(memchr(begin, '\n', map_end - begin));
+    begin = newline == nullptr ? map_end : newline + 1;
+  }
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const char* released = begin;
+  const char* p = begin;
+  while (p < end) {
+    const char* line_end =
+        static_cast<const char*>(memchr(p, '\n', map_end - p));
+    if (line_end == nullptr) {
+      line_end = map_end;
+    }
+    parse_pull_log_line(p, line_end, luck_model, statistics);
+    p = line_end + 1;
+
+    if (static_cast<size_t>(p - released) >= released_block_size) {
+      // Only release the whole pages that this thread has parsed
+      uintptr_t release_begin =
+          (reinterpret_cast<uintptr_t>(released) + page_size - 1) &
+          ~(page_size - 1);
+      uintptr_t release_end =
+          reinterpret_cast<uintptr_t>(std::min(p, end)) & ~(page_size - 1);
+      if (release_begin < release_end) {
+        madvise(reinterpret_cast<void*>(release_begin),
+                release_end - release_begin, MADV_DONTNEED);
+      }
+      released = p;
+    }
+  }
+}
+
+// Return the value at the given percentile of a histogram
+static size_t find_histogram_percentile(
+    const std::vector<unsigned long long int>& histogram,
+    unsigned long long int total, double percentile) {
+  const double rank = total * percentile / 100.0;
+  unsigned long long int cumulated = 0;
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    cumulated += histogram[i];
+    if (cumulated >= rank && cumulated > 0) {
+      return i;
+    }
+  }
+  return histogram.size() - 1;
+}
+
+static void display_pull_log_analysis(const std::string& path,
+                                      size_t file_size, double time_spent,
+                                      const LuckModel& luck_model,
+                                      PullLogStatistics& statistics) {
+  std::cout << "...finished\n" << std::endl;
+
+  std::cout << "PULL LOG SUMMARY" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Pull log: " << path << std::endl;
+  std::cout << "Time spent: " << time_spent << "s ("
+            << file_size / 1048576.0 / time_spent << " MB/s)" << std::endl;
+  std::cout << "Players: " << statistics.player_num << std::endl;
+  std::cout << "Target star 6 times: " << statistics.trial_num << std::endl;
+  std::cout << "Pulling times: " << statistics.pull_num << std::endl;
+  std::cout << "Malformed lines: " << statistics.malformed_line_num
+            << std::endl;
+  if (statistics.player_num == 0) {
+    return;
+  }
+  std::cout << "Average pulls per target star 6: "
+            << static_cast<double>(statistics.pull_num) / statistics.trial_num
+            << " (expected " << luck_model.get_trial_mean() << ")" << std::endl;
+
+  std::cout << std::endl;
+
+  // The luck is Pr(T_k <= observed pulls), which is uniformly distributed
+  // if the players follow the model
+  std::cout << "POPULATION PERCENTILES" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Percentile\tPulls per target\tPr(at least this lucky)"
+            << std::endl;
+  const double percentiles[] = {1, 5, 10, 25, 50, 75, 90, 95, 99};
+  for (double percentile : percentiles) {
+    size_t pulls_bin = find_histogram_percentile(
+        statistics.pulls_histogram, statistics.player_num, percentile);
+    size_t luck_bin = find_histogram_percentile(
+        statistics.luck_histogram, statistics.player_num, percentile);
+    std::cout << percentile << " %\t\t"
+              << static_cast<double>(pulls_bin) /
+                     pulls_histogram_bins_per_pull
+              << "\t\t\t" << 100.0 * luck_bin / luck_histogram_size << " %"
+              << std::endl;
+  }
+
+  std::cout << std::endl;
+
+  std::cout << "OUTLIERS" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::sort_heap(statistics.luckiest.begin(), statistics.luckiest.end(),
+                 compare_player_luck);
+  std::sort_heap(statistics.unluckiest.begin(), statistics.unluckiest.end(),
+                 compare_player_luck);
+  std::cout << "The luckiest players:" << std::endl;
+  for (const PlayerLuck& player : statistics.luckiest) {
+    std::cout << "\tPlayer \"" << player.player_id << "\" got "
+              << player.trial_num << " target star 6 in " << player.pull_num
+              << " pulls, Pr(at least this lucky) = "
+              << 100.0 * player.probability << " %" << std::endl;
+  }
+  std::cout << "The unluckiest players:" << std::endl;
+  for (const PlayerLuck& player : statistics.unluckiest) {
+    std::cout << "\tPlayer \"" << player.player_id << "\" got "
+              << player.trial_num << " target star 6 in " << player.pull_num
+              << " pulls, Pr(at least this unlucky) = "
+              << 100.0 * player.probability << " %" << std::endl;
+  }
+}
+
+bool analyze_pull_log(const std::string& path,
+                      const SimulationParameter& parameter,
+                      unsigned int thread_num) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    std::cerr << "Cannot open the pull log \"" << path << "\"\n" << std::endl;
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    std::cerr << "Cannot read the pull log \"" << path << "\"\n" << std::endl;
+    close(fd);
+    return false;
+  }
+  const size_t file_size = file_stat.st_size;
+
+  // The exact tables are built before the timing starts, so that the
+  // reported throughput is the one of the streaming pass
+  const LuckModel luck_model(parameter);
+
+  std::cout << "Now will start analyzing the pull log...\n" << std::endl;
+  const auto start = std::chrono::steady_clock::now();
+
+  PullLogStatistics statistics;
+  if (file_size > 0) {
+    void* map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      std::cerr << "Cannot map the pull log \"" << path << "\"\n" << std::endl;
+      close(fd);
+      return false;
+    }
+    madvise(map, file_size, MADV_SEQUENTIAL);
+    const char* map_begin = static_cast<const char*>(map);
+    const char* map_end = map_begin + file_size;
+
+    thread_num = std::max(1u, thread_num);
+    std::vector<PullLogStatistics> thread_statistics(thread_num);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < thread_num; ++i) {
+      const char* begin = map_begin + file_size / thread_num * i;
+      const char* end = (i + 1 == thread_num)
+                            ? map_end
+                            : map_begin + file_size / thread_num * (i + 1);
+      threads.push_back(std::thread(
+          parse_pull_log_range, map_begin, map_end, begin, end,
+          std::cref(luck_model), std::ref(thread_statistics[i])));
+    }
+    for (unsigned int i = 0; i < thread_num; ++i) {
+      threads[i].join();
+      statistics.merge(thread_statistics[i]);
+    }
+    munmap(map, file_size);
+  }
+  close(fd);
+
+  const auto end = std::chrono::steady_clock::now();
+  display_pull_log_analysis(
+      path, file_size, std::chrono::duration<double>(end - start).count(),
+      luck_model, statistics);
+  return true;
+}
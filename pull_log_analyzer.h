@@ -0,0 +1,55 @@
+#ifndef PULL_LOG_ANALYZER_H
+#define PULL_LOG_ANALYZER_H
+
+#include <string>
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// Analyze the pull logs of real players with the same threshold model that
+// the simulation uses.
+//
+// A pull log is a text file with one player per line:
+//     <player id> <pulls of trial 1> <pulls of trial 2> ... <pulls of trial k>
+// where the i-th number is how many pulls the player spent to get the i-th
+// copy of the target star 6 operator (i.e., the length of a trial, see
+// markov_chain.h). The numbers are separated by spaces, tabs or commas.
+// Empty lines and lines starting with '#' are ignored.
+
+// The probability of the luck of a player, i.e., how likely a player spends
+// at most (or at least) the observed number of pulls to finish the observed
+// number of trials
+class LuckModel {
+ private:
+  // lucky_table[k][t] = Pr(T_k <= t), unlucky_table[k][t] = Pr(T_k >= t),
+  // where T_k is the total length of k trials, for k in [1, exact_trial_num]
+  std::vector<std::vector<double>> lucky_table;
+  std::vector<std::vector<double>> unlucky_table;
+
+  // Mean and variance of the length of a single trial, used by the normal
+  // approximation when a player has more trials than the tables cover
+  double trial_mean;
+  double trial_variance;
+
+ public:
+  explicit LuckModel(const SimulationParameter& parameter);
+
+  double get_trial_mean() const;
+
+  // Pr(T_k <= pulls), the smaller the luckier
+  double calc_lucky_probability(unsigned long long int trial_num,
+                                unsigned long long int pulls) const;
+
+  // Pr(T_k >= pulls), the smaller the unluckier
+  double calc_unlucky_probability(unsigned long long int trial_num,
+                                  unsigned long long int pulls) const;
+};
+
+// Memory-map the pull log and analyze it in a streaming pass with
+// thread_num threads, then print the population percentiles and the
+// outliers. Return false if the file cannot be read
+bool analyze_pull_log(const std::string& path,
+                      const SimulationParameter& parameter,
+                      unsigned int thread_num);
+
+#endif  // PULL_LOG_ANALYZER_H
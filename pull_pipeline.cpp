@@ -0,0 +1,129 @@
+#include "pull_pipeline.h"
+
+#include <algorithm>  // min
+#include <thread>
+
+// Wait until ready() returns true. Spin first, since the other thread
+// usually catches up within a block, then yield the core
+template <typename Predicate>
+static void wait_until(Predicate ready) {
+  for (unsigned int spin = 0; !ready(); ++spin) {
+    if (spin >= pipeline_spin_num) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+PullRing::PullRing()
+    : published_block_num(0),
+      released_block_num(0),
+      produced_block_num(0),
+      consumed_block_num(0),
+      closed(false) {}
+
+void PullRing::reset() {
+  pulls.assign(pipeline_block_pull_num * pipeline_block_num, 0);
+  published_block_num.store(0);
+  released_block_num.store(0);
+  produced_block_num = 0;
+  consumed_block_num = 0;
+  closed.store(false);
+}
+
+unsigned int* PullRing::acquire_free_block() {
+  wait_until([this] {
+    return produced_block_num - released_block_num.load(
+                                    std::memory_order_acquire) <
+               pipeline_block_num ||
+           closed.load(std::memory_order_acquire);
+  });
+  if (closed.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return pulls.data() +
+         (produced_block_num % pipeline_block_num) * pipeline_block_pull_num;
+}
+
+void PullRing::publish_block() {
+  produced_block_num++;
+  published_block_num.store(produced_block_num, std::memory_order_release);
+}
+
+const unsigned int* PullRing::acquire_full_block() {
+  wait_until([this] {
+    return published_block_num.load(std::memory_order_acquire) >
+           consumed_block_num;
+  });
+  return pulls.data() +
+         (consumed_block_num % pipeline_block_num) * pipeline_block_pull_num;
+}
+
+void PullRing::release_block() {
+  consumed_block_num++;
+  released_block_num.store(consumed_block_num, std::memory_order_release);
+}
+
+void PullRing::close() { closed.store(true, std::memory_order_release); }
+
+PullPipeline::PullPipeline()
+    : total_pull_time(0), consumed_pull_time(0), block(nullptr), block_used(0) {}
+
+PullPipeline::~PullPipeline() { stop(); }
+
+void PullPipeline::start(std::mt19937_64& mt, PullDistribution& dist,
+                         unsigned long long int pull_time) {
+  ring.reset();
+  total_pull_time = pull_time;
+  consumed_pull_time = 0;
+  block = nullptr;
+  block_used = 0;
+
+  // Both threads split the pulls into the same blocks
+  producer = std::thread([this, &mt, &dist] {
+    for (unsigned long long int i = 0; i < total_pull_time;) {
+      const size_t block_size = std::min<unsigned long long int>(
+          pipeline_block_pull_num, total_pull_time - i);
+      unsigned int* free_block = ring.acquire_free_block();
+      if (free_block == nullptr) {
+        return;
+      }
+      fill_pull_block(mt, dist, free_block, block_size);
+      ring.publish_block();
+      i += block_size;
+    }
+  });
+}
+
+void PullPipeline::simulate(const std::string& kernel_name,
+                            SimulationState& state,
+                            const SimulationParameter& parameter,
+                            unsigned long long int pull_time) {
+  for (unsigned long long int i = 0; i < pull_time;) {
+    if (block == nullptr) {
+      block = ring.acquire_full_block();
+      block_used = 0;
+    }
+    const unsigned long long int block_begin = consumed_pull_time - block_used;
+    const size_t block_size = std::min<unsigned long long int>(
+        pipeline_block_pull_num, total_pull_time - block_begin);
+    // A call may end inside a block, the next one goes on from there
+    const size_t pull_num =
+        std::min<unsigned long long int>(block_size - block_used, pull_time - i);
+    simulate_drawn(kernel_name, state, parameter, block + block_used,
+                   pull_num);
+    block_used += pull_num;
+    consumed_pull_time += pull_num;
+    i += pull_num;
+    if (block_used == block_size) {
+      ring.release_block();
+      block = nullptr;
+    }
+  }
+}
+
+void PullPipeline::stop() {
+  if (producer.joinable()) {
+    ring.close();
+    producer.join();
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef PULL_PIPELINE_H
+#define PULL_PIPELINE_H
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// The pipelined mode of --pipeline, which runs the random number generator
+// and the state machine of the pity system on two threads instead of
+// interleaving them on one core.
+//
+// A producer thread draws the random numbers into the blocks of a lock-free
+// single-producer/single-consumer ring, and the simulation thread runs the
+// selected kernel on every block that is ready (see simulate_drawn). The
+// producer is the only user of the generator while the pipeline runs, so the
+// random stream, hence the results, are the same as the ones without
+// --pipeline for the same seed. The producer and the ring live for the whole
+// simulation (see PullPipeline), so that the threads also overlap across the
+// chunks of pulls of the simulation thread.
+//
+// The pipeline pays off when the two threads run on different cores, or on
+// the two hyperthreads of a core whose generator and state machine leave
+// each other enough free execution ports. On a single core, it only adds the
+// switches between the threads. test/benchmark_pipeline.py measures it on the
+// host.
+
+// Pulls of a block, and blocks of the ring. A block (64 KiB) fits into the
+// L1 and L2 caches, and the whole ring (512 KiB) into the L2 cache that the
+// hyperthreads of a core share, so the simulation thread reads the numbers
+// from the cache that the producer has just written
+const size_t pipeline_block_pull_num = 16384;
+const size_t pipeline_block_num = 8;
+
+// Spins before a waiting thread yields its core, e.g., to the other thread
+// of the pipeline on a single core
+const unsigned int pipeline_spin_num = 1024;
+
+// A ring of blocks of random numbers between one producer and one consumer
+// thread. The counters are written by one thread each, and kept on their own
+// cache lines so that the threads do not invalidate each other's line on
+// every block
+class PullRing {
+ private:
+  std::vector<unsigned int> pulls;
+  // Blocks published by the producer
+  alignas(64) std::atomic<unsigned long long int> published_block_num;
+  // Blocks released by the consumer
+  alignas(64) std::atomic<unsigned long long int> released_block_num;
+  // Blocks taken by each side, only read by its own thread
+  alignas(64) unsigned long long int produced_block_num;
+  alignas(64) unsigned long long int consumed_block_num;
+  // Set when the consumer stops early, so that the producer stops waiting
+  alignas(64) std::atomic<bool> closed;
+
+ public:
+  PullRing();
+
+  // Allocate the blocks and empty the ring, before the threads start
+  void reset();
+
+  // Producer: wait for a free block, fill it, then publish it. Return
+  // nullptr instead once the ring is closed
+  unsigned int* acquire_free_block();
+  void publish_block();
+
+  // Consumer: wait for a published block, read it, then release it
+  const unsigned int* acquire_full_block();
+  void release_block();
+  void close();
+};
+
+// The producer thread of a simulation and its ring. The simulation thread
+// consumes the pulls in calls of any length, e.g., the chunks of main, while
+// the producer keeps drawing the next blocks
+class PullPipeline {
+ private:
+  PullRing ring;
+  std::thread producer;
+  unsigned long long int total_pull_time;
+  // Pulls handed to the kernels so far
+  unsigned long long int consumed_pull_time;
+  // The block being consumed, nullptr between blocks, and its pulls that are
+  // consumed
+  const unsigned int* block;
+  size_t block_used;
+
+ public:
+  PullPipeline();
+  ~PullPipeline();
+
+  // Owns a thread, hence not copyable
+  PullPipeline(const PullPipeline&) = delete;
+  PullPipeline& operator=(const PullPipeline&) = delete;
+
+  // Start the producer thread, which draws pull_time pulls from mt. Only the
+  // producer uses mt and dist until stop()
+  void start(std::mt19937_64& mt, PullDistribution& dist,
+             unsigned long long int pull_time);
+
+  // Simulate the next pull_time pulls of the producer with the kernel of the
+  // given name. Produces the same state as simulate() on the same random
+  // stream, however the pulls are split into calls. At most the pulls of
+  // start() are simulated in total
+  void simulate(const std::string& kernel_name, SimulationState& state,
+                const SimulationParameter& parameter,
+                unsigned long long int pull_time);
+
+  // Stop the producer and wait for it. If every pull of start() was
+  // simulated, mt is left exactly as simulate() leaves it
+  void stop();
+};
+
+#endif  // PULL_PIPELINE_H
@@ -0,0 +1,235 @@
+#include "pull_trace.h"
+
+#include <string.h>  // strerror
+
+#include <cerrno>
+
+#include "table_kernel.h"
+
+TraceWriter::TraceWriter()
+    : file(nullptr),
+      buffer_used(0),
+      last_star6_pull(0),
+      closing(false),
+      write_failed(false) {}
+
+TraceWriter::~TraceWriter() { close(); }
+
+bool TraceWriter::open(const std::string& path, uint_fast64_t seed,
+                       const SimulationParameter& parameter) {
+  file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    unavailable_reason = path + ": " + strerror(errno);
+    return false;
+  }
+  buffer.assign(trace_buffer_size, 0);
+  for (size_t i = 1; i < trace_buffer_num; ++i) {
+    free_buffers.push_back(std::vector<unsigned char>(trace_buffer_size, 0));
+  }
+
+  for (char c : trace_magic) {
+    buffer[buffer_used++] = static_cast<unsigned char>(c);
+  }
+  put_varint(trace_version);
+  put_varint(seed);
+  put_varint(parameter.current_pull);
+
+  writer_thread = std::thread(&TraceWriter::write_loop, this);
+  return true;
+}
+
+bool TraceWriter::is_open() const { return file != nullptr; }
+
+void TraceWriter::write_loop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    full_condition.wait(lock,
+                        [this] { return closing || !full_buffers.empty(); });
+    if (full_buffers.empty()) {
+      return;
+    }
+    std::vector<unsigned char> full = std::move(full_buffers.front());
+    full_buffers.pop_front();
+
+    // Write without the lock, so that the simulation thread can hand over
+    // the next buffer meanwhile. The size of a buffer is its used part
+    lock.unlock();
+    const bool written =
+        fwrite(full.data(), 1, full.size(), file) == full.size();
+    lock.lock();
+
+    write_failed = write_failed || !written;
+    full.resize(trace_buffer_size);
+    free_buffers.push_back(std::move(full));
+    free_condition.notify_one();
+  }
+}
+
+void TraceWriter::swap_buffer() {
+  std::unique_lock<std::mutex> lock(mutex);
+  buffer.resize(buffer_used);
+  full_buffers.push_back(std::move(buffer));
+  full_condition.notify_one();
+  free_condition.wait(lock, [this] { return !free_buffers.empty(); });
+  buffer = std::move(free_buffers.back());
+  free_buffers.pop_back();
+  buffer_used = 0;
+}
+
+void TraceWriter::put_varint(unsigned long long int value) {
+  while (value >= 0x80) {
+    buffer[buffer_used++] = static_cast<unsigned char>(value | 0x80);
+    value >>= 7;
+  }
+  buffer[buffer_used++] = static_cast<unsigned char>(value);
+}
+
+bool TraceWriter::close() {
+  if (file == nullptr) {
+    return true;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.resize(buffer_used);
+    full_buffers.push_back(std::move(buffer));
+    closing = true;
+    full_condition.notify_one();
+  }
+  writer_thread.join();
+
+  const bool closed = fclose(file) == 0;
+  file = nullptr;
+  if (write_failed || !closed) {
+    unavailable_reason = "cannot write the whole trace";
+    return false;
+  }
+  return true;
+}
+
+const std::string& TraceWriter::get_unavailable_reason() const {
+  return unavailable_reason;
+}
+
+unsigned long long int TraceTrial::calc_pull_num() const {
+  unsigned long long int pull_num = 0;
+  for (unsigned long long int length : run_length) {
+    pull_num += length;
+  }
+  return pull_num;
+}
+
+TraceReader::TraceReader()
+    : file(nullptr),
+      buffer(trace_buffer_size),
+      buffer_begin(0),
+      buffer_end(0),
+      corrupted(false),
+      version(0),
+      seed(0),
+      current_pull(0) {}
+
+TraceReader::~TraceReader() {
+  if (file != nullptr) {
+    fclose(file);
+  }
+}
+
+bool TraceReader::get_byte(unsigned char& byte) {
+  if (buffer_begin == buffer_end) {
+    buffer_begin = 0;
+    buffer_end = fread(buffer.data(), 1, buffer.size(), file);
+    if (buffer_end == 0) {
+      return false;
+    }
+  }
+  byte = buffer[buffer_begin++];
+  return true;
+}
+
+bool TraceReader::get_varint(unsigned long long int& value) {
+  value = 0;
+  unsigned char byte = 0;
+  for (unsigned int shift = 0; shift < 7 * max_varint_size; shift += 7) {
+    if (!get_byte(byte)) {
+      // The end of the file is only valid between two varints
+      corrupted = corrupted || shift > 0;
+      return false;
+    }
+    value |= static_cast<unsigned long long int>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  corrupted = true;
+  return false;
+}
+
+bool TraceReader::open(const std::string& path, std::string& reason) {
+  file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    reason = path + ": " + strerror(errno);
+    return false;
+  }
+  for (char c : trace_magic) {
+    unsigned char byte = 0;
+    if (!get_byte(byte) || byte != static_cast<unsigned char>(c)) {
+      reason = path + ": not a trace written by --trace";
+      return false;
+    }
+  }
+  unsigned long long int seed_value = 0;
+  if (!get_varint(version) || !get_varint(seed_value) ||
+      !get_varint(current_pull)) {
+    reason = path + ": the header is truncated";
+    return false;
+  }
+  seed = seed_value;
+  if (version != trace_version) {
+    reason = path + ": the trace is of version " + std::to_string(version) +
+             ", expect " + std::to_string(trace_version);
+    return false;
+  }
+  return true;
+}
+
+bool TraceReader::next_trial(TraceTrial& trial) {
+  trial.run_length.clear();
+  trial.finished = false;
+  unsigned long long int value = 0;
+  while (get_varint(value)) {
+    trial.run_length.push_back(value >> 1);
+    if ((value & 1) != 0) {
+      trial.finished = true;
+      return true;
+    }
+  }
+  // The unfinished trial at the end of the simulation
+  return !trial.run_length.empty();
+}
+
+bool TraceReader::is_corrupted() const { return corrupted; }
+
+// Records every star 6 operator of the table kernel into the trace
+class TraceHook {
+ public:
+  TraceWriter& trace_writer;
+
+  explicit TraceHook(TraceWriter& _trace_writer)
+      : trace_writer(_trace_writer) {}
+
+  inline void begin(unsigned long long int) {}
+  inline void star6(unsigned long long int pull_count, unsigned long long int,
+                    unsigned long long int, bool is_target) {
+    trace_writer.record_star6(pull_count, is_target);
+  }
+  inline void end(unsigned long long int) {}
+};
+
+void simulate_trace(SimulationState& state, TraceWriter& trace_writer,
+                    const SimulationParameter& parameter,
+                    std::mt19937_64& mt, PullDistribution& dist,
+                    unsigned long long int pull_time) {
+  FilledPullSource source(mt, dist);
+  TraceHook hook(trace_writer);
+  simulate_table_impl(state, parameter, source, hook, pull_time);
+}
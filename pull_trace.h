@@ -0,0 +1,151 @@
+#ifndef PULL_TRACE_H
+#define PULL_TRACE_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// The per-trial sequence of a simulation recorded by --trace, for debugging
+// the model and reconstructing joint statistics offline.
+//
+// A trial is a sequence of runs (see markov_chain.h), each ending with a
+// star 6 operator, and the last one with the target star 6 operator. The
+// trace stores every run as one unsigned LEB128 varint of
+//     (run length << 1) | (1 if the star 6 operator is the target one)
+// where the run length is the pulls since the previous star 6 operator of
+// the trial, i.e., the pull numbers are delta encoded. A run of a trial
+// starts with the pity counter -c|--current-pull if it is the first run,
+// otherwise 0, hence the pity counters reached are the start plus the run
+// length minus one. Most runs take one byte.
+//
+// The file starts with trace_magic, followed by the varints of the version,
+// the random seed and -c|--current-pull. Runs of a trial that is unfinished
+// at the end of the simulation are recorded as well, the partial run at the
+// end is not.
+//
+// The simulation thread encodes into its own buffer, and hands full buffers
+// to a background thread that writes them, so the kernel never waits for
+// the file unless the disk falls behind.
+
+// Identifies the format of the file
+const char trace_magic[8] = {'A', 'R', 'K', 'T', 'R', 'A', 'C', 'E'};
+const unsigned long long int trace_version = 1;
+
+// Size of a buffer, and number of buffers shared by the simulation thread
+// and the writer thread
+const size_t trace_buffer_size = 1 << 20;
+const size_t trace_buffer_num = 4;
+// The maximum size of a varint of 64 bits
+const size_t max_varint_size = 10;
+
+class TraceWriter {
+ private:
+  FILE* file;
+  std::string unavailable_reason;
+
+  // The buffer that the simulation thread is encoding into
+  std::vector<unsigned char> buffer;
+  size_t buffer_used;
+  // The pull of the trial that the previous star 6 operator happened at
+  unsigned long long int last_star6_pull;
+
+  // Full buffers waiting to be written, and written buffers to be reused
+  std::deque<std::vector<unsigned char>> full_buffers;
+  std::vector<std::vector<unsigned char>> free_buffers;
+  std::mutex mutex;
+  std::condition_variable full_condition;
+  std::condition_variable free_condition;
+  bool closing;
+  bool write_failed;
+  std::thread writer_thread;
+
+  void write_loop();
+  // Hand the buffer to the writer thread and take a free one
+  void swap_buffer();
+  void put_varint(unsigned long long int value);
+
+ public:
+  TraceWriter();
+  ~TraceWriter();
+
+  // Create the file, write the header and start the writer thread. Return
+  // false if the file cannot be created
+  bool open(const std::string& path, uint_fast64_t seed,
+            const SimulationParameter& parameter);
+  bool is_open() const;
+  // Write the rest of the trace and stop the writer thread. Return false if
+  // any write failed
+  bool close();
+  const std::string& get_unavailable_reason() const;
+
+  // Record a star 6 operator got at the pull-th pull of the current trial
+  inline void record_star6(unsigned long long int pull, bool is_target) {
+    if (buffer_used + max_varint_size > buffer.size()) {
+      swap_buffer();
+    }
+    put_varint(((pull - last_star6_pull) << 1) | (is_target ? 1 : 0));
+    last_star6_pull = is_target ? 0 : pull;
+  }
+};
+
+// A trial read from a trace
+class TraceTrial {
+ public:
+  // The length of every run, the last one ends with the target star 6
+  // operator if the trial is finished
+  std::vector<unsigned long long int> run_length;
+  bool finished;
+
+  // Total pulls of the trial
+  unsigned long long int calc_pull_num() const;
+};
+
+// Stream a trace back trial by trial with a fixed size buffer, so that a
+// trace of any size is read without loading it whole
+class TraceReader {
+ private:
+  FILE* file;
+  std::vector<unsigned char> buffer;
+  size_t buffer_begin;
+  size_t buffer_end;
+  bool corrupted;
+
+  // Return false at the end of the file
+  bool get_byte(unsigned char& byte);
+  // Return false at the end of the file or if the varint is truncated or
+  // too long (then corrupted is set)
+  bool get_varint(unsigned long long int& value);
+
+ public:
+  unsigned long long int version;
+  uint_fast64_t seed;
+  unsigned long long int current_pull;
+
+  TraceReader();
+  ~TraceReader();
+
+  // Open the trace and read its header. Return false and the reason if it
+  // is not a trace of this version
+  bool open(const std::string& path, std::string& reason);
+  // Read the next trial. Return false at the end of the trace
+  bool next_trial(TraceTrial& trial);
+  // Return true if the trace ends in the middle of a varint
+  bool is_corrupted() const;
+};
+
+// Simulate pull_time pulls with the table kernel (table_kernel.h), and
+// record every star 6 operator into the trace. Updates state exactly as the
+// other kernels do. The tables must not be empty
+void simulate_trace(SimulationState& state, TraceWriter& trace_writer,
+                    const SimulationParameter& parameter,
+                    std::mt19937_64& mt, PullDistribution& dist,
+                    unsigned long long int pull_time);
+
+#endif  // PULL_TRACE_H
@@ -0,0 +1,193 @@
+#include "rarity_model.h"
+
+#include <algorithm>  // min
+#include <cmath>      // round
+
+RarityModel::RarityModel(ProbabilityWrapper& probability_wrapper,
+                         const SimulationParameter& parameter)
+    : level_num(1) {
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  // The star 6 operator is guaranteed once its threshold covers the range
+  if (parameter.delta_star6_threshold > 0) {
+    while (parameter.init_star6_threshold +
+               (level_num - 1) *
+                   static_cast<unsigned long long int>(
+                       parameter.delta_star6_threshold) <
+           dist_size) {
+      level_num++;
+    }
+  }
+
+  const unsigned long long int banner_operator_num =
+      probability_wrapper.get_banner_operator_num();
+  const double lower_rarity_rate =
+      base_star5_rate + base_star4_rate + base_star3_rate;
+
+  table.assign(level_num * dist_size, outcome_star3);
+  prob.assign(level_num * outcome_num, 0.0);
+  for (unsigned long long int level = 0; level < level_num; ++level) {
+    const unsigned long long int star6_threshold = std::min(
+        parameter.init_star6_threshold + level * parameter.delta_star6_threshold,
+        dist_size);
+    const unsigned long long int target_star6_threshold =
+        std::min(parameter.init_target_star6_threshold +
+                     level * parameter.delta_target_star6_threshold,
+                 star6_threshold);
+    const unsigned long long int rate_up_star6_threshold = std::min(
+        target_star6_threshold * banner_operator_num, star6_threshold);
+    const unsigned long long int rest = dist_size - star6_threshold;
+    const unsigned long long int star5_threshold =
+        star6_threshold + static_cast<unsigned long long int>(std::round(
+                              rest * base_star5_rate / lower_rarity_rate));
+    const unsigned long long int star4_threshold =
+        star5_threshold + static_cast<unsigned long long int>(std::round(
+                              rest * base_star4_rate / lower_rarity_rate));
+
+    // The upper borders of the outcome classes, in the order of the classes
+    const unsigned long long int border[outcome_num] = {
+        target_star6_threshold, rate_up_star6_threshold, star6_threshold,
+        star5_threshold,        star4_threshold,         dist_size};
+    unsigned long long int r = 0;
+    for (unsigned int outcome = 0; outcome < outcome_num; ++outcome) {
+      prob[level * outcome_num + outcome] =
+          static_cast<double>(border[outcome] - r) / dist_size;
+      for (; r < border[outcome]; ++r) {
+        table[level * dist_size + r] = static_cast<unsigned char>(outcome);
+      }
+    }
+  }
+}
+
+RarityStatistics::RarityStatistics()
+    : outcome_count(outcome_num, 0),
+      histogram(outcome_num * outcome_histogram_size, 0),
+      trial_outcome_count(outcome_num, 0) {}
+
+// Move the counters of the finished trial into the histograms
+static void finish_trial(RarityStatistics& statistics) {
+  for (unsigned int outcome = 0; outcome < outcome_num; ++outcome) {
+    const unsigned long long int count =
+        statistics.trial_outcome_count[outcome];
+    statistics.outcome_count[outcome] += count;
+    statistics.histogram[outcome * outcome_histogram_size +
+                         std::min<unsigned long long int>(
+                             count, outcome_histogram_size - 1)]++;
+    statistics.trial_outcome_count[outcome] = 0;
+  }
+}
+
+// The pity level of the given star 6 threshold
+static unsigned long long int calc_level(const RarityModel& model,
+                                         const SimulationParameter& parameter,
+                                         unsigned long long int threshold) {
+  if (parameter.delta_star6_threshold == 0) {
+    return 0;
+  }
+  return std::min<unsigned long long int>(
+      (threshold - parameter.init_star6_threshold) /
+          parameter.delta_star6_threshold,
+      model.level_num - 1);
+}
+
+// The counters of the outcome classes of a block are packed into one
+// register, with this many bits per class. A block has fewer pulls than
+// 2^outcome_counter_bits, so the fields never overflow
+const unsigned int outcome_counter_bits = 10;
+static_assert(pull_block_size < (1u << outcome_counter_bits),
+              "a block must fit in the packed outcome counters");
+static_assert(outcome_num * outcome_counter_bits <= 64,
+              "the packed outcome counters must fit in 64 bits");
+
+// Add the packed counters to the counters of the current trial
+static void unpack_outcome_count(RarityStatistics& statistics,
+                                 unsigned long long int packed_count) {
+  const unsigned long long int field_mask = (1ULL << outcome_counter_bits) - 1;
+  for (unsigned int outcome = 0; outcome < outcome_num; ++outcome) {
+    statistics.trial_outcome_count[outcome] +=
+        (packed_count >> (outcome * outcome_counter_bits)) & field_mask;
+  }
+}
+
+void simulate_rarity(SimulationState& state, RarityStatistics& statistics,
+                     const RarityModel& model,
+                     const SimulationParameter& parameter,
+                     std::mt19937_64& mt, PullDistribution& dist,
+                     unsigned long long int pull_time) {
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  const unsigned long long int start_level =
+      calc_level(model, parameter, parameter.start_star6_threshold);
+  unsigned long long int level =
+      calc_level(model, parameter, state.star6_threshold);
+  const unsigned char* row = &model.table[level * dist_size];
+
+  // Keep the state in local variables so that the compiler can hold them in
+  // registers instead of reloading them through the reference
+  unsigned long long int star6_count = state.star6_count;
+  unsigned long long int target_star6_count = state.target_star6_count;
+  unsigned long long int pity_count = state.pity_count;
+  unsigned long long int current_pull_count = state.current_pull_count;
+  unsigned long long int* result = state.result.data();
+  const unsigned long long int result_length = state.result.size();
+  const unsigned long long int pity_starting_point =
+      parameter.pity_starting_point;
+  const unsigned long long int current_pull = parameter.current_pull;
+  const unsigned long long int last_level = model.level_num - 1;
+
+  unsigned int block[pull_block_size];
+  for (unsigned long long int i = 0; i < pull_time;) {
+    const size_t block_size =
+        std::min<unsigned long long int>(pull_block_size, pull_time - i);
+    fill_pull_block(mt, dist, block, block_size);
+    i += block_size;
+
+    unsigned long long int packed_count = 0;
+    for (size_t j = 0; j < block_size; ++j) {
+      // One lookup classifies the pull
+      const unsigned int outcome = row[block[j] - dist_left_border];
+      packed_count += 1ULL << (outcome * outcome_counter_bits);
+      current_pull_count++;  // leave the index 0 of result vector unused
+      if (outcome <= outcome_off_banner_star6) {
+        star6_count++;
+        if (outcome == outcome_target_star6) {
+          target_star6_count++;
+          if (current_pull_count < result_length) {
+            result[current_pull_count]++;
+          } else if (state.rare_event.size() < max_rare_event_map_size) {
+            state.rare_event[current_pull_count]++;
+          }
+          current_pull_count = 0;
+          // Finish currrent trial, and start next trial with current_pull
+          pity_count = current_pull;
+          level = start_level;
+          unpack_outcome_count(statistics, packed_count);
+          packed_count = 0;
+          finish_trial(statistics);
+        } else {
+          pity_count = 0;
+          level = 0;
+        }
+        row = &model.table[level * dist_size];
+      } else {
+        pity_count++;
+        if (pity_count >= pity_starting_point && level < last_level) {
+          level++;
+          row += dist_size;
+        }
+      }
+    }
+    unpack_outcome_count(statistics, packed_count);
+  }
+
+  state.star6_count = star6_count;
+  state.target_star6_count = target_star6_count;
+  state.pity_count = pity_count;
+  state.current_pull_count = current_pull_count;
+  // Keep the thresholds of the state in sync, so that the other kernels can
+  // continue the simulation
+  state.star6_threshold = parameter.init_star6_threshold +
+                          level * parameter.delta_star6_threshold;
+  state.target_star6_threshold = parameter.init_target_star6_threshold +
+                                 level * parameter.delta_target_star6_threshold;
+}
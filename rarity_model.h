@@ -0,0 +1,85 @@
+#ifndef RARITY_MODEL_H
+#define RARITY_MODEL_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "probability_wrapper.h"
+#include "simulation_kernel.h"
+
+// The full outcome of a pull, i.e., which star 6 operator or which rarity.
+//
+// For every pity level (the number of times that the thresholds have been
+// raised), a lookup table maps each value of the random number straight to
+// the outcome of the pull, so that a pull is classified with one lookup.
+// The star 6 part of a table uses exactly the thresholds of the other
+// kernels, so the star 6 and target star 6 results are identical to them
+// for the same random stream. The rest of the range is split among the
+// lower rarities in proportion to their base rates (the increased star 6
+// rate is taken from them proportionally), rounded to the resolution of the
+// random number.
+
+// Outcome classes of a pull
+const unsigned int outcome_target_star6 = 0;  // the first rate-up operator
+const unsigned int outcome_other_rate_up_star6 = 1;
+const unsigned int outcome_off_banner_star6 = 2;
+const unsigned int outcome_star5 = 3;
+const unsigned int outcome_star4 = 4;
+const unsigned int outcome_star3 = 5;
+const unsigned int outcome_num = 6;
+
+const std::string outcome_name[outcome_num] = {
+    "Target star 6", "Other rate-up star 6", "Off-banner star 6",
+    "Star 5",        "Star 4",               "Star 3"};
+
+// Base rates of the lower rarities in Arknights. Only their ratio matters
+const double base_star5_rate = 0.08;
+const double base_star4_rate = 0.5;
+const double base_star3_rate = 0.4;
+
+// Length of the per-trial histograms of each outcome class. Trials with more
+// pulls of a class are counted in the last bin
+const size_t outcome_histogram_size = 1000;
+
+class RarityModel {
+ public:
+  // Number of pity levels. The star 6 operator is guaranteed at the last one
+  unsigned int level_num;
+
+  // table[level * dist_size + r]: the outcome class of the random number r
+  // at the pity level
+  std::vector<unsigned char> table;
+
+  // The probability of each outcome class at each pity level, i.e.,
+  // prob[level * outcome_num + outcome]
+  std::vector<double> prob;
+
+  RarityModel(ProbabilityWrapper& probability_wrapper,
+              const SimulationParameter& parameter);
+};
+
+// Counters of the outcome classes
+class RarityStatistics {
+ public:
+  // Times of each outcome class in the finished trials
+  std::vector<unsigned long long int> outcome_count;
+  // histogram[outcome * outcome_histogram_size + k]: number of trials that
+  // got the outcome class k times
+  std::vector<unsigned long long int> histogram;
+  // Times of each outcome class in the current, unfinished trial
+  std::vector<unsigned long long int> trial_outcome_count;
+
+  RarityStatistics();
+};
+
+// Simulate pull_time pulls with the lookup tables of model. Updates state
+// exactly as the other kernels do, and counts the outcome classes into
+// statistics. Can be called several times to continue a simulation
+void simulate_rarity(SimulationState& state, RarityStatistics& statistics,
+                     const RarityModel& model,
+                     const SimulationParameter& parameter,
+                     std::mt19937_64& mt, PullDistribution& dist,
+                     unsigned long long int pull_time);
+
+#endif  // RARITY_MODEL_H
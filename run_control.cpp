@@ -0,0 +1,41 @@
+#include "run_control.h"
+
+#include <signal.h>
+
+// Only written by the signal handler
+static volatile sig_atomic_t stop_signal_received = 0;
+
+static void handle_stop_signal(int) { stop_signal_received = 1; }
+
+RunControl::RunControl(unsigned long long int time_budget)
+    : time_budget(time_budget) {
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += static_cast<time_t>(time_budget);
+}
+
+bool RunControl::is_deadline_passed() const {
+  if (time_budget == 0) {
+    return false;
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec > deadline.tv_sec ||
+         (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+}
+
+bool RunControl::should_stop() const {
+  return is_stop_signal_received() || is_deadline_passed();
+}
+
+void install_stop_signal_handler() {
+  struct sigaction action;
+  action.sa_handler = handle_stop_signal;
+  sigemptyset(&action.sa_mask);
+  // Restore the default action after the first signal, so that a second one
+  // still terminates a program that does not stop in time
+  action.sa_flags = SA_RESETHAND;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+}
+
+bool is_stop_signal_received() { return stop_signal_received != 0; }
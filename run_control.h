@@ -0,0 +1,40 @@
+#ifndef RUN_CONTROL_H
+#define RUN_CONTROL_H
+
+#include <time.h>
+
+// Stop a simulation cleanly before all of its pulls are done.
+//
+// The simulation runs in chunks of pulls, and checks between the chunks
+// whether its time budget has run out or SIGINT/SIGTERM has been received.
+// Either way, the pulls finished so far are kept and reported as usual.
+
+// Number of pulls between two checks, i.e., a few milliseconds of simulation
+const unsigned long long int run_chunk_pull_time = 1ULL << 20;
+// The maximum valid value of --time-budget in seconds, i.e., one year
+const unsigned long long int max_time_budget = 31536000;
+
+class RunControl {
+ public:
+  // Wall clock seconds that the simulation may take, 0 if it is unlimited
+  unsigned long long int time_budget;
+  // CLOCK_MONOTONIC time when the time budget runs out
+  struct timespec deadline;
+
+  // The time budget starts when the RunControl is constructed
+  explicit RunControl(unsigned long long int time_budget);
+
+  // Return true if the time budget has run out
+  bool is_deadline_passed() const;
+  // Return true if the simulation should stop before its next chunk
+  bool should_stop() const;
+};
+
+// Catch SIGINT and SIGTERM so that the simulation stops after its current
+// chunk. A second signal terminates the program as usual
+void install_stop_signal_handler();
+
+// Return true if SIGINT or SIGTERM has been received
+bool is_stop_signal_received();
+
+#endif  // RUN_CONTROL_H
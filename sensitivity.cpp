@@ -0,0 +1,226 @@
+#include "sensitivity.h"
+
+#include <algorithm>  // min
+#include <cmath>      // sqrt
+
+#include "table_kernel.h"
+
+SensitivityModel::SensitivityModel() : pity_num(0) {}
+
+SensitivityModel::SensitivityModel(ProbabilityWrapper& probability_wrapper,
+                                   const SimulationParameter& parameter)
+    : pity_num(parameter.star6_threshold_table.size()),
+      star6_prob(pity_num, 0.0),
+      target_star6_prob(pity_num, 0.0),
+      star6_derivative(sensitivity_parameter_num * pity_num, 0.0),
+      target_star6_derivative(sensitivity_parameter_num * pity_num, 0.0),
+      target_score(sensitivity_parameter_num * pity_num, 0.0),
+      off_target_score(sensitivity_parameter_num * pity_num, 0.0),
+      fail_score_sum(sensitivity_parameter_num * (pity_num + 1), 0.0) {
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  const double conditional_rate =
+      probability_wrapper.get_on_banner_star6_conditional_rate();
+
+  for (unsigned long long int p = 0; p < pity_num; ++p) {
+    const unsigned long long int star6_threshold =
+        std::min(parameter.star6_threshold_table[p], dist_size);
+    const unsigned long long int target_star6_threshold =
+        std::min(parameter.target_star6_threshold_table[p], star6_threshold);
+    const double star6 = static_cast<double>(star6_threshold) / dist_size;
+    const double target_star6 =
+        static_cast<double>(target_star6_threshold) / dist_size;
+    star6_prob[p] = star6;
+    target_star6_prob[p] = target_star6;
+
+    // The guaranteed star 6 operator does not depend on the rates
+    if (star6_threshold < dist_size) {
+      star6_derivative[sensitivity_base_star6_rate * pity_num + p] = 1.0;
+      star6_derivative[sensitivity_delta_star6_rate * pity_num + p] =
+          static_cast<double>(
+              calc_raise_num(parameter.pity_starting_point, p));
+    }
+    // The target takes the same share of every change of S_p
+    const double target_share = star6 > 0.0 ? target_star6 / star6 : 0.0;
+    for (unsigned int k = 0; k < sensitivity_parameter_num; ++k) {
+      target_star6_derivative[k * pity_num + p] =
+          target_share * star6_derivative[k * pity_num + p];
+    }
+    if (conditional_rate > 0.0) {
+      target_star6_derivative[sensitivity_conditional_rate * pity_num + p] =
+          target_star6 / conditional_rate;
+    }
+  }
+
+  for (unsigned int k = 0; k < sensitivity_parameter_num; ++k) {
+    for (unsigned long long int p = 0; p < pity_num; ++p) {
+      const double star6 = star6_prob[p];
+      const double target_star6 = target_star6_prob[p];
+      const double d_star6 = star6_derivative[k * pity_num + p];
+      const double d_target_star6 = target_star6_derivative[k * pity_num + p];
+      // The scores of the outcomes that cannot happen are never added
+      if (target_star6 > 0.0) {
+        target_score[k * pity_num + p] = d_target_star6 / target_star6;
+      }
+      if (star6 > target_star6) {
+        off_target_score[k * pity_num + p] =
+            (d_star6 - d_target_star6) / (star6 - target_star6);
+      }
+      const double fail_score = star6 < 1.0 ? -d_star6 / (1.0 - star6) : 0.0;
+      fail_score_sum[k * (pity_num + 1) + p + 1] =
+          fail_score_sum[k * (pity_num + 1) + p] + fail_score;
+    }
+  }
+}
+
+SensitivityStatistics::SensitivityStatistics()
+    : trial_num(0),
+      score_sum(sensitivity_parameter_num, 0.0),
+      squared_score_sum(sensitivity_parameter_num, 0.0),
+      result_score_sum(sensitivity_parameter_num * result_size, 0.0),
+      result_squared_score_sum(sensitivity_parameter_num * result_size, 0.0),
+      trial_score(sensitivity_parameter_num, 0.0) {}
+
+// Add the scores of the failed pulls at the pity counters [run_start, p),
+// and the score of the outcome at p (nullptr for none) to the current trial
+static void add_run_score(SensitivityStatistics& statistics,
+                          const SensitivityModel& model,
+                          unsigned long long int run_start,
+                          unsigned long long int p,
+                          const std::vector<double>* outcome_score) {
+  const unsigned long long int stride = model.pity_num + 1;
+  for (unsigned int k = 0; k < sensitivity_parameter_num; ++k) {
+    statistics.trial_score[k] += model.fail_score_sum[k * stride + p] -
+                                 model.fail_score_sum[k * stride + run_start];
+    if (outcome_score != nullptr) {
+      statistics.trial_score[k] += (*outcome_score)[k * model.pity_num + p];
+    }
+  }
+}
+
+// Move the score of the trial that ended at its pull_count-th pull into the
+// sums
+static void finish_trial(SensitivityStatistics& statistics,
+                         unsigned long long int pull_count) {
+  statistics.trial_num++;
+  for (unsigned int k = 0; k < sensitivity_parameter_num; ++k) {
+    const double score = statistics.trial_score[k];
+    statistics.score_sum[k] += score;
+    statistics.squared_score_sum[k] += score * score;
+    if (pull_count < result_size) {
+      statistics.result_score_sum[k * result_size + pull_count] += score;
+      statistics.result_squared_score_sum[k * result_size + pull_count] +=
+          score * score;
+    }
+    statistics.trial_score[k] = 0.0;
+  }
+}
+
+// Adds the scores of the runs of the table kernel to the current trial, and
+// moves the score of every finished trial into the sums
+class SensitivityHook {
+ public:
+  SensitivityStatistics& statistics;
+  const SensitivityModel& model;
+  // The pity index that the trials after the first one start with
+  const unsigned long long int start_pity_index;
+  // The pity index that the current run of failed pulls started with
+  unsigned long long int run_start;
+
+  SensitivityHook(SensitivityStatistics& _statistics,
+                  const SensitivityModel& _model,
+                  const SimulationParameter& parameter)
+      : statistics(_statistics),
+        model(_model),
+        start_pity_index(std::min<unsigned long long int>(
+            parameter.current_pull, _model.pity_num - 1)),
+        run_start(0) {}
+
+  inline void begin(unsigned long long int pity_index) {
+    run_start = pity_index;
+  }
+  inline void star6(unsigned long long int pull_count, unsigned long long int,
+                    unsigned long long int pity_index, bool is_target) {
+    if (is_target) {
+      add_run_score(statistics, model, run_start, pity_index,
+                    &model.target_score);
+      finish_trial(statistics, pull_count);
+      run_start = start_pity_index;
+    } else {
+      add_run_score(statistics, model, run_start, pity_index,
+                    &model.off_target_score);
+      run_start = 0;
+    }
+  }
+  // The next call continues the run from the current pity counter
+  inline void end(unsigned long long int pity_index) {
+    add_run_score(statistics, model, run_start, pity_index, nullptr);
+  }
+};
+
+void simulate_sensitivity(SimulationState& state,
+                          SensitivityStatistics& statistics,
+                          const SensitivityModel& model,
+                          const SimulationParameter& parameter,
+                          std::mt19937_64& mt, PullDistribution& dist,
+                          unsigned long long int pull_time) {
+  FilledPullSource source(mt, dist);
+  SensitivityHook hook(statistics, model, parameter);
+  simulate_table_impl(state, parameter, source, hook, pull_time);
+}
+
+SensitivityEstimate estimate_sensitivity(
+    const SimulationState& state, const SensitivityStatistics& statistics,
+    unsigned int sensitivity_parameter) {
+  SensitivityEstimate estimate;
+  estimate.derivative_s.assign(result_size, 0.0);
+  estimate.standard_error_s.assign(result_size, 0.0);
+  estimate.derivative_w.assign(result_size, 0.0);
+  estimate.standard_error_w.assign(result_size, 0.0);
+  estimate.derivative_mean_pull = 0.0;
+  if (statistics.trial_num == 0) {
+    return estimate;
+  }
+
+  const double n = static_cast<double>(statistics.trial_num);
+  const double score_sum = statistics.score_sum[sensitivity_parameter];
+  const double squared_score_sum =
+      statistics.squared_score_sum[sensitivity_parameter];
+  const double* result_score_sum =
+      &statistics.result_score_sum[sensitivity_parameter * result_size];
+  const double* result_squared_score_sum =
+      &statistics.result_squared_score_sum[sensitivity_parameter * result_size];
+
+  // The mean and the standard error of (a - prob) * score over the trials,
+  // where a is 1 for the trials counted in count, and their scores sum up to
+  // a_score_sum and a_squared_score_sum
+  auto estimate_mean = [n, score_sum, squared_score_sum](
+                           double count, double a_score_sum,
+                           double a_squared_score_sum, double& derivative,
+                           double& standard_error) {
+    const double prob = count / n;
+    derivative = (a_score_sum - prob * score_sum) / n;
+    const double second_moment = ((1.0 - 2.0 * prob) * a_squared_score_sum +
+                                  prob * prob * squared_score_sum) /
+                                 n;
+    standard_error =
+        std::sqrt(std::max(second_moment - derivative * derivative, 0.0) / n);
+  };
+
+  double cumulated_count = 0.0;
+  double cumulated_score_sum = 0.0;
+  double cumulated_squared_score_sum = 0.0;
+  for (size_t i = 1; i < result_size; ++i) {
+    const double count = static_cast<double>(state.result[i]);
+    estimate_mean(count, result_score_sum[i], result_squared_score_sum[i],
+                  estimate.derivative_s[i], estimate.standard_error_s[i]);
+    cumulated_count += count;
+    cumulated_score_sum += result_score_sum[i];
+    cumulated_squared_score_sum += result_squared_score_sum[i];
+    estimate_mean(cumulated_count, cumulated_score_sum,
+                  cumulated_squared_score_sum, estimate.derivative_w[i],
+                  estimate.standard_error_w[i]);
+    estimate.derivative_mean_pull += i * estimate.derivative_s[i];
+  }
+  return estimate;
+}
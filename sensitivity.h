@@ -0,0 +1,117 @@
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "probability_wrapper.h"
+#include "simulation_kernel.h"
+
+// The derivatives of Pr(S_i) and Pr(W_i) by the rate parameters of the
+// banner, estimated by --sensitivity from the trials of the same simulation
+// with the score function (likelihood ratio) method.
+//
+// A trial is a sequence of pulls, each of which fails with the probability
+// 1 - S_p, gets the target star 6 operator with T_p, or another star 6
+// operator with S_p - T_p, where p is the pity counter. The score of a trial
+// is the derivative of the log of its probability, i.e., the sum of
+// d log(1 - S_p), d log(T_p) or d log(S_p - T_p) over its pulls, and
+//     d Pr(S_i) = E[(1{trial ends at pull i} - Pr(S_i)) * score]
+// since E[score] = 0. The probabilities are the ones of the thresholds, with
+//     S_p = base_star6_rate + (raises after p failed pulls) * delta_base_star6_rate
+//     T_p = S_p * on_banner_star6_conditional_rate / rate-up operators
+// and the guaranteed star 6 operator stays guaranteed, i.e., S_p = 1 does
+// not depend on the parameters.
+//
+// The scores only change at the star 6 operators: a run of failed pulls
+// from the pity counter p0 to p adds the difference of a prefix sum of the
+// failure scores, so the pulls in between cost the same as in the other
+// kernels.
+
+// The parameters that the derivatives are taken by
+const unsigned int sensitivity_base_star6_rate = 0;
+const unsigned int sensitivity_delta_star6_rate = 1;
+const unsigned int sensitivity_conditional_rate = 2;
+const unsigned int sensitivity_parameter_num = 3;
+
+const std::string sensitivity_parameter_name[sensitivity_parameter_num] = {
+    "base_star6_rate", "delta_base_star6_rate",
+    "on_banner_star6_conditional_rate"};
+
+// The probabilities of a pull and their derivatives at every pity counter of
+// the threshold tables, which must end at the guaranteed star 6 operator
+class SensitivityModel {
+ public:
+  // Pity counters of the threshold tables
+  unsigned long long int pity_num;
+
+  // S_p and T_p
+  std::vector<double> star6_prob;
+  std::vector<double> target_star6_prob;
+  // dS_p and dT_p by each parameter, i.e.,
+  // star6_derivative[parameter * pity_num + p]
+  std::vector<double> star6_derivative;
+  std::vector<double> target_star6_derivative;
+
+  // The score of the target star 6 operator, of another star 6 operator,
+  // and the sum of the scores of the failed pulls at the pity counters
+  // [0, p), at [parameter * (pity_num + 1) + p] for the sum
+  std::vector<double> target_score;
+  std::vector<double> off_target_score;
+  std::vector<double> fail_score_sum;
+
+  // An empty model, for the runs without --sensitivity
+  SensitivityModel();
+  SensitivityModel(ProbabilityWrapper& probability_wrapper,
+                   const SimulationParameter& parameter);
+};
+
+// The score sums of the trials
+class SensitivityStatistics {
+ public:
+  // The finished trials, and the sums of their scores and squared scores
+  unsigned long long int trial_num;
+  std::vector<double> score_sum;
+  std::vector<double> squared_score_sum;
+  // The same sums of the trials that ended at the pull i, at
+  // [parameter * result_size + i]
+  std::vector<double> result_score_sum;
+  std::vector<double> result_squared_score_sum;
+  // The score of the current, unfinished trial
+  std::vector<double> trial_score;
+
+  SensitivityStatistics();
+};
+
+// The derivatives of Pr(S_i) and Pr(W_i) for i in [1, result_size) (the
+// index 0 is unused) by one parameter, and their standard errors
+class SensitivityEstimate {
+ public:
+  std::vector<double> derivative_s;
+  std::vector<double> standard_error_s;
+  std::vector<double> derivative_w;
+  std::vector<double> standard_error_w;
+  // The derivative of the mean pulls per trial, over the trials that end
+  // within result_size pulls
+  double derivative_mean_pull;
+};
+
+// Simulate pull_time pulls with the table kernel (table_kernel.h), and add
+// the scores of the trials to statistics.
+// Updates state exactly as the other kernels do. Can be called several times
+// to continue a simulation
+void simulate_sensitivity(SimulationState& state,
+                          SensitivityStatistics& statistics,
+                          const SensitivityModel& model,
+                          const SimulationParameter& parameter,
+                          std::mt19937_64& mt, PullDistribution& dist,
+                          unsigned long long int pull_time);
+
+// Estimate the derivatives by the given parameter from the results of the
+// simulation and their scores
+SensitivityEstimate estimate_sensitivity(
+    const SimulationState& state, const SensitivityStatistics& statistics,
+    unsigned int sensitivity_parameter);
+
+#endif  // SENSITIVITY_H
@@ -0,0 +1,209 @@
+#include "shared_result.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <string.h>  // strerror
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>  // isalnum
+#include <cerrno>
+
+// Times that a reader retries while the writer is updating the segment
+static const unsigned int max_read_retry_num = 100000;
+
+SharedResultSnapshot::SharedResultSnapshot()
+    : pid(0),
+      total_pull_time(0),
+      completed_pull_time(0),
+      star6_count(0),
+      target_star6_count(0),
+      rare_event_count(0),
+      finished(false),
+      result(result_size, 0) {}
+
+SharedResultWriter::SharedResultWriter() : segment(nullptr) {}
+
+SharedResultWriter::~SharedResultWriter() {
+  if (segment != nullptr) {
+    munmap(segment, sizeof(SharedResultSegment));
+  }
+}
+
+bool SharedResultWriter::open(const std::string& name,
+                              unsigned long long int total_pull_time) {
+  const std::string path = "/" + name;
+  int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd == -1) {
+    unavailable_reason = std::string("shm_open: ") + strerror(errno);
+    return false;
+  }
+  if (ftruncate(fd, sizeof(SharedResultSegment)) == -1) {
+    unavailable_reason = std::string("ftruncate: ") + strerror(errno);
+    close(fd);
+    return false;
+  }
+  void* address = mmap(nullptr, sizeof(SharedResultSegment),
+                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
+  if (address == MAP_FAILED) {
+    unavailable_reason = std::string("mmap: ") + strerror(errno);
+    return false;
+  }
+  segment = static_cast<SharedResultSegment*>(address);
+
+  // A segment left by a previous run may be reused, hence continue its
+  // sequence number so that its readers notice the change
+  unsigned long long int sequence =
+      segment->sequence.load(std::memory_order_relaxed);
+  if (sequence % 2 != 0) {
+    sequence++;
+  }
+  segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  segment->magic.store(shared_result_magic, std::memory_order_relaxed);
+  segment->version.store(shared_result_version, std::memory_order_relaxed);
+  segment->pid.store(static_cast<unsigned long long int>(getpid()),
+                     std::memory_order_relaxed);
+  segment->total_pull_time.store(total_pull_time, std::memory_order_relaxed);
+  // Clear the results of the previous run
+  segment->completed_pull_time.store(0, std::memory_order_relaxed);
+  segment->star6_count.store(0, std::memory_order_relaxed);
+  segment->target_star6_count.store(0, std::memory_order_relaxed);
+  segment->rare_event_count.store(0, std::memory_order_relaxed);
+  segment->finished.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < result_size; ++i) {
+    segment->result[i].store(0, std::memory_order_relaxed);
+  }
+  segment->sequence.store(sequence + 2, std::memory_order_release);
+  return true;
+}
+
+bool SharedResultWriter::is_open() const { return segment != nullptr; }
+
+void SharedResultWriter::publish(const SimulationState& state,
+                                 unsigned long long int completed_pull_time,
+                                 bool finished) {
+  if (segment == nullptr) {
+    return;
+  }
+  // Only this process writes, hence the sequence number is even here
+  const unsigned long long int sequence =
+      segment->sequence.load(std::memory_order_relaxed);
+  segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  segment->completed_pull_time.store(completed_pull_time,
+                                     std::memory_order_relaxed);
+  segment->star6_count.store(state.star6_count, std::memory_order_relaxed);
+  segment->target_star6_count.store(state.target_star6_count,
+                                    std::memory_order_relaxed);
+  segment->rare_event_count.store(state.rare_event.size(),
+                                  std::memory_order_relaxed);
+  segment->finished.store(finished ? 1 : 0, std::memory_order_relaxed);
+  for (size_t i = 0; i < result_size; ++i) {
+    segment->result[i].store(state.result[i], std::memory_order_relaxed);
+  }
+
+  segment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+const std::string& SharedResultWriter::get_unavailable_reason() const {
+  return unavailable_reason;
+}
+
+bool is_valid_shared_result_name(const std::string& name) {
+  if (name.empty() || name.size() > max_shared_result_name_length) {
+    return false;
+  }
+  for (char c : name) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-' &&
+        c != '.') {
+      return false;
+    }
+  }
+  // "." and ".." are not valid file names
+  return name != "." && name != "..";
+}
+
+bool read_shared_result(const std::string& name,
+                        SharedResultSnapshot& snapshot, std::string& reason) {
+  const std::string path = "/" + name;
+  int fd = shm_open(path.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    reason = std::string("shm_open: ") + strerror(errno);
+    return false;
+  }
+  struct stat status;
+  if (fstat(fd, &status) == -1) {
+    reason = std::string("fstat: ") + strerror(errno);
+    close(fd);
+    return false;
+  }
+  if (static_cast<size_t>(status.st_size) < sizeof(SharedResultSegment)) {
+    reason = "the segment is not created by --shm";
+    close(fd);
+    return false;
+  }
+  void* address =
+      mmap(nullptr, sizeof(SharedResultSegment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    reason = std::string("mmap: ") + strerror(errno);
+    return false;
+  }
+  const SharedResultSegment* segment =
+      static_cast<const SharedResultSegment*>(address);
+
+  bool consistent = false;
+  bool valid_layout = false;
+  for (unsigned int retry = 0; retry < max_read_retry_num && !consistent;
+       ++retry) {
+    const unsigned long long int sequence_before =
+        segment->sequence.load(std::memory_order_acquire);
+    if (sequence_before % 2 != 0) {
+      sched_yield();
+      continue;
+    }
+
+    valid_layout =
+        segment->magic.load(std::memory_order_relaxed) ==
+            shared_result_magic &&
+        segment->version.load(std::memory_order_relaxed) ==
+            shared_result_version;
+    snapshot.pid = segment->pid.load(std::memory_order_relaxed);
+    snapshot.total_pull_time =
+        segment->total_pull_time.load(std::memory_order_relaxed);
+    snapshot.completed_pull_time =
+        segment->completed_pull_time.load(std::memory_order_relaxed);
+    snapshot.star6_count =
+        segment->star6_count.load(std::memory_order_relaxed);
+    snapshot.target_star6_count =
+        segment->target_star6_count.load(std::memory_order_relaxed);
+    snapshot.rare_event_count =
+        segment->rare_event_count.load(std::memory_order_relaxed);
+    snapshot.finished =
+        segment->finished.load(std::memory_order_relaxed) != 0;
+    for (size_t i = 0; i < result_size; ++i) {
+      snapshot.result[i] = segment->result[i].load(std::memory_order_relaxed);
+    }
+
+    // The copy is consistent if no write started during it
+    std::atomic_thread_fence(std::memory_order_acquire);
+    consistent =
+        segment->sequence.load(std::memory_order_relaxed) == sequence_before;
+  }
+  munmap(address, sizeof(SharedResultSegment));
+
+  if (!consistent) {
+    reason = "the segment is being written all the time";
+    return false;
+  }
+  if (!valid_layout) {
+    reason = "the segment is not created by --shm of this version";
+    return false;
+  }
+  return true;
+}
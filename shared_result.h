@@ -0,0 +1,109 @@
+#ifndef SHARED_RESULT_H
+#define SHARED_RESULT_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// Live snapshots of a running simulation in a POSIX shared memory segment.
+//
+// The simulation copies its counters and result histogram into the segment
+// between the chunks of pulls, so the hot loop is not touched. The copies
+// are guarded by a seqlock: the writer makes the sequence number odd while
+// it writes, and a reader retries until it reads the same even sequence
+// number before and after its copy. Hence any number of readers can take
+// consistent snapshots without locks and without slowing the writer down.
+//
+// The segment is kept after the simulation exits, so the final results can
+// still be read. It can be removed with "rm /dev/shm/<name>".
+
+// Identifies the layout of the segment
+const unsigned long long int shared_result_magic = 0x41524b5348524553ULL;
+const unsigned long long int shared_result_version = 1;
+
+// The maximum length of the name given to --shm
+const size_t max_shared_result_name_length = 200;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "the shared counters must be lock-free to be shared across "
+              "processes");
+
+// The layout of the segment. Every field is atomic so that the concurrent
+// accesses of the writer and the readers are well defined; the seqlock
+// decides whether a copy is consistent
+class SharedResultSegment {
+ public:
+  // Odd while the writer is updating the fields below
+  std::atomic<unsigned long long int> sequence;
+  std::atomic<unsigned long long int> magic;
+  std::atomic<unsigned long long int> version;
+  // Process id of the simulation
+  std::atomic<unsigned long long int> pid;
+  // The planned pulls of the run, ~0 if it runs by a time budget
+  std::atomic<unsigned long long int> total_pull_time;
+  std::atomic<unsigned long long int> completed_pull_time;
+  std::atomic<unsigned long long int> star6_count;
+  std::atomic<unsigned long long int> target_star6_count;
+  std::atomic<unsigned long long int> rare_event_count;
+  // 1 after the last snapshot of the run
+  std::atomic<unsigned long long int> finished;
+  std::atomic<unsigned long long int> result[result_size];
+};
+
+// A consistent copy of the segment
+class SharedResultSnapshot {
+ public:
+  unsigned long long int pid;
+  unsigned long long int total_pull_time;
+  unsigned long long int completed_pull_time;
+  unsigned long long int star6_count;
+  unsigned long long int target_star6_count;
+  unsigned long long int rare_event_count;
+  bool finished;
+  std::vector<unsigned long long int> result;
+
+  SharedResultSnapshot();
+};
+
+// Creates the segment and publishes the snapshots of a simulation
+class SharedResultWriter {
+ private:
+  SharedResultSegment* segment;
+
+  // The reason why the segment cannot be created
+  std::string unavailable_reason;
+
+ public:
+  SharedResultWriter();
+
+  ~SharedResultWriter();
+
+  // Owns a mapping, hence not copyable
+  SharedResultWriter(const SharedResultWriter&) = delete;
+  SharedResultWriter& operator=(const SharedResultWriter&) = delete;
+
+  // Create (or reuse) the segment of the given name, and publish an empty
+  // snapshot. Return false and record the reason if failed
+  bool open(const std::string& name, unsigned long long int total_pull_time);
+
+  bool is_open() const;
+
+  // Copy the counters and the result histogram of state into the segment
+  void publish(const SimulationState& state,
+               unsigned long long int completed_pull_time, bool finished);
+
+  const std::string& get_unavailable_reason() const;
+};
+
+// Return true if name can be used as the name of a segment, i.e., a
+// non-empty string of letters, digits, '_', '-' and '.'
+bool is_valid_shared_result_name(const std::string& name);
+
+// Take a consistent snapshot of the segment of the given name. Return false
+// and set reason if the segment cannot be read
+bool read_shared_result(const std::string& name,
+                        SharedResultSnapshot& snapshot, std::string& reason);
+
+#endif  // SHARED_RESULT_H
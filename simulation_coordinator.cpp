@@ -0,0 +1,418 @@
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>  // strerror
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <set>
+
+#include "utils.h"
+
+// Lease the chunks of a simulation to the workers started with
+// ./simulation_sequential --worker <host:port>, merge their results into the
+// usual results and report the throughput of every worker. See chunk_lease.h
+
+// Milliseconds between two checks of the expired leases
+const int coordinator_poll_interval = 100;
+
+void display_coordinator_help_message() {
+  std::cout << "Usage: ./simulation_coordinator [--help] [--listen <address>] [-t|--total-pull-time <value>]\n"
+               "                                [--chunk-pull-time <value>] [--lease-timeout <value>] [--seed <value>]\n\n"
+               "Split the pulls of a simulation into chunks, lease them to the workers started with\n"
+               "./simulation_sequential --worker <address> <banner settings>, and print the merged results\n"
+               "           --listen : Listen for the workers at \"<host>:<port>\", the default value is 127.0.0.1:0,\n"
+               "                      where the port 0 picks a free port, which is printed\n"
+               "-t|--total-pull-time : Set the time of pulling of the whole simulation, the default value is 100000000\n"
+               "  --chunk-pull-time : Set the pulls of a chunk, the default value is 16777216. The last chunk also\n"
+               "                      takes the pulls left over\n"
+               "                      Valid value is an integer of at least 1048576, since every chunk drops its\n"
+               "                      unfinished trial, which biases the results toward short trials\n"
+               "    --lease-timeout : Lease a chunk again to another worker if its worker has not reported for the\n"
+               "                      given number of seconds, the default value is 30\n"
+               "                      Valid value is an integer between [1, 86400]\n"
+               "             --seed : Set the random seed that the seeds of the chunks are derived from, so that a\n"
+               "                      simulation can be repeated with any number of workers\n"
+               "Note: SIGINT (Ctrl+C) and SIGTERM stop the coordinator and still report the merged chunks\n"
+            << std::endl;
+}
+
+// Parse a decimal integer in [min_value, max_value]. Return false if text
+// is not one
+bool parse_coordinator_value(const std::string& text,
+                             unsigned long long int min_value,
+                             unsigned long long int max_value,
+                             unsigned long long int& value) {
+  if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+    return false;
+  }
+  char* p_end = nullptr;
+  errno = 0;
+  value = strtoull(text.c_str(), &p_end, 10);
+  return *p_end == '\0' && errno != ERANGE && value >= min_value &&
+         value <= max_value;
+}
+
+// A worker connected to the coordinator
+class WorkerRecord {
+ public:
+  ChunkConnection connection;
+  // Numbered from 1 in the order of connection
+  unsigned long long int id;
+  // Process id sent in the hello message, 0 until then
+  unsigned long long int pid;
+  bool has_hello;
+  // True while the worker runs a chunk, until its result arrives
+  bool is_busy;
+  // True while the chunk that the worker runs is still leased to it, i.e.,
+  // the lease has not expired
+  bool has_lease;
+  ChunkLease lease;
+  // CLOCK_MONOTONIC time when the lease expires unless the worker reports
+  struct timespec lease_deadline;
+
+  unsigned long long int simulated_chunk_num;
+  unsigned long long int simulated_pull_time;
+  unsigned long long int merged_chunk_num;
+  unsigned long long int merged_pull_time;
+  unsigned long long int expired_lease_num;
+  // Seconds that the worker reported for its chunks
+  double busy_time;
+  std::string status;
+
+  WorkerRecord(int fd, unsigned long long int _id)
+      : connection(fd),
+        id(_id),
+        pid(0),
+        has_hello(false),
+        is_busy(false),
+        has_lease(false),
+        lease_deadline(),
+        simulated_chunk_num(0),
+        simulated_pull_time(0),
+        merged_chunk_num(0),
+        merged_pull_time(0),
+        expired_lease_num(0),
+        busy_time(0.0),
+        status("connected") {}
+};
+
+bool is_time_passed(const struct timespec& deadline) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec > deadline.tv_sec ||
+         (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+}
+
+void renew_lease(WorkerRecord& worker, unsigned long long int lease_timeout) {
+  clock_gettime(CLOCK_MONOTONIC, &worker.lease_deadline);
+  worker.lease_deadline.tv_sec += static_cast<time_t>(lease_timeout);
+}
+
+// Close the connection of a worker, whose chunk is leased again
+void drop_worker(WorkerRecord& worker, ChunkLeaseTable& table,
+                 const std::string& status) {
+  if (worker.has_lease) {
+    table.expire(worker.lease.chunk_index);
+    worker.has_lease = false;
+  }
+  worker.is_busy = false;
+  worker.connection.close();
+  worker.status = status;
+}
+
+void display_coordinator_settings(const std::string& host, unsigned int port,
+                                  const ChunkLeaseTable& table,
+                                  unsigned long long int lease_timeout) {
+  std::cout << "The coordinator settings are:\n";
+  std::cout << "\tListening Address: " << host << ":" << port << "\n";
+  std::cout << "\tTotal Pulling Times: " << table.total_pull_time << "\n";
+  std::cout << "\tChunk Pulling Times: " << table.chunk_pull_time << " ("
+            << table.chunk_num << " chunks)\n";
+  std::cout << "\tLease Timeout: " << lease_timeout << " s\n";
+  std::cout << "\tRandom Seed: " << table.seed << "\n";
+  std::cout << std::endl;
+}
+
+// Display the throughput of every worker, following the merged results
+void display_worker_results(const std::vector<WorkerRecord>& workers,
+                            const ChunkLeaseTable& table) {
+  std::cout << std::endl;
+  std::cout << "WORKERS" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Chunks merged: " << table.merged_chunk_num << " of "
+            << table.chunk_num << std::endl;
+  std::cout << "Leases reissued: " << table.reissued_lease_num << std::endl;
+  std::cout << "Worker\tProcess\tChunks\tMerged\tPulls\t\tBusy time\tPulls "
+               "per second\tExpired leases\tStatus"
+            << std::endl;
+  for (const WorkerRecord& worker : workers) {
+    std::cout << worker.id << '\t' << worker.pid << '\t'
+              << worker.simulated_chunk_num << '\t' << worker.merged_chunk_num
+              << '\t' << worker.simulated_pull_time << "\t" << worker.busy_time
+              << "s\t\t";
+    if (worker.busy_time > 0.0) {
+      std::cout << worker.simulated_pull_time / worker.busy_time;
+    } else {
+      std::cout << "-";
+    }
+    std::cout << "\t\t" << worker.expired_lease_num << "\t\t" << worker.status
+              << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc == 2 && std::string(argv[1]) == "--help") {
+    display_coordinator_help_message();
+    return 0;
+  }
+
+  std::string listen_address = "127.0.0.1:0";
+  unsigned long long int total_pull_time = 100000000;
+  unsigned long long int chunk_pull_time = default_chunk_pull_time;
+  unsigned long long int lease_timeout = default_lease_timeout;
+  uint_fast64_t seed = get_random_seed();
+  std::set<std::string> given_option;
+  for (int i = 1; i < argc; ++i) {
+    std::string option(argv[i]);
+    if (option == "-t") {
+      option = "--total-pull-time";
+    }
+    const bool is_known = option == "--listen" ||
+                          option == "--total-pull-time" ||
+                          option == "--chunk-pull-time" ||
+                          option == "--lease-timeout" || option == "--seed";
+    if (!is_known || given_option.count(option) > 0 || i + 1 >= argc) {
+      std::cerr << "Invalid or redundant argument \"" << argv[i]
+                << "\", or it misses its value\n"
+                << std::endl;
+      display_coordinator_help_message();
+      return 1;
+    }
+    given_option.insert(option);
+    const std::string value(argv[++i]);
+    bool is_valid = true;
+    if (option == "--listen") {
+      std::string host;
+      unsigned int port = 0;
+      is_valid = parse_chunk_address(value, host, port);
+      listen_address = value;
+    } else if (option == "--total-pull-time") {
+      is_valid = parse_coordinator_value(value, 1, ~0ULL, total_pull_time);
+    } else if (option == "--chunk-pull-time") {
+      is_valid = parse_coordinator_value(value, min_chunk_pull_time, ~0ULL,
+                                         chunk_pull_time);
+    } else if (option == "--lease-timeout") {
+      is_valid = parse_coordinator_value(value, 1, max_lease_timeout,
+                                         lease_timeout);
+    } else {
+      unsigned long long int seed_value = 0;
+      is_valid = parse_coordinator_value(value, 0, ~0ULL, seed_value);
+      seed = seed_value;
+    }
+    if (!is_valid) {
+      std::cerr << "Invalid value \"" << value << "\" for \"" << argv[i - 1]
+                << "\"\n"
+                << std::endl;
+      display_coordinator_help_message();
+      return 1;
+    }
+  }
+
+  unsigned int port = 0;
+  std::string reason;
+  const int listener = open_chunk_listener(listen_address, port, reason);
+  if (listener == -1) {
+    std::cerr << "Cannot listen at " << listen_address << " (" << reason
+              << ")\n"
+              << std::endl;
+    return 1;
+  }
+  std::string host;
+  unsigned int given_port = 0;
+  parse_chunk_address(listen_address, host, given_port);
+
+  ChunkLeaseTable table(total_pull_time, chunk_pull_time, seed);
+  display_coordinator_settings(host, port, table, lease_timeout);
+  std::cout << "Now will wait for the workers, start them with\n"
+               "./simulation_sequential --worker <address> <banner settings>"
+               "...\n"
+            << std::endl;
+
+  // Stop leasing on SIGINT or SIGTERM, and still report the merged chunks
+  install_stop_signal_handler();
+
+  // Only the counters and the histograms of the state are merged, hence the
+  // banner settings that construct it do not matter
+  ProbabilityWrapper probability_wrapper(0.02, 0.7, 0.02, 2);
+  const SimulationParameter parameter(probability_wrapper, 50, 0);
+  SimulationState state(parameter);
+
+  // The settings sent by the first worker, which the others must match
+  std::vector<unsigned long long int> settings;
+  std::vector<WorkerRecord> workers;
+  struct timespec start = {0, 0};
+  struct timespec end = {0, 0};
+  bool started = false;
+  unsigned long long int type = 0;
+  std::vector<unsigned long long int> words;
+  ChunkResult chunk_result;
+  while (!table.is_finished() && !is_stop_signal_received()) {
+    std::vector<struct pollfd> poll_fds(1);
+    poll_fds[0].fd = listener;
+    poll_fds[0].events = POLLIN;
+    for (const WorkerRecord& worker : workers) {
+      struct pollfd poll_fd;
+      poll_fd.fd = worker.connection.fd;  // ignored by poll if closed, i.e., -1
+      poll_fd.events = POLLIN;
+      poll_fd.revents = 0;
+      poll_fds.push_back(poll_fd);
+    }
+    if (poll(poll_fds.data(), poll_fds.size(), coordinator_poll_interval) ==
+        -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "poll: " << strerror(errno) << std::endl;
+      break;
+    }
+
+    // Receive the messages of the workers
+    for (size_t i = 0; i < workers.size(); ++i) {
+      WorkerRecord& worker = workers[i];
+      if (!worker.connection.is_open() || poll_fds[i + 1].revents == 0) {
+        continue;
+      }
+      const bool is_alive = worker.connection.receive_available();
+      while (worker.connection.pop_message(type, words)) {
+        if (type == chunk_message_hello && !worker.has_hello) {
+          const bool is_valid = words.size() > chunk_hello_header_word_num &&
+                                words[0] == chunk_lease_magic &&
+                                words[1] == chunk_lease_version;
+          const std::vector<unsigned long long int> worker_settings(
+              words.begin() +
+                  std::min(words.size(), chunk_hello_header_word_num),
+              words.end());
+          if (is_valid && settings.empty()) {
+            settings = worker_settings;
+          }
+          if (!is_valid || worker_settings != settings) {
+            worker.connection.send_message(chunk_message_reject, {});
+            drop_worker(worker, table, "rejected");
+            std::cout << "Note: Rejected worker " << worker.id
+                      << ", its banner settings, --kernel lanes or "
+                         "--recycle-bits differ from the ones of the first "
+                         "worker"
+                      << std::endl;
+            break;
+          }
+          worker.has_hello = true;
+          worker.pid = words[2];
+        } else if (type == chunk_message_progress && words.size() == 2 &&
+                   worker.is_busy && words[0] == worker.lease.chunk_index) {
+          if (worker.has_lease) {
+            renew_lease(worker, lease_timeout);
+          }
+        } else if (type == chunk_message_result && worker.is_busy &&
+                   decode_chunk_result(words, chunk_result) &&
+                   chunk_result.chunk_index == worker.lease.chunk_index &&
+                   chunk_result.pull_time == worker.lease.pull_time) {
+          worker.is_busy = false;
+          worker.has_lease = false;
+          worker.simulated_chunk_num++;
+          worker.simulated_pull_time += chunk_result.pull_time;
+          worker.busy_time += chunk_result.elapsed_ns / 1e9;
+          // A chunk leased again may be finished twice, and the results
+          // are identical since it has the same seed and the workers have
+          // the same settings
+          if (table.merge(chunk_result.chunk_index)) {
+            merge_chunk_result(state, chunk_result);
+            worker.merged_chunk_num++;
+            worker.merged_pull_time += chunk_result.pull_time;
+          }
+        } else {
+          drop_worker(worker, table, "lost (unexpected message)");
+          break;
+        }
+      }
+      if (!is_alive && worker.connection.is_open()) {
+        drop_worker(worker, table, "lost");
+      } else if (!worker.connection.is_open() && worker.status == "connected") {
+        drop_worker(worker, table, "lost");
+      }
+      if (worker.status == "lost") {
+        std::cout << "Note: Lost worker " << worker.id << " ("
+                  << worker.connection.unavailable_reason
+                  << "), its chunk will be leased again" << std::endl;
+      }
+    }
+
+    // Accept the new workers
+    if (poll_fds[0].revents != 0) {
+      const int fd = accept(listener, nullptr, nullptr);
+      if (fd != -1) {
+        const int enabled = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+        workers.emplace_back(fd, workers.size() + 1);
+      }
+    }
+
+    // Lease the chunks of the workers that have not reported in time again
+    for (WorkerRecord& worker : workers) {
+      if (worker.has_lease && is_time_passed(worker.lease_deadline)) {
+        table.expire(worker.lease.chunk_index);
+        worker.has_lease = false;
+        worker.expired_lease_num++;
+        std::cout << "Note: The lease of chunk " << worker.lease.chunk_index
+                  << " by worker " << worker.id
+                  << " expired, it will be leased again" << std::endl;
+      }
+    }
+
+    // Lease the next chunks to the idle workers
+    for (WorkerRecord& worker : workers) {
+      if (!worker.connection.is_open() || !worker.has_hello ||
+          worker.is_busy || !table.lease_next(worker.lease)) {
+        continue;
+      }
+      if (!started) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        started = true;
+      }
+      worker.is_busy = true;
+      worker.has_lease = true;
+      renew_lease(worker, lease_timeout);
+      if (!worker.connection.send_message(
+              chunk_message_lease, {worker.lease.chunk_index,
+                                    worker.lease.seed, worker.lease.pull_time})) {
+        drop_worker(worker, table, "lost");
+      }
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  if (!started) {
+    start = end;
+  }
+
+  // Release the workers, which are waiting for their next lease
+  for (WorkerRecord& worker : workers) {
+    if (worker.connection.is_open()) {
+      worker.connection.send_message(chunk_message_finish, {});
+      worker.connection.close();
+      worker.status = "finished";
+    }
+  }
+  close(listener);
+
+  if (is_stop_signal_received()) {
+    std::cout << "Note: Interrupted by a signal, the results below are of the "
+              << table.merged_pull_time << " pulls of the merged chunks\n"
+              << std::endl;
+  }
+  display_simulation_results(state, seed, start, end, table.merged_pull_time,
+                             nullptr, nullptr);
+  display_worker_results(workers, table);
+
+  return 0;
+}
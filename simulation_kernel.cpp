@@ -0,0 +1,1008 @@
+#include "simulation_kernel.h"
+
+#include <algorithm>  // min
+#include <cstring>    // memcpy
+#include <limits>
+
+#include "table_kernel.h"
+
+// The ISA variants are built with the GCC target attribute and selected with
+// __builtin_cpu_supports, which are only available for x86 on GCC and Clang
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNEL_ISA_DISPATCH
+#endif
+
+bool is_valid_kernel_name(const std::string& kernel_name) {
+  return kernel_name == kernel_branchy || kernel_name == kernel_branchless ||
+         kernel_name == kernel_table || kernel_name == kernel_lanes;
+}
+
+SimulationParameter::SimulationParameter(ProbabilityWrapper& probability_wrapper,
+                                         unsigned int _pity_starting_point,
+                                         unsigned long long int _current_pull)
+    : init_star6_threshold(probability_wrapper.calc_init_star6_threshold(
+          dist_left_border, dist_right_border)),
+      init_target_star6_threshold(
+          probability_wrapper.calc_init_target_star6_threshold(
+              dist_left_border, dist_right_border)),
+      delta_star6_threshold(
+          probability_wrapper.calc_star6_threshold_change_step(
+              dist_left_border, dist_right_border)),
+      delta_target_star6_threshold(
+          probability_wrapper.calc_target_star6_threshold_change_step(
+              dist_left_border, dist_right_border)),
+      pity_starting_point(_pity_starting_point),
+      current_pull(_current_pull),
+      has_pity_curve(false),
+      start_star6_threshold(calc_star6_threshold(_current_pull)),
+      start_target_star6_threshold(
+          calc_target_star6_threshold(_current_pull)) {
+  // The thresholds stay unchanged without the change amounts, otherwise
+  // they are raised until the guaranteed star 6 operator
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  for (unsigned long long int p = 0;; ++p) {
+    if (p == max_threshold_table_length) {
+      star6_threshold_table.clear();
+      target_star6_threshold_table.clear();
+      break;
+    }
+    star6_threshold_table.push_back(calc_star6_threshold(p));
+    target_star6_threshold_table.push_back(calc_target_star6_threshold(p));
+    if (delta_star6_threshold == 0 || star6_threshold_table[p] >= dist_size) {
+      break;
+    }
+  }
+}
+
+SimulationParameter::SimulationParameter(ProbabilityWrapper& probability_wrapper,
+                                         const std::vector<double>& star6_rate,
+                                         unsigned long long int _current_pull)
+    : delta_star6_threshold(0),
+      delta_target_star6_threshold(0),
+      pity_starting_point(0),
+      current_pull(_current_pull),
+      has_pity_curve(true) {
+  // Round the probabilities to the thresholds, and share the thresholds
+  // between the target and the others as the built-in rule does. The pity
+  // counters after a guaranteed star 6 operator can never be reached
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  const double target_share =
+      probability_wrapper.get_on_banner_star6_conditional_rate() /
+      probability_wrapper.get_banner_operator_num();
+  for (size_t p = 0; p < star6_rate.size() && p < max_threshold_table_length;
+       ++p) {
+    const unsigned long long int threshold =
+        static_cast<unsigned long long int>(star6_rate[p] * dist_size + 0.5);
+    star6_threshold_table.push_back(threshold);
+    target_star6_threshold_table.push_back(
+        static_cast<unsigned long long int>(threshold * target_share + 0.5));
+    if (threshold >= dist_size) {
+      break;
+    }
+  }
+  init_star6_threshold = star6_threshold_table.front();
+  init_target_star6_threshold = target_star6_threshold_table.front();
+  start_star6_threshold = calc_star6_threshold(_current_pull);
+  start_target_star6_threshold = calc_target_star6_threshold(_current_pull);
+}
+
+unsigned long long int SimulationParameter::calc_star6_threshold(
+    unsigned long long int pity_count) const {
+  if (has_pity_curve) {
+    return star6_threshold_table[std::min<unsigned long long int>(
+        pity_count, star6_threshold_table.size() - 1)];
+  }
+  return init_star6_threshold +
+         calc_raise_num(pity_starting_point, pity_count) *
+             delta_star6_threshold;
+}
+
+unsigned long long int SimulationParameter::calc_target_star6_threshold(
+    unsigned long long int pity_count) const {
+  if (has_pity_curve) {
+    return target_star6_threshold_table[std::min<unsigned long long int>(
+        pity_count, target_star6_threshold_table.size() - 1)];
+  }
+  return init_target_star6_threshold +
+         calc_raise_num(pity_starting_point, pity_count) *
+             delta_target_star6_threshold;
+}
+
+bool SimulationParameter::is_reachable_pity(
+    unsigned long long int pity_count) const {
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  return pity_count == 0 || calc_star6_threshold(pity_count - 1) < dist_size;
+}
+
+SimulationState::SimulationState(const SimulationParameter& parameter)
+    : star6_count(0),
+      target_star6_count(0),
+      pity_count(0),
+      current_pull_count(0),
+      star6_threshold(parameter.init_star6_threshold),
+      target_star6_threshold(parameter.init_target_star6_threshold),
+      result(result_size),
+      lane_pity_count(kernel_lane_num, 0),
+      lane_current_pull_count(kernel_lane_num, 0),
+      next_lane(0) {}
+
+// Draw the random numbers of the next n pulls. The generator runs in its own
+// tight loop, apart from the state transitions of the pity system, so that
+// the compiler can schedule (and vectorize the refill of) mt19937_64 with
+// the instruction set of each variant. Draws exactly n numbers, hence a
+// kernel consumes the same random stream no matter how it is blocked
+static inline void fill_pull_block_impl(std::mt19937_64& mt,
+                                        PullDistribution& dist,
+                                        unsigned int* block, size_t n) {
+  for (size_t j = 0; j < n; ++j) {
+    block[j] = dist(mt);
+  }
+}
+
+// Draws the random numbers of every block of a kernel from the generator
+class GeneratedPullSource {
+ public:
+  std::mt19937_64& mt;
+  PullDistribution& dist;
+  unsigned int block[pull_block_size];
+
+  GeneratedPullSource(std::mt19937_64& _mt, PullDistribution& _dist)
+      : mt(_mt), dist(_dist) {}
+
+  inline const unsigned int* next_block(size_t n) {
+    fill_pull_block_impl(mt, dist, block, n);
+    return block;
+  }
+};
+
+static_assert(std::numeric_limits<unsigned long long int>::max() /
+                      recycled_digit_range ==
+                  recycled_accept_limit / recycled_digit_range,
+              "recycled_accept_limit must be the largest multiple of "
+              "recycled_digit_range below 2^64");
+
+RecycledPullGenerator::RecycledPullGenerator(uint_fast64_t seed)
+    : mt(seed), digits(0), digit_num(0), generator_call_count(0) {}
+
+// Draw the random numbers of the next n pulls from the digits of the
+// generator outputs. An accepted output x is uniform on
+// [0, recycled_accept_limit), hence x mod recycled_digit_range is uniform on
+// [0, dist_size^recycled_digit_num), and its base-dist_size digits are
+// independent and uniform on [0, dist_size). The divisions by the constant
+// compile into multiplications by its fixed-point inverse (multiply-high),
+// so a pull costs a multiplication instead of a generator call
+static inline void fill_recycled_pull_block_impl(
+    RecycledPullGenerator& generator, unsigned int* block, size_t n) {
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  unsigned long long int digits = generator.digits;
+  unsigned int digit_num = generator.digit_num;
+  unsigned long long int generator_call_count = generator.generator_call_count;
+  for (size_t j = 0; j < n; ++j) {
+    if (digit_num == 0) {
+      // Rejects 2.4 % of the outputs, the ones that would make the digits
+      // biased
+      do {
+        digits = generator.mt();
+        generator_call_count++;
+      } while (digits >= recycled_accept_limit);
+      digits %= recycled_digit_range;
+      digit_num = recycled_digit_num;
+    }
+    block[j] = dist_left_border + static_cast<unsigned int>(digits % dist_size);
+    digits /= dist_size;
+    digit_num--;
+  }
+  generator.digits = digits;
+  generator.digit_num = digit_num;
+  generator.generator_call_count = generator_call_count;
+}
+
+// Draws the random numbers of every block of a kernel from the digits of a
+// RecycledPullGenerator (--recycle-bits)
+class RecycledPullSource {
+ public:
+  RecycledPullGenerator& generator;
+  unsigned int block[pull_block_size];
+
+  explicit RecycledPullSource(RecycledPullGenerator& _generator)
+      : generator(_generator) {}
+
+  inline const unsigned int* next_block(size_t n) {
+    fill_recycled_pull_block_impl(generator, block, n);
+    return block;
+  }
+};
+
+// Hands the random numbers drawn in advance to a kernel block by block
+class DrawnPullSource {
+ public:
+  const unsigned int* pulls;
+
+  explicit DrawnPullSource(const unsigned int* _pulls) : pulls(_pulls) {}
+
+  inline const unsigned int* next_block(size_t n) {
+    const unsigned int* block = pulls;
+    pulls += n;
+    return block;
+  }
+};
+
+// The kernels take their random numbers from a GeneratedPullSource, a
+// RecycledPullSource or a DrawnPullSource, so that each one is written once
+// for all of them
+template <typename PullSource>
+static inline void simulate_branchy_impl(SimulationState& state,
+                                         const SimulationParameter& parameter,
+                                         PullSource& source,
+                                         unsigned long long int pull_time) {
+  for (unsigned long long int i = 0; i < pull_time;) {
+    const size_t block_size =
+        std::min<unsigned long long int>(pull_block_size, pull_time - i);
+    const unsigned int* block = source.next_block(block_size);
+    i += block_size;
+
+    for (size_t j = 0; j < block_size; ++j) {
+      unsigned int rand_num = block[j];
+      state.current_pull_count++;  // leave the index 0 of result vector unused
+      // Get a star-6 operator
+      if (rand_num < state.star6_threshold) {
+        state.star6_count++;
+        state.pity_count = 0;
+        // This star-6 operator is also your target operator
+        if (rand_num < state.target_star6_threshold) {
+          state.target_star6_count++;
+          if (state.current_pull_count < state.result.size()) {
+            state.result[state.current_pull_count]++;
+          } else {
+            record_rare_event(state, state.current_pull_count);
+          }
+          state.current_pull_count = 0;
+          // Finish currrent trial, reset the pity counter and start next trial
+          state.pity_count = parameter.current_pull;
+          state.star6_threshold = parameter.start_star6_threshold;
+          state.target_star6_threshold =
+              parameter.start_target_star6_threshold;
+        } else {
+          state.star6_threshold = parameter.init_star6_threshold;
+          state.target_star6_threshold =
+              parameter.init_target_star6_threshold;
+        }
+      } else {
+        state.pity_count++;
+        if (state.pity_count >= parameter.pity_starting_point) {
+          state.star6_threshold += parameter.delta_star6_threshold;
+          state.target_star6_threshold +=
+              parameter.delta_target_star6_threshold;
+        }
+      }
+    }
+  }
+}
+
+template <typename PullSource>
+static inline void simulate_branchless_impl(
+    SimulationState& state, const SimulationParameter& parameter,
+    PullSource& source, unsigned long long int pull_time) {
+  // Keep the state in local variables so that the compiler can hold them in
+  // registers instead of reloading them through the reference
+  unsigned long long int star6_count = state.star6_count;
+  unsigned long long int target_star6_count = state.target_star6_count;
+  unsigned long long int pity_count = state.pity_count;
+  unsigned long long int current_pull_count = state.current_pull_count;
+  unsigned long long int star6_threshold = state.star6_threshold;
+  unsigned long long int target_star6_threshold = state.target_star6_threshold;
+  unsigned long long int* result = state.result.data();
+  const unsigned long long int result_length = state.result.size();
+  const unsigned long long int init_star6_threshold =
+      parameter.init_star6_threshold;
+  const unsigned long long int init_target_star6_threshold =
+      parameter.init_target_star6_threshold;
+  const unsigned long long int delta_star6_threshold =
+      parameter.delta_star6_threshold;
+  const unsigned long long int delta_target_star6_threshold =
+      parameter.delta_target_star6_threshold;
+  const unsigned long long int pity_starting_point =
+      parameter.pity_starting_point;
+  const unsigned long long int current_pull = parameter.current_pull;
+  const unsigned long long int start_star6_threshold =
+      parameter.start_star6_threshold;
+  const unsigned long long int start_target_star6_threshold =
+      parameter.start_target_star6_threshold;
+
+  for (unsigned long long int i = 0; i < pull_time;) {
+    const size_t block_size =
+        std::min<unsigned long long int>(pull_block_size, pull_time - i);
+    const unsigned int* block = source.next_block(block_size);
+    i += block_size;
+
+    for (size_t j = 0; j < block_size; ++j) {
+      const unsigned long long int rand_num = block[j];
+      current_pull_count++;
+
+      // 1 if the event happens, otherwise 0. The target threshold is never
+      // greater than the star 6 threshold, so is_target implies is_star6
+      const unsigned long long int is_star6 = rand_num < star6_threshold;
+      const unsigned long long int is_target =
+          rand_num < target_star6_threshold;
+      // All bits are set if the event happens, otherwise all bits are clear
+      const unsigned long long int star6_mask = 0ULL - is_star6;
+      const unsigned long long int target_mask = 0ULL - is_target;
+
+      star6_count += is_star6;
+      target_star6_count += is_target;
+
+      // Record the trial length into result[current_pull_count] if this pull
+      // finishes a trial, otherwise add 0 to the unused result[0]
+      const unsigned long long int is_recorded =
+          is_target & (current_pull_count < result_length);
+      result[current_pull_count & (0ULL - is_recorded)] += is_recorded;
+      // Trials longer than the histogram are rare, hence this branch is
+      // well predicted
+      if (is_target & !is_recorded) {
+        record_rare_event(state, current_pull_count);
+      }
+
+      // Failed pull: increase the pity counter, and raise the thresholds once
+      // the pity system comes into effect
+      // Star 6: reset the pity counter and the thresholds
+      // Target star 6: instead start the next trial with current_pull and the
+      // thresholds after current_pull failed pulls
+      pity_count = ((pity_count + 1) & ~star6_mask) |
+                   (current_pull & target_mask);
+      const unsigned long long int is_raised =
+          (1 - is_star6) & (pity_count >= pity_starting_point);
+      const unsigned long long int off_target_mask = star6_mask & ~target_mask;
+      star6_threshold =
+          (init_star6_threshold & off_target_mask) |
+          (start_star6_threshold & target_mask) |
+          ((star6_threshold + is_raised * delta_star6_threshold) &
+           ~star6_mask);
+      target_star6_threshold =
+          (init_target_star6_threshold & off_target_mask) |
+          (start_target_star6_threshold & target_mask) |
+          ((target_star6_threshold +
+            is_raised * delta_target_star6_threshold) &
+           ~star6_mask);
+      current_pull_count &= ~target_mask;
+    }
+  }
+
+  state.star6_count = star6_count;
+  state.target_star6_count = target_star6_count;
+  state.pity_count = pity_count;
+  state.current_pull_count = current_pull_count;
+  state.star6_threshold = star6_threshold;
+  state.target_star6_threshold = target_star6_threshold;
+}
+
+// A vector of one 32-bit integer per lane of the lanes kernel (a GCC vector
+// extension, compiled into the vector instructions of each variant). A
+// scalar operand is broadcast to all the lanes, e.g., LaneVector{} + value
+typedef unsigned int LaneVector
+    __attribute__((vector_size(kernel_lane_num * sizeof(unsigned int))));
+
+static_assert(kernel_lane_num == 16, "the lanes are folded in 16 lanes");
+
+// Return true if any lane of the mask is set. The lanes are folded in halves
+// by shuffles, since extracting them one by one costs more than the pulls
+static inline bool is_any_lane_set(const LaneVector& mask) {
+  const LaneVector fold8 = {8, 9, 10, 11, 12, 13, 14, 15,
+                            0, 1, 2,  3,  4,  5,  6,  7};
+  const LaneVector fold4 = {4, 5, 6, 7, 0, 1, 2, 3,
+                            4, 5, 6, 7, 0, 1, 2, 3};
+  const LaneVector fold2 = {2, 3, 0, 1, 2, 3, 0, 1,
+                            2, 3, 0, 1, 2, 3, 0, 1};
+  const LaneVector fold1 = {1, 0, 1, 0, 1, 0, 1, 0,
+                            1, 0, 1, 0, 1, 0, 1, 0};
+  LaneVector folded = mask | __builtin_shuffle(mask, fold8);
+  folded |= __builtin_shuffle(folded, fold4);
+  folded |= __builtin_shuffle(folded, fold2);
+  folded |= __builtin_shuffle(folded, fold1);
+  return folded[0] != 0;
+}
+
+static inline unsigned long long int sum_lanes(const LaneVector& vector) {
+  unsigned int lanes[kernel_lane_num];
+  std::memcpy(lanes, &vector, sizeof(lanes));
+  unsigned long long int sum = 0;
+  for (unsigned int l = 0; l < kernel_lane_num; ++l) {
+    sum += lanes[l];
+  }
+  return sum;
+}
+
+// The lanes kernel. The pity counter of a lane is kept as the index of its
+// thresholds in the tables, i.e., capped at the last one, and the thresholds
+// of a row of lanes are raised by the built-in rule with vector arithmetic,
+// or looked up in the tables of a pity curve lane by lane. A pull that does
+// not fill a whole row, at the ends of a call, is dealt to its lane alone,
+// so the lanes take the same random numbers no matter how the pulls are
+// blocked. The pulls of a trial are counted in 32 bits per lane, which a
+// trial exceeds with a probability of about 0.98^(2^32)
+template <bool from_table, typename PullSource>
+static inline void simulate_lanes_impl(SimulationState& state,
+                                       const SimulationParameter& parameter,
+                                       PullSource& source,
+                                       unsigned long long int pull_time) {
+  const unsigned long long int* star6_threshold_table =
+      parameter.star6_threshold_table.data();
+  const unsigned long long int* target_star6_threshold_table =
+      parameter.target_star6_threshold_table.data();
+  const unsigned int last_pity =
+      static_cast<unsigned int>(parameter.star6_threshold_table.size() - 1);
+  const unsigned int start_pity_index = static_cast<unsigned int>(
+      std::min<unsigned long long int>(parameter.current_pull, last_pity));
+  const unsigned int first_raise =
+      parameter.pity_starting_point > 0 ? parameter.pity_starting_point : 1;
+
+  const LaneVector last_pity_vector = LaneVector{} + last_pity;
+  const LaneVector start_pity_vector = LaneVector{} + start_pity_index;
+  const LaneVector first_raise_vector = LaneVector{} + first_raise;
+  const LaneVector init_star6_vector =
+      LaneVector{} +
+      static_cast<unsigned int>(parameter.init_star6_threshold);
+  const LaneVector init_target_star6_vector =
+      LaneVector{} +
+      static_cast<unsigned int>(parameter.init_target_star6_threshold);
+  const LaneVector delta_star6_vector =
+      LaneVector{} + parameter.delta_star6_threshold;
+  const LaneVector delta_target_star6_vector =
+      LaneVector{} + parameter.delta_target_star6_threshold;
+
+  // The lanes are kept in arrays between the rows, and in vectors, which
+  // the compiler can hold in registers, within the rows of a block
+  unsigned int lane_pity[kernel_lane_num];
+  unsigned int lane_current_pull_count[kernel_lane_num];
+  for (unsigned int l = 0; l < kernel_lane_num; ++l) {
+    lane_pity[l] = std::min(state.lane_pity_count[l], last_pity);
+    lane_current_pull_count[l] = state.lane_current_pull_count[l];
+  }
+  unsigned int next_lane = state.next_lane;
+  unsigned long long int star6_count = state.star6_count;
+  unsigned long long int target_star6_count = state.target_star6_count;
+
+  unsigned long long int* result = state.result.data();
+  const unsigned long long int result_length = state.result.size();
+  auto finish_trial = [&state, result, result_length](
+                          unsigned int pull_count) {
+    if (pull_count < result_length) {
+      result[pull_count]++;
+    } else {
+      record_rare_event(state, pull_count);
+    }
+  };
+
+  // A pull of one lane, with the same transitions as the table kernel
+  auto pull_lane = [&](unsigned int l, unsigned int rand_num) {
+    lane_current_pull_count[l]++;
+    if (rand_num < star6_threshold_table[lane_pity[l]]) {
+      star6_count++;
+      if (rand_num < target_star6_threshold_table[lane_pity[l]]) {
+        target_star6_count++;
+        finish_trial(lane_current_pull_count[l]);
+        lane_current_pull_count[l] = 0;
+        lane_pity[l] = start_pity_index;
+      } else {
+        lane_pity[l] = 0;
+      }
+    } else {
+      lane_pity[l] += lane_pity[l] < last_pity;
+    }
+  };
+
+  for (unsigned long long int i = 0; i < pull_time;) {
+    const size_t block_size =
+        std::min<unsigned long long int>(pull_block_size, pull_time - i);
+    const unsigned int* block = source.next_block(block_size);
+    i += block_size;
+
+    size_t j = 0;
+    for (; j < block_size && next_lane != 0; ++j) {
+      pull_lane(next_lane, block[j]);
+      next_lane = (next_lane + 1) % kernel_lane_num;
+    }
+
+    LaneVector pity;
+    LaneVector current_pull_count;
+    std::memcpy(&pity, lane_pity, sizeof(pity));
+    std::memcpy(&current_pull_count, lane_current_pull_count,
+                sizeof(current_pull_count));
+    // The counters of the rows of a block fit in 32 bits per lane
+    LaneVector star6_lanes = LaneVector{};
+    LaneVector target_star6_lanes = LaneVector{};
+    for (; j + kernel_lane_num <= block_size; j += kernel_lane_num) {
+      LaneVector rand_num;
+      std::memcpy(&rand_num, block + j, sizeof(rand_num));
+
+      LaneVector star6_threshold;
+      LaneVector target_star6_threshold;
+      if (from_table) {
+        unsigned int pity_index[kernel_lane_num];
+        unsigned int star6_thresholds[kernel_lane_num];
+        unsigned int target_star6_thresholds[kernel_lane_num];
+        std::memcpy(pity_index, &pity, sizeof(pity_index));
+        for (unsigned int l = 0; l < kernel_lane_num; ++l) {
+          star6_thresholds[l] = static_cast<unsigned int>(
+              star6_threshold_table[pity_index[l]]);
+          target_star6_thresholds[l] = static_cast<unsigned int>(
+              target_star6_threshold_table[pity_index[l]]);
+        }
+        std::memcpy(&star6_threshold, star6_thresholds,
+                    sizeof(star6_threshold));
+        std::memcpy(&target_star6_threshold, target_star6_thresholds,
+                    sizeof(target_star6_threshold));
+      } else {
+        // The raises after pity failed pulls, see calc_raise_num
+        const LaneVector raise =
+            (pity - first_raise_vector + 1) &
+            reinterpret_cast<LaneVector>(pity >= first_raise_vector);
+        star6_threshold = init_star6_vector + raise * delta_star6_vector;
+        target_star6_threshold =
+            init_target_star6_vector + raise * delta_target_star6_vector;
+      }
+
+      // The masks are all ones in the lanes that got a (target) star 6
+      // operator
+      const LaneVector star6 =
+          reinterpret_cast<LaneVector>(rand_num < star6_threshold);
+      const LaneVector target_star6 =
+          reinterpret_cast<LaneVector>(rand_num < target_star6_threshold);
+      current_pull_count += 1;
+      star6_lanes -= star6;
+      target_star6_lanes -= target_star6;
+      const LaneVector next_pity =
+          pity - reinterpret_cast<LaneVector>(pity < last_pity_vector);
+      pity = (next_pity & ~star6) | (start_pity_vector & target_star6);
+
+      // One row in three to six finishes a trial, depending on the banner
+      if (is_any_lane_set(target_star6)) {
+        const LaneVector finished_vector = current_pull_count & target_star6;
+        unsigned int finished[kernel_lane_num];
+        std::memcpy(finished, &finished_vector, sizeof(finished));
+        for (unsigned int l = 0; l < kernel_lane_num; ++l) {
+          if (finished[l] != 0) {
+            finish_trial(finished[l]);
+          }
+        }
+        current_pull_count &= ~target_star6;
+      }
+    }
+    std::memcpy(lane_pity, &pity, sizeof(lane_pity));
+    std::memcpy(lane_current_pull_count, &current_pull_count,
+                sizeof(lane_current_pull_count));
+    star6_count += sum_lanes(star6_lanes);
+    target_star6_count += sum_lanes(target_star6_lanes);
+
+    for (; j < block_size; ++j) {
+      pull_lane(next_lane, block[j]);
+      next_lane = (next_lane + 1) % kernel_lane_num;
+    }
+  }
+
+  for (unsigned int l = 0; l < kernel_lane_num; ++l) {
+    state.lane_pity_count[l] = lane_pity[l];
+    state.lane_current_pull_count[l] = lane_current_pull_count[l];
+  }
+  state.next_lane = next_lane;
+  state.star6_count = star6_count;
+  state.target_star6_count = target_star6_count;
+}
+
+// Pick the thresholds of the lanes kernel by the rule of the parameter
+template <typename PullSource>
+static inline void simulate_lanes_rule(SimulationState& state,
+                                       const SimulationParameter& parameter,
+                                       PullSource& source,
+                                       unsigned long long int pull_time) {
+  if (parameter.has_pity_curve) {
+    simulate_lanes_impl<true>(state, parameter, source, pull_time);
+  } else {
+    simulate_lanes_impl<false>(state, parameter, source, pull_time);
+  }
+}
+
+typedef void (*KernelFunction)(SimulationState&, const SimulationParameter&,
+                               std::mt19937_64&, PullDistribution&,
+                               unsigned long long int);
+typedef void (*FillFunction)(std::mt19937_64&, PullDistribution&,
+                             unsigned int*, size_t);
+typedef void (*DrawnKernelFunction)(SimulationState&,
+                                    const SimulationParameter&,
+                                    const unsigned int*,
+                                    unsigned long long int);
+typedef void (*RecycledKernelFunction)(SimulationState&,
+                                       const SimulationParameter&,
+                                       RecycledPullGenerator&,
+                                       unsigned long long int);
+typedef void (*RecycledFillFunction)(RecycledPullGenerator&, unsigned int*,
+                                     size_t);
+
+// Instantiate the kernels and the refill for an instruction set. flatten
+// inlines the generator and the distribution into the variant, so that they
+// are compiled with the same target as the kernel. Only the inlined copies
+// use the target, the shared out-of-line template code keeps the baseline
+// target and is safe to call on any CPU
+#define DEFINE_KERNEL_ISA_VARIANT(suffix, attribute)                          \
+  attribute static void simulate_branchy_##suffix(                             \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      std::mt19937_64& mt, PullDistribution& dist,                            \
+      unsigned long long int pull_time) {                                     \
+    GeneratedPullSource source(mt, dist);                                     \
+    simulate_branchy_impl(state, parameter, source, pull_time);               \
+  }                                                                           \
+  attribute static void simulate_branchless_##suffix(                          \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      std::mt19937_64& mt, PullDistribution& dist,                            \
+      unsigned long long int pull_time) {                                     \
+    GeneratedPullSource source(mt, dist);                                     \
+    simulate_branchless_impl(state, parameter, source, pull_time);            \
+  }                                                                           \
+  attribute static void simulate_table_##suffix(                               \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      std::mt19937_64& mt, PullDistribution& dist,                            \
+      unsigned long long int pull_time) {                                     \
+    GeneratedPullSource source(mt, dist);                                     \
+    NoTableKernelHook hook;                                                   \
+    simulate_table_impl(state, parameter, source, hook, pull_time);           \
+  }                                                                           \
+  attribute static void simulate_lanes_##suffix(                               \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      std::mt19937_64& mt, PullDistribution& dist,                            \
+      unsigned long long int pull_time) {                                     \
+    GeneratedPullSource source(mt, dist);                                     \
+    simulate_lanes_rule(state, parameter, source, pull_time);                 \
+  }                                                                           \
+  attribute static void simulate_branchy_drawn_##suffix(                       \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      const unsigned int* pulls, unsigned long long int pull_time) {          \
+    DrawnPullSource source(pulls);                                            \
+    simulate_branchy_impl(state, parameter, source, pull_time);               \
+  }                                                                           \
+  attribute static void simulate_branchless_drawn_##suffix(                    \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      const unsigned int* pulls, unsigned long long int pull_time) {          \
+    DrawnPullSource source(pulls);                                            \
+    simulate_branchless_impl(state, parameter, source, pull_time);            \
+  }                                                                           \
+  attribute static void simulate_table_drawn_##suffix(                         \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      const unsigned int* pulls, unsigned long long int pull_time) {          \
+    DrawnPullSource source(pulls);                                            \
+    NoTableKernelHook hook;                                                   \
+    simulate_table_impl(state, parameter, source, hook, pull_time);           \
+  }                                                                           \
+  attribute static void simulate_lanes_drawn_##suffix(                         \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      const unsigned int* pulls, unsigned long long int pull_time) {          \
+    DrawnPullSource source(pulls);                                            \
+    simulate_lanes_rule(state, parameter, source, pull_time);                 \
+  }                                                                           \
+  attribute static void simulate_branchy_recycled_##suffix(                    \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      RecycledPullGenerator& generator, unsigned long long int pull_time) {   \
+    RecycledPullSource source(generator);                                     \
+    simulate_branchy_impl(state, parameter, source, pull_time);               \
+  }                                                                           \
+  attribute static void simulate_branchless_recycled_##suffix(                 \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      RecycledPullGenerator& generator, unsigned long long int pull_time) {   \
+    RecycledPullSource source(generator);                                     \
+    simulate_branchless_impl(state, parameter, source, pull_time);            \
+  }                                                                           \
+  attribute static void simulate_table_recycled_##suffix(                      \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      RecycledPullGenerator& generator, unsigned long long int pull_time) {   \
+    RecycledPullSource source(generator);                                     \
+    NoTableKernelHook hook;                                                   \
+    simulate_table_impl(state, parameter, source, hook, pull_time);           \
+  }                                                                           \
+  attribute static void simulate_lanes_recycled_##suffix(                      \
+      SimulationState& state, const SimulationParameter& parameter,           \
+      RecycledPullGenerator& generator, unsigned long long int pull_time) {   \
+    RecycledPullSource source(generator);                                     \
+    simulate_lanes_rule(state, parameter, source, pull_time);                 \
+  }                                                                           \
+  attribute static void fill_pull_block_##suffix(                              \
+      std::mt19937_64& mt, PullDistribution& dist, unsigned int* block,       \
+      size_t n) {                                                             \
+    fill_pull_block_impl(mt, dist, block, n);                                 \
+  }                                                                           \
+  attribute static void fill_recycled_pull_block_##suffix(                     \
+      RecycledPullGenerator& generator, unsigned int* block, size_t n) {      \
+    fill_recycled_pull_block_impl(generator, block, n);                       \
+  }
+
+// An instruction set variant of the kernels
+class KernelIsaVariant {
+ public:
+  std::string name;
+  bool supported;
+  KernelFunction branchy;
+  KernelFunction branchless;
+  KernelFunction table;
+  FillFunction fill;
+  DrawnKernelFunction branchy_drawn;
+  DrawnKernelFunction branchless_drawn;
+  DrawnKernelFunction table_drawn;
+  RecycledKernelFunction branchy_recycled;
+  RecycledKernelFunction branchless_recycled;
+  RecycledKernelFunction table_recycled;
+  RecycledFillFunction fill_recycled;
+  KernelFunction lanes;
+  DrawnKernelFunction lanes_drawn;
+  RecycledKernelFunction lanes_recycled;
+};
+
+#ifdef KERNEL_ISA_DISPATCH
+DEFINE_KERNEL_ISA_VARIANT(scalar, __attribute__((flatten)))
+DEFINE_KERNEL_ISA_VARIANT(sse42, __attribute__((target("sse4.2,popcnt"), flatten)))
+DEFINE_KERNEL_ISA_VARIANT(avx2, __attribute__((target("avx2,bmi,bmi2"), flatten)))
+DEFINE_KERNEL_ISA_VARIANT(
+    avx512,
+    __attribute__((target("avx512f,avx512vl,avx512bw,avx512dq,avx2,bmi,bmi2"),
+                   flatten)))
+
+// All variants, from the most basic to the most advanced
+static std::vector<KernelIsaVariant> detect_kernel_isa_variants() {
+  __builtin_cpu_init();
+  std::vector<KernelIsaVariant> variants;
+  variants.push_back({kernel_isa_scalar, true, simulate_branchy_scalar,
+                      simulate_branchless_scalar, simulate_table_scalar,
+                      fill_pull_block_scalar, simulate_branchy_drawn_scalar,
+                      simulate_branchless_drawn_scalar,
+                      simulate_table_drawn_scalar,
+                      simulate_branchy_recycled_scalar,
+                      simulate_branchless_recycled_scalar,
+                      simulate_table_recycled_scalar,
+                      fill_recycled_pull_block_scalar,
+                      simulate_lanes_scalar, simulate_lanes_drawn_scalar,
+                      simulate_lanes_recycled_scalar});
+  variants.push_back({kernel_isa_sse42,
+                      __builtin_cpu_supports("sse4.2") &&
+                          __builtin_cpu_supports("popcnt"),
+                      simulate_branchy_sse42, simulate_branchless_sse42,
+                      simulate_table_sse42,
+                      fill_pull_block_sse42, simulate_branchy_drawn_sse42,
+                      simulate_branchless_drawn_sse42, simulate_table_drawn_sse42,
+                      simulate_branchy_recycled_sse42,
+                      simulate_branchless_recycled_sse42,
+                      simulate_table_recycled_sse42,
+                      fill_recycled_pull_block_sse42,
+                      simulate_lanes_sse42, simulate_lanes_drawn_sse42,
+                      simulate_lanes_recycled_sse42});
+  variants.push_back({kernel_isa_avx2,
+                      __builtin_cpu_supports("avx2") &&
+                          __builtin_cpu_supports("bmi") &&
+                          __builtin_cpu_supports("bmi2"),
+                      simulate_branchy_avx2, simulate_branchless_avx2,
+                      simulate_table_avx2,
+                      fill_pull_block_avx2, simulate_branchy_drawn_avx2,
+                      simulate_branchless_drawn_avx2, simulate_table_drawn_avx2,
+                      simulate_branchy_recycled_avx2,
+                      simulate_branchless_recycled_avx2,
+                      simulate_table_recycled_avx2,
+                      fill_recycled_pull_block_avx2,
+                      simulate_lanes_avx2, simulate_lanes_drawn_avx2,
+                      simulate_lanes_recycled_avx2});
+  variants.push_back(
+      {kernel_isa_avx512,
+       __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx512vl") &&
+           __builtin_cpu_supports("avx512bw") &&
+           __builtin_cpu_supports("avx512dq") &&
+           __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") &&
+           __builtin_cpu_supports("bmi2"),
+       simulate_branchy_avx512, simulate_branchless_avx512,
+       simulate_table_avx512, fill_pull_block_avx512,
+       simulate_branchy_drawn_avx512, simulate_branchless_drawn_avx512,
+       simulate_table_drawn_avx512, simulate_branchy_recycled_avx512,
+       simulate_branchless_recycled_avx512, simulate_table_recycled_avx512,
+       fill_recycled_pull_block_avx512, simulate_lanes_avx512,
+       simulate_lanes_drawn_avx512, simulate_lanes_recycled_avx512});
+  return variants;
+}
+#else
+DEFINE_KERNEL_ISA_VARIANT(scalar, )
+
+static std::vector<KernelIsaVariant> detect_kernel_isa_variants() {
+  std::vector<KernelIsaVariant> variants;
+  variants.push_back({kernel_isa_scalar, true, simulate_branchy_scalar,
+                      simulate_branchless_scalar, simulate_table_scalar,
+                      fill_pull_block_scalar, simulate_branchy_drawn_scalar,
+                      simulate_branchless_drawn_scalar,
+                      simulate_table_drawn_scalar,
+                      simulate_branchy_recycled_scalar,
+                      simulate_branchless_recycled_scalar,
+                      simulate_table_recycled_scalar,
+                      fill_recycled_pull_block_scalar,
+                      simulate_lanes_scalar, simulate_lanes_drawn_scalar,
+                      simulate_lanes_recycled_scalar});
+  return variants;
+}
+#endif
+
+// Detected once, the first time a kernel runs
+static const std::vector<KernelIsaVariant>& get_kernel_isa_variants() {
+  static const std::vector<KernelIsaVariant> variants =
+      detect_kernel_isa_variants();
+  return variants;
+}
+
+// The most advanced variant that the CPU supports
+static const KernelIsaVariant& select_kernel_isa_variant() {
+  const std::vector<KernelIsaVariant>& variants = get_kernel_isa_variants();
+  for (auto iter = variants.rbegin(); iter != variants.rend(); ++iter) {
+    if (iter->supported) {
+      return *iter;
+    }
+  }
+  return variants.front();
+}
+
+// The variant that runs the kernels, which select_kernel_isa() can replace
+static const KernelIsaVariant*& get_selected_kernel_isa_variant_slot() {
+  static const KernelIsaVariant* selected = &select_kernel_isa_variant();
+  return selected;
+}
+
+static const KernelIsaVariant& get_selected_kernel_isa_variant() {
+  return *get_selected_kernel_isa_variant_slot();
+}
+
+std::vector<std::string> get_supported_kernel_isas() {
+  std::vector<std::string> isas;
+  for (const KernelIsaVariant& variant : get_kernel_isa_variants()) {
+    if (variant.supported) {
+      isas.push_back(variant.name);
+    }
+  }
+  return isas;
+}
+
+std::vector<std::string> get_built_kernel_isas() {
+  std::vector<std::string> isas;
+  for (const KernelIsaVariant& variant : get_kernel_isa_variants()) {
+    isas.push_back(variant.name);
+  }
+  return isas;
+}
+
+const std::string& get_kernel_isa() {
+  return get_selected_kernel_isa_variant().name;
+}
+
+bool select_kernel_isa(const std::string& isa) {
+  for (const KernelIsaVariant& variant : get_kernel_isa_variants()) {
+    if (variant.name == isa && variant.supported) {
+      get_selected_kernel_isa_variant_slot() = &variant;
+      return true;
+    }
+  }
+  return false;
+}
+
+void simulate_branchy(SimulationState& state,
+                      const SimulationParameter& parameter,
+                      std::mt19937_64& mt, PullDistribution& dist,
+                      unsigned long long int pull_time) {
+  get_selected_kernel_isa_variant().branchy(state, parameter, mt, dist,
+                                            pull_time);
+}
+
+void simulate_branchless(SimulationState& state,
+                         const SimulationParameter& parameter,
+                         std::mt19937_64& mt, PullDistribution& dist,
+                         unsigned long long int pull_time) {
+  get_selected_kernel_isa_variant().branchless(state, parameter, mt, dist,
+                                               pull_time);
+}
+
+void simulate_table(SimulationState& state,
+                    const SimulationParameter& parameter, std::mt19937_64& mt,
+                    PullDistribution& dist, unsigned long long int pull_time) {
+  if (parameter.star6_threshold_table.empty()) {
+    simulate_branchy(state, parameter, mt, dist, pull_time);
+    return;
+  }
+  get_selected_kernel_isa_variant().table(state, parameter, mt, dist,
+                                          pull_time);
+}
+
+void simulate_lanes(SimulationState& state,
+                    const SimulationParameter& parameter, std::mt19937_64& mt,
+                    PullDistribution& dist, unsigned long long int pull_time) {
+  if (parameter.star6_threshold_table.empty()) {
+    simulate_branchy(state, parameter, mt, dist, pull_time);
+    return;
+  }
+  get_selected_kernel_isa_variant().lanes(state, parameter, mt, dist,
+                                          pull_time);
+}
+
+void fill_pull_block(std::mt19937_64& mt, PullDistribution& dist,
+                     unsigned int* block, size_t n) {
+  get_selected_kernel_isa_variant().fill(mt, dist, block, n);
+}
+
+void simulate(const std::string& kernel_name, SimulationState& state,
+              const SimulationParameter& parameter, std::mt19937_64& mt,
+              PullDistribution& dist, unsigned long long int pull_time) {
+  if (kernel_name == kernel_branchless) {
+    simulate_branchless(state, parameter, mt, dist, pull_time);
+  } else if (kernel_name == kernel_table) {
+    simulate_table(state, parameter, mt, dist, pull_time);
+  } else if (kernel_name == kernel_lanes) {
+    simulate_lanes(state, parameter, mt, dist, pull_time);
+  } else {
+    simulate_branchy(state, parameter, mt, dist, pull_time);
+  }
+}
+
+void simulate_drawn(const std::string& kernel_name, SimulationState& state,
+                    const SimulationParameter& parameter,
+                    const unsigned int* pulls,
+                    unsigned long long int pull_time) {
+  const KernelIsaVariant& variant = get_selected_kernel_isa_variant();
+  if (kernel_name == kernel_branchless) {
+    variant.branchless_drawn(state, parameter, pulls, pull_time);
+  } else if (kernel_name == kernel_table &&
+             !parameter.star6_threshold_table.empty()) {
+    variant.table_drawn(state, parameter, pulls, pull_time);
+  } else if (kernel_name == kernel_lanes &&
+             !parameter.star6_threshold_table.empty()) {
+    variant.lanes_drawn(state, parameter, pulls, pull_time);
+  } else {
+    variant.branchy_drawn(state, parameter, pulls, pull_time);
+  }
+}
+
+void fill_recycled_pull_block(RecycledPullGenerator& generator,
+                              unsigned int* block, size_t n) {
+  get_selected_kernel_isa_variant().fill_recycled(generator, block, n);
+}
+
+void simulate_recycled(const std::string& kernel_name, SimulationState& state,
+                       const SimulationParameter& parameter,
+                       RecycledPullGenerator& generator,
+                       unsigned long long int pull_time) {
+  const KernelIsaVariant& variant = get_selected_kernel_isa_variant();
+  if (kernel_name == kernel_branchless) {
+    variant.branchless_recycled(state, parameter, generator, pull_time);
+  } else if (kernel_name == kernel_table &&
+             !parameter.star6_threshold_table.empty()) {
+    variant.table_recycled(state, parameter, generator, pull_time);
+  } else if (kernel_name == kernel_lanes &&
+             !parameter.star6_threshold_table.empty()) {
+    variant.lanes_recycled(state, parameter, generator, pull_time);
+  } else {
+    variant.branchy_recycled(state, parameter, generator, pull_time);
+  }
+}
+
+bool simulate_with_isa(const std::string& isa, const std::string& kernel_name,
+                       SimulationState& state,
+                       const SimulationParameter& parameter,
+                       std::mt19937_64& mt, PullDistribution& dist,
+                       unsigned long long int pull_time) {
+  for (const KernelIsaVariant& variant : get_kernel_isa_variants()) {
+    if (variant.name == isa && variant.supported) {
+      KernelFunction kernel = variant.branchy;
+      if (kernel_name == kernel_branchless) {
+        kernel = variant.branchless;
+      } else if (kernel_name == kernel_table &&
+                 !parameter.star6_threshold_table.empty()) {
+        kernel = variant.table;
+      } else if (kernel_name == kernel_lanes &&
+                 !parameter.star6_threshold_table.empty()) {
+        kernel = variant.lanes;
+      }
+      kernel(state, parameter, mt, dist, pull_time);
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,282 @@
+#ifndef SIMULATION_KERNEL_H
+#define SIMULATION_KERNEL_H
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "probability_wrapper.h"
+
+// The range of the uniform int distribution used to decide the result of
+// a pull, i.e., uniform distribution on [0, 999]
+const unsigned int dist_left_border = 0;
+const unsigned int dist_right_border = 999;
+
+// Number of pulls whose random numbers are drawn at a time by the kernels
+const size_t pull_block_size = 256;
+
+// Length of the result histogram. Trials that need more pulls than this are
+// recorded as rare events
+const size_t result_size = 1000;
+
+// To avoid the rare_event map recording too many items and consuming too
+// large memory.
+const size_t max_rare_event_map_size = 100000;  // you need to simulate
+                                                // approximately 10^13 times
+                                                // of pulling to reach this
+                                                // limit.
+
+// Maximum length of the threshold tables of SimulationParameter, i.e., the
+// maximum pity counter of a pity curve plus one
+const unsigned long long int max_threshold_table_length = 65536;
+
+// Names of the simulation kernels that can be selected by --kernel
+const std::string kernel_branchy = "branchy";
+const std::string kernel_branchless = "branchless";
+const std::string kernel_table = "table";
+const std::string kernel_lanes = "lanes";
+
+// Independent trials that the lanes kernel advances at a time, one per lane
+// of a vector of 32-bit integers, i.e., one AVX-512 register, two AVX2
+// registers or four SSE registers
+const unsigned int kernel_lane_num = 16;
+
+// Return true if the name is one of the simulation kernels
+bool is_valid_kernel_name(const std::string& kernel_name);
+
+// Names of the instruction set variants of the kernels. Every kernel is
+// built for each of them, and the most advanced one that the CPU supports is
+// selected at startup unless --isa selects another (only the scalar variant
+// is built for non-x86 targets)
+const std::string kernel_isa_scalar = "scalar";
+const std::string kernel_isa_sse42 = "sse4.2";
+const std::string kernel_isa_avx2 = "avx2";
+const std::string kernel_isa_avx512 = "avx512";
+
+// The number of times that the thresholds have been raised after pity_count
+// continuously failed pulls: the k-th failed pull raises them if
+// k >= pity_starting_point (k starts from 1). Also evaluated at build time
+// for the tables of --instant (see instant_table.h)
+constexpr unsigned long long int calc_raise_num(
+    unsigned int pity_starting_point, unsigned long long int pity_count) {
+  const unsigned long long int first_raise =
+      pity_starting_point > 0 ? pity_starting_point : 1;
+  return pity_count >= first_raise ? pity_count - first_raise + 1 : 0;
+}
+
+// Parameters of the pity system that stay unchanged during a simulation
+class SimulationParameter {
+ public:
+  // The thresholds will be used to decide whether we got a star6/target star6
+  // operator in a pull
+  unsigned long long int init_star6_threshold;
+  unsigned long long int init_target_star6_threshold;
+
+  // The amount that the thresholds change after each failed pull when pity
+  // system comes into effect
+  unsigned int delta_star6_threshold;
+  unsigned int delta_target_star6_threshold;
+
+  unsigned int pity_starting_point;
+
+  // The pity counter that every trial (except the first one) starts with
+  unsigned long long int current_pull;
+
+  // True if the thresholds come from a pity curve (see pity_curve.h) instead
+  // of the built-in rule. The init thresholds are then the first ones of the
+  // tables, and the change amounts and the pity starting point are 0
+  bool has_pity_curve;
+
+  // The thresholds after p continuously failed pulls for every p until the
+  // guaranteed star 6 operator, the last ones hold for every larger p. The
+  // table kernel looks them up instead of raising the thresholds. Empty if
+  // the built-in rule needs more than max_threshold_table_length of them
+  std::vector<unsigned long long int> star6_threshold_table;
+  std::vector<unsigned long long int> target_star6_threshold_table;
+
+  // The thresholds that every trial (except the first one) starts with,
+  // i.e., the thresholds after current_pull failed pulls
+  unsigned long long int start_star6_threshold;
+  unsigned long long int start_target_star6_threshold;
+
+  SimulationParameter(ProbabilityWrapper& probability_wrapper,
+                      unsigned int _pity_starting_point,
+                      unsigned long long int _current_pull);
+
+  // The thresholds of a pity curve, where star6_rate[p] is the probability of
+  // getting a star 6 operator after p continuously failed pulls. The target
+  // share of a star 6 operator is the same as the built-in rule
+  SimulationParameter(ProbabilityWrapper& probability_wrapper,
+                      const std::vector<double>& star6_rate,
+                      unsigned long long int _current_pull);
+
+  // The thresholds after pity_count continuously failed pulls
+  unsigned long long int calc_star6_threshold(
+      unsigned long long int pity_count) const;
+  unsigned long long int calc_target_star6_threshold(
+      unsigned long long int pity_count) const;
+
+  // Return true if pity_count continuously failed pulls can happen, i.e.,
+  // none of the pulls before is a guaranteed star 6 operator
+  bool is_reachable_pity(unsigned long long int pity_count) const;
+};
+
+// The counters, the state of the pity system and the results of a
+// simulation. Kernels can be called several times on the same state to
+// continue a simulation
+class SimulationState {
+ public:
+  // Count the times of getting a star 6 operator
+  unsigned long long int star6_count;
+  // Count the times of getting the target star 6 operator
+  unsigned long long int target_star6_count;
+  // Count the times of countinuously getting a non-star-6 operator
+  unsigned long long int pity_count;
+  // Count the times of pulling in a trial. Will be reset to 0 when get the
+  // target star 6 operator. Theoretically, no matter how many bits used to
+  // store the value of current_pull_count, there exists a non-zero
+  // probability that it will overflow - but the probability will converge to
+  // zero when num of bits grows to positive infinity
+  unsigned long long int current_pull_count;
+
+  unsigned long long int star6_threshold;
+  unsigned long long int target_star6_threshold;
+
+  // result[i] is the times of getting the target star 6 operator at the i-th
+  // pull of a trial. The index 0 is unused
+  std::vector<unsigned long long int> result;
+
+  // Record the event that did not get the target star 6 operator
+  // untill pulling more than result_size times
+  std::unordered_map<unsigned long long int, unsigned long long int>
+      rare_event;
+
+  // The trials in flight in the lanes kernel, i.e., the pity counter and
+  // the pulls of the trial in every lane, and the lane that takes the next
+  // random number. The counters above are the sums over the lanes, and the
+  // pity counter and the thresholds above are not used by the lanes kernel
+  std::vector<unsigned int> lane_pity_count;
+  std::vector<unsigned int> lane_current_pull_count;
+  unsigned int next_lane;
+
+  explicit SimulationState(const SimulationParameter& parameter);
+};
+
+typedef std::uniform_int_distribution<unsigned int> PullDistribution;
+
+// --recycle-bits draws recycled_digit_num pulls from one output of
+// mt19937_64 instead of one pull: an output below recycled_accept_limit,
+// the largest multiple of recycled_digit_range = 1000^6 below 2^64, holds
+// six independent and exactly uniform digits in [0, 999] (see
+// fill_recycled_pull_block), and the other outputs (2.4 %) are rejected
+const unsigned int recycled_digit_num = 6;
+const unsigned long long int recycled_digit_range = 1000000000000000000ULL;
+const unsigned long long int recycled_accept_limit = 18 * recycled_digit_range;
+
+// The generator of --recycle-bits. The digits left in the current output
+// are kept for the next block, so that the random stream does not depend on
+// how the pulls are blocked
+class RecycledPullGenerator {
+ public:
+  std::mt19937_64 mt;
+  // The digits of the current output that have not been drawn yet
+  unsigned long long int digits;
+  unsigned int digit_num;
+  // The outputs taken from mt, including the rejected ones
+  unsigned long long int generator_call_count;
+
+  explicit RecycledPullGenerator(uint_fast64_t seed);
+};
+
+// The instruction set variants built into the program, from the most basic
+// to the most advanced
+std::vector<std::string> get_built_kernel_isas();
+
+// The instruction set variants that the CPU supports, from the most basic to
+// the most advanced
+std::vector<std::string> get_supported_kernel_isas();
+
+// The instruction set variant used by the kernels, the most advanced one that
+// the CPU supports unless select_kernel_isa() picked another
+const std::string& get_kernel_isa();
+
+// Run the kernels with the given instruction set variant (--isa) from now on.
+// Return false if it is not built or the CPU does not support it. Must be
+// called before the kernels run on other threads
+bool select_kernel_isa(const std::string& isa);
+
+// Draw the random numbers of the next n pulls with the selected instruction
+// set variant, exactly as n calls of dist(mt) would
+void fill_pull_block(std::mt19937_64& mt, PullDistribution& dist,
+                     unsigned int* block, size_t n);
+
+// The original kernel, which decides the result of a pull with branches
+void simulate_branchy(SimulationState& state,
+                      const SimulationParameter& parameter,
+                      std::mt19937_64& mt, PullDistribution& dist,
+                      unsigned long long int pull_time);
+
+// Computes the same state transitions as simulate_branchy with masks and
+// conditional moves, so that the branch mispredictions do not scale with
+// the number of pulls. Produces identical results for the same random stream
+void simulate_branchless(SimulationState& state,
+                         const SimulationParameter& parameter,
+                         std::mt19937_64& mt, PullDistribution& dist,
+                         unsigned long long int pull_time);
+
+// Looks the thresholds up in the tables of the parameter by the pity
+// counter, so that a pity curve runs as fast as the built-in rule. Produces
+// identical results to simulate_branchy for the built-in rule (and falls
+// back to it if the built-in rule has no tables)
+void simulate_table(SimulationState& state,
+                    const SimulationParameter& parameter, std::mt19937_64& mt,
+                    PullDistribution& dist, unsigned long long int pull_time);
+
+// Runs kernel_lane_num independent trials side by side, one in each lane of
+// a vector, so that the state transitions of a pull advance all of them with
+// a few vector instructions instead of one chain of scalar ones. The random
+// numbers are dealt to the lanes in turn, i.e., the lane l takes the pulls
+// l, l + kernel_lane_num, ... of the stream, no matter how it is blocked.
+// Follows the same distribution as the other kernels, but the results for
+// the same random stream differ, since the trials take the random numbers in
+// another order. Falls back to the branchy kernel without threshold tables
+void simulate_lanes(SimulationState& state,
+                    const SimulationParameter& parameter, std::mt19937_64& mt,
+                    PullDistribution& dist, unsigned long long int pull_time);
+
+// Run the kernel with the given name
+void simulate(const std::string& kernel_name, SimulationState& state,
+              const SimulationParameter& parameter, std::mt19937_64& mt,
+              PullDistribution& dist, unsigned long long int pull_time);
+
+// Run the kernel with the given name on pull_time random numbers drawn in
+// advance by fill_pull_block, e.g., by another thread. Produces the same
+// state as simulate() with the generator that drew them
+void simulate_drawn(const std::string& kernel_name, SimulationState& state,
+                    const SimulationParameter& parameter,
+                    const unsigned int* pulls,
+                    unsigned long long int pull_time);
+
+// Draw the random numbers of the next n pulls from the digits of the
+// generator outputs, with the selected instruction set variant
+void fill_recycled_pull_block(RecycledPullGenerator& generator,
+                              unsigned int* block, size_t n);
+
+// Run the kernel with the given name on the random numbers of
+// --recycle-bits. The state transitions are the same as simulate(), only the
+// random stream differs
+void simulate_recycled(const std::string& kernel_name, SimulationState& state,
+                       const SimulationParameter& parameter,
+                       RecycledPullGenerator& generator,
+                       unsigned long long int pull_time);
+
+// Run the kernel with the given name and instruction set variant. Return
+// false without running it if the CPU does not support the variant
+bool simulate_with_isa(const std::string& isa, const std::string& kernel_name,
+                       SimulationState& state,
+                       const SimulationParameter& parameter,
+                       std::mt19937_64& mt, PullDistribution& dist,
+                       unsigned long long int pull_time);
+
+#endif  // SIMULATION_KERNEL_H
@@ -0,0 +1,103 @@
+#ifndef SIMULATION_OPTION_H
+#define SIMULATION_OPTION_H
+
+#include <string>
+
+#include "simulation_kernel.h"
+
+// Optional features of a run, e.g., instrumentation, reporting and analysis
+// modes, and the pity curve that replaces the built-in pity rule
+class SimulationOption {
+ public:
+  // Count the hardware events during the simulation via perf_event_open
+  bool perf_stats;
+
+  // Name of the kernel that runs the simulation loop
+  std::string kernel;
+
+  // Analyze the pull log at this path instead of running a simulation if
+  // not empty
+  std::string analyze_log_path;
+
+  // Number of bootstrap resamples used for the confidence intervals of the
+  // estimated probabilities, 0 if the intervals are not calculated
+  unsigned long long int bootstrap_resample_num;
+
+  // Measure the trial distribution of every valid current pull in one run
+  bool all_current_pull;
+
+  // Print the instruction set variants of the kernels instead of running a
+  // simulation
+  bool kernel_info;
+
+  // Classify every pull into its full outcome (star 6 operators, star 5,
+  // star 4 and star 3) with the lookup tables of the rarity model
+  bool rarity;
+
+  // Simulate until this many seconds have passed instead of a fixed number
+  // of pulls, 0 if the number of pulls is fixed
+  unsigned long long int time_budget;
+
+  // Publish the live results into the POSIX shared memory segment of this
+  // name if not empty
+  std::string shm_name;
+
+  // Solve the optimal pulling strategy over a budget of this many pulls
+  // instead of running a simulation, 0 if not solved
+  unsigned long long int strategy_budget;
+  // Copies of the target star 6 operator wanted on each banner
+  unsigned int strategy_target_num;
+
+  // Load the pity rule from the pity curve at this path instead of using the
+  // built-in one if not empty
+  std::string pity_curve_path;
+
+  // Record the sequence of the star 6 operators of every trial into the
+  // trace at this path if not empty
+  std::string trace_path;
+
+  // Draw the random numbers on a producer thread and run the kernel on them
+  // on the simulation thread
+  bool pipeline;
+
+  // Print the exact probabilities built into the program instead of running
+  // a simulation if the settings are of a default banner
+  bool instant;
+
+  // Draw several pulls from every output of the generator instead of one
+  bool recycle_bits;
+
+  // Estimate the derivatives of the probabilities by the rate parameters
+  // from the trials of the simulation
+  bool sensitivity;
+
+  // Correct the probabilities by the deviation of the statistics of the
+  // trials whose exact means are known
+  bool control_variates;
+
+  // Simulate the chunks leased by the coordinator listening at this
+  // "<host>:<port>" address instead of a simulation of our own if not empty
+  std::string worker_address;
+
+  // Run the kernels with this instruction set variant instead of the most
+  // advanced one that the CPU supports if not empty
+  std::string kernel_isa;
+
+  SimulationOption()
+      : perf_stats(false),
+        kernel(kernel_branchy),
+        bootstrap_resample_num(0),
+        all_current_pull(false),
+        kernel_info(false),
+        rarity(false),
+        time_budget(0),
+        strategy_budget(0),
+        strategy_target_num(1),
+        pipeline(false),
+        instant(false),
+        recycle_bits(false),
+        sensitivity(false),
+        control_variates(false) {}
+};
+
+#endif  // SIMULATION_OPTION_H
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <string>
+
+#include "shared_result.h"
+
+// Render the live results that a simulation started with --shm <name>
+// publishes, without disturbing the simulation
+
+void display_peek_help_message() {
+  std::cout << "Usage: ./simulation_peek <name>\n\n"
+               "Print a consistent snapshot of the results that\n"
+               "./simulation_sequential --shm <name> publishes, i.e., the counters and the\n"
+               "estimated and cumulated probabilities of getting the target star 6 operator\n"
+            << std::endl;
+}
+
+void display_snapshot(const std::string& name,
+                      const SharedResultSnapshot& snapshot) {
+  std::cout << "SNAPSHOT OF /" << name << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Simulation process: " << snapshot.pid << std::endl;
+  std::cout << "Status: " << (snapshot.finished ? "finished" : "running")
+            << std::endl;
+  std::cout << "Pulls completed: " << snapshot.completed_pull_time;
+  if (snapshot.total_pull_time == ~0ULL) {
+    std::cout << " (running by a time budget)";
+  } else {
+    std::cout << " of " << snapshot.total_pull_time << " ("
+              << 100.0 * snapshot.completed_pull_time /
+                     snapshot.total_pull_time
+              << " %)";
+  }
+  std::cout << std::endl;
+  std::cout << "Star 6 times: " << snapshot.star6_count << std::endl;
+  std::cout << "Target star 6 times: " << snapshot.target_star6_count
+            << std::endl;
+  std::cout << "Rare events happend " << snapshot.rare_event_count
+            << " times in total" << std::endl;
+  std::cout << std::endl;
+
+  if (snapshot.target_star6_count == 0) {
+    std::cout << "No target star 6 operator yet" << std::endl;
+    return;
+  }
+
+  // Skip the trial lengths after the last one that happened
+  size_t last = result_size - 1;
+  while (last > 1 && snapshot.result[last] == 0) {
+    --last;
+  }
+
+  std::cout << "PROBABILITY" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "N\tPr(S_N)\t\tPr(W_N)" << std::endl;
+  const double trial_count = static_cast<double>(snapshot.target_star6_count);
+  unsigned long long int cumulated = 0;
+  for (size_t i = 1; i <= last; ++i) {  // skip the unused index 0
+    cumulated += snapshot.result[i];
+    std::cout << i << '\t' << 100.0 * snapshot.result[i] / trial_count
+              << " %\t" << 100.0 * cumulated / trial_count << " %"
+              << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 2 || std::string(argv[1]) == "--help") {
+    display_peek_help_message();
+    return argc == 2 ? 0 : 1;
+  }
+  const std::string name(argv[1]);
+  if (!is_valid_shared_result_name(name)) {
+    std::cerr << "Invalid name \"" << name
+              << "\" - it must be a name of at most 200 letters, digits, "
+                 "'_', '-' or '.'"
+              << std::endl;
+    return 1;
+  }
+
+  SharedResultSnapshot snapshot;
+  std::string reason;
+  if (!read_shared_result(name, snapshot, reason)) {
+    std::cerr << "Cannot read the shared memory segment /" << name << " ("
+              << reason << ")" << std::endl;
+    return 1;
+  }
+  display_snapshot(name, snapshot);
+
+  return 0;
+}
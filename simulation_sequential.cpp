@@ -15,118 +15,352 @@ int main(int argc, char* argv[]) {
   unsigned long long int total_pull_time = 100000000;
   unsigned long long int current_pull = 0;
 
+  // Optional features, e.g., --perf-stats
+  SimulationOption simulation_option;
+
   bool can_continue = process_cmd_input_and_set_corres_var(
-      argc, argv, probability_wrapper, total_pull_time, pity_starting_point, current_pull);
+      argc, argv, probability_wrapper, total_pull_time, pity_starting_point,
+      current_pull, simulation_option);
   if (!can_continue) {
     // Exit the program here rather than exiting when argument format error is
     // found in order to avoid memory leak
     return 0;
   }
 
+  // Select the instruction set variant before --kernel-info reports it and
+  // before any kernel runs
+  if (!simulation_option.kernel_isa.empty() &&
+      !select_kernel_isa(simulation_option.kernel_isa)) {
+    std::cerr << "Cannot run the kernels with " << simulation_option.kernel_isa
+              << "\n"
+              << std::endl;
+    return 1;
+  }
+
+  if (simulation_option.kernel_info) {
+    display_kernel_info();
+    return 0;
+  }
+
+  // The thresholds and their change steps derived from probability_wrapper,
+  // or the thresholds of the pity curve
+  PityCurve pity_curve;
+  if (!simulation_option.pity_curve_path.empty()) {
+    std::string reason;
+    if (!load_pity_curve(simulation_option.pity_curve_path, pity_curve,
+                         reason)) {
+      std::cerr << "Cannot load the pity curve (" << reason << ")\n"
+                << std::endl;
+      return 1;
+    }
+  }
+  SimulationParameter parameter =
+      pity_curve.star6_rate.empty()
+          ? SimulationParameter(probability_wrapper, pity_starting_point,
+                                current_pull)
+          : SimulationParameter(probability_wrapper, pity_curve.star6_rate,
+                                current_pull);
+  if (!parameter.is_reachable_pity(current_pull)) {
+    std::cerr << "Invalid value for \"-c|--current-pull\" - the pity curve "
+                 "guarantees a star 6 operator before "
+              << current_pull << " failed pulls\n"
+              << std::endl;
+    return 1;
+  }
+
+  // Analyze the pull log with the banner settings instead of simulating
+  if (!simulation_option.analyze_log_path.empty()) {
+    bool analyzed =
+        analyze_pull_log(simulation_option.analyze_log_path, parameter,
+                         std::thread::hardware_concurrency());
+    return analyzed ? 0 : 1;
+  }
+
+  // The default banners are answered from the tables built into the
+  // program. From now on, --instant is only kept if they answer the settings
+  const double* instant_distribution =
+      simulation_option.instant ? find_instant_distribution(parameter)
+                                : nullptr;
+  if (simulation_option.instant && instant_distribution == nullptr) {
+    std::cerr << "Note: No exact probabilities are built into the program for "
+                 "these settings, will run the simulation\n"
+              << std::endl;
+    simulation_option.instant = false;
+  }
+
   display_simulation_settings(probability_wrapper, total_pull_time,
-                              pity_starting_point, current_pull);
+                              pity_starting_point, current_pull,
+                              simulation_option);
+
+  if (simulation_option.instant) {
+    display_instant_results(instant_distribution);
+    return 0;
+  }
+
+  // Solve the strategy, then play it with the random numbers instead of
+  // running a simulation
+  if (simulation_option.strategy_budget > 0) {
+    if (calc_strategy_state_num(parameter, simulation_option.strategy_budget,
+                                simulation_option.strategy_target_num,
+                                current_pull) > max_strategy_state_num) {
+      std::cerr << "The strategy has too many states to solve, please use a "
+                   "smaller budget, -p|--pity or -c|--current-pull\n"
+                << std::endl;
+      return 1;
+    }
+    // The pity counter is only carried between the standard banners
+    const bool carry_pity =
+        probability_wrapper.get_on_banner_star6_conditional_rate() ==
+        standard_banner_on_banner_star6_conditional_rate;
+
+    struct timespec solve_start;
+    struct timespec solve_end;
+    clock_gettime(CLOCK_MONOTONIC, &solve_start);
+    StrategyTable strategy_table = solve_strategy(
+        parameter, simulation_option.strategy_budget,
+        simulation_option.strategy_target_num, current_pull, carry_pity);
+    clock_gettime(CLOCK_MONOTONIC, &solve_end);
+
+    auto seed = get_random_seed();
+    std::mt19937_64 mt(seed);
+    PullDistribution dist(dist_left_border, dist_right_border);
+    struct timespec evaluation_start;
+    struct timespec evaluation_end;
+    clock_gettime(CLOCK_MONOTONIC, &evaluation_start);
+    StrategyEvaluation strategy_evaluation = evaluate_strategy(
+        strategy_table, parameter, current_pull, mt, dist, total_pull_time);
+    clock_gettime(CLOCK_MONOTONIC, &evaluation_end);
+
+    display_strategy_results(strategy_table, strategy_evaluation, current_pull,
+                             seed, calc_time(solve_start, solve_end),
+                             calc_time(evaluation_start, evaluation_end));
+    return 0;
+  }
+
+  // Simulate the chunks that the coordinator leases instead of a simulation
+  // of our own
+  if (!simulation_option.worker_address.empty()) {
+    bool worked = run_chunk_worker(simulation_option.worker_address, parameter,
+                                   simulation_option.kernel,
+                                   simulation_option.recycle_bits);
+    return worked ? 0 : 1;
+  }
 
   auto seed = get_random_seed();
   std::mt19937_64 mt(seed);
-  unsigned int dist_left_border = 0;
-  unsigned int dist_right_border = 999;
   // Uniform distribution on [0, 999]
-  std::uniform_int_distribution<unsigned int> dist(dist_left_border,
-                                                   dist_right_border);
-
-  // Count the times of getting a star 6 operator in total_pull_times pulling
-  unsigned long long int star6_count = 0;
-  // Count the times of getting the target star 6 operator in total_pull_times
-  // pulling
-  unsigned long long int target_star6_count = 0;
-  // Count the times of countinuously getting a non-star-6 operator
-  unsigned long long int pity_count = 0;
-  // Count the times of pulling in a trial. Will be reset to 0 when get the
-  // target star 6 operator. Theoretically, no matter how many bits used to
-  // store the value of current_pull_count, there exists a non-zero probability
-  // that it will overflow - but the probability will converge to zero when num
-  // of bits grows to positive infinity
-  unsigned long long int current_pull_count = 0;
-
-  // The thresholds will be used to decide whether we got a star6/target star6
-  // operator in a pull
-  const unsigned long long int init_target_star6_threshold =
-      probability_wrapper.calc_init_target_star6_threshold(dist_left_border,
-                                                           dist_right_border);
-  const unsigned long long int init_star6_threshold =
-      probability_wrapper.calc_init_star6_threshold(dist_left_border,
-                                                    dist_right_border);
-
-  unsigned long long int target_star6_threshold = init_target_star6_threshold;
-  unsigned long long int star6_threshold = init_star6_threshold;
-
-  // The amount that the thresholds change after each failed pull when pity
-  // system comes into effect
-  unsigned int delta_star6_threshold =
-      probability_wrapper.calc_star6_threshold_change_step(dist_left_border,
-                                                           dist_right_border);
-  unsigned int delta_target_star6_threshold =
-      probability_wrapper.calc_target_star6_threshold_change_step(
-          dist_left_border, dist_right_border);
-
-  std::vector<unsigned long long int> result(1000);
-
-  // Record the event that did not get a star 6 operator
-  // untill pulling more than 1000 times
-  std::unordered_map<unsigned long long int, unsigned long long int> rare_event;
-
-  // To avoid the rare_event map recording too many items and consuming too
-  // large memory.
-  const size_t max_rare_event_map_size = 100000;  // you need to simulate
-                                                  // approximately 10^13 times
-                                                  // of pulling to reach this
-                                                  // limit.
+  PullDistribution dist(dist_left_border, dist_right_border);
+
+  // The generator of --recycle-bits, seeded with the same seed
+  RecycledPullGenerator recycled_generator(seed);
+
+  // The counters, the state of the pity system and the results
+  SimulationState state(parameter);
+
+  // The lookup tables of --rarity are built before the timing starts
+  RarityModel rarity_model(probability_wrapper, parameter);
+  RarityStatistics rarity_statistics;
+
+  // The scores of --sensitivity are tabulated by the pity counter before
+  // the timing starts, which needs the threshold tables as well
+  SensitivityModel sensitivity_model;
+  SensitivityStatistics sensitivity_statistics;
+  if (simulation_option.sensitivity) {
+    if (parameter.star6_threshold_table.empty()) {
+      std::cerr << "Cannot estimate the sensitivity - the pity starting "
+                   "point is too large for the threshold tables\n"
+                << std::endl;
+      return 1;
+    }
+    sensitivity_model = SensitivityModel(probability_wrapper, parameter);
+  }
+
+  // The exact means of the controls of --control-variates are computed from
+  // the threshold tables as well, after the simulation
+  if (simulation_option.control_variates &&
+      parameter.star6_threshold_table.empty()) {
+    std::cerr << "Cannot use the control variates - the pity starting point "
+                 "is too large for the threshold tables\n"
+              << std::endl;
+    return 1;
+  }
+  ControlVariateStatistics control_variate_statistics;
+
+  // The thresholds of every current pull of --all-current-pull are tabulated
+  // before the timing starts as well
+  CurrentPullTable current_pull_table;
+  if (simulation_option.all_current_pull) {
+    current_pull_table = CurrentPullTable(parameter);
+  }
+
+  // The trace is recorded by walking the threshold tables, which are not
+  // built for a huge pity starting point
+  if (!simulation_option.trace_path.empty() &&
+      parameter.star6_threshold_table.empty()) {
+    std::cerr << "Cannot record the trace - the pity starting point is too "
+                 "large for the threshold tables\n"
+              << std::endl;
+    return 1;
+  }
+
+  // Create the trace and start its writer thread before the timing starts
+  TraceWriter trace_writer;
+  if (!simulation_option.trace_path.empty() &&
+      !trace_writer.open(simulation_option.trace_path, seed, parameter)) {
+    std::cerr << "Cannot create the trace ("
+              << trace_writer.get_unavailable_reason() << ")\n"
+              << std::endl;
+    return 1;
+  }
+
+  if (simulation_option.pipeline && std::thread::hardware_concurrency() < 2) {
+    std::cerr << "Note: Only one hardware thread is available, the threads of "
+                 "--pipeline will take turns on it\n"
+              << std::endl;
+  }
 
   std::cout << "Now will start the simulation...\n" << std::endl;
 
+  // Stop after the current chunk of pulls on SIGINT or SIGTERM, and still
+  // report the results gathered so far
+  install_stop_signal_handler();
+
+  // Open the hardware counters before the timing starts, so that the cost
+  // of the system calls is not counted into the simulation time
+  PerfCounter perf_counter;
+  if (simulation_option.perf_stats && !perf_counter.open()) {
+    std::cerr << "Note: Hardware counters are unavailable ("
+              << perf_counter.get_unavailable_reason()
+              << "), will only report the wall clock based statistics\n"
+              << std::endl;
+  }
+
+  // Create the shared memory segment before the timing starts as well
+  SharedResultWriter shared_result_writer;
+  if (!simulation_option.shm_name.empty() &&
+      !shared_result_writer.open(simulation_option.shm_name,
+                                 total_pull_time)) {
+    std::cerr << "Note: Shared memory segment is unavailable ("
+              << shared_result_writer.get_unavailable_reason()
+              << "), will not publish the live results\n"
+              << std::endl;
+  }
+
   struct timespec start;
   struct timespec end;
 
   clock_gettime(CLOCK_MONOTONIC, &start);
+  if (simulation_option.perf_stats) {
+    perf_counter.start();
+  }
+  // One producer thread draws the pulls of all the chunks. It starts after
+  // the hardware counters are opened, which hence count it as well
+  PullPipeline pull_pipeline;
+  if (simulation_option.pipeline) {
+    pull_pipeline.start(mt, dist, total_pull_time);
+  }
 
-  // Start simulation
-  for (unsigned long long int i = 0; i < total_pull_time; ++i) {
-    unsigned int rand_num = dist(mt);
-    current_pull_count++;  // leave the index 0 of result vector unused
-    // Get a star-6 operator
-    if (rand_num < star6_threshold) {
-      star6_count++;
-      pity_count = 0;
-      // This star-6 operator is also your target operator
-      if (rand_num < target_star6_threshold) {
-        target_star6_count++;
-        if (current_pull_count < result.size()) {
-          result[current_pull_count]++;
-        }
-        else if (rare_event.size() < max_rare_event_map_size) {
-          rare_event[current_pull_count]++;
-        }
-        current_pull_count = 0;
-        // Finish currrent trial, reset the pity counter and start next trial
-        pity_count = current_pull;
-      }
-      star6_threshold = init_star6_threshold;
-      target_star6_threshold = init_target_star6_threshold;
-    }
-    else {
-      pity_count++;
-      if (pity_count >= pity_starting_point) {
-        star6_threshold += delta_star6_threshold;
-        target_star6_threshold += delta_target_star6_threshold;
+  // Start simulation. Record the histogram of each batch if the bootstrap
+  // confidence intervals are requested. Otherwise, run the pulls in chunks
+  // and check between them whether the simulation should stop early
+  BatchHistogram batch_histogram;
+  RunControl run_control(simulation_option.time_budget);
+  unsigned long long int completed_pull_time = 0;
+  if (simulation_option.bootstrap_resample_num > 0) {
+    completed_pull_time = simulate_in_batches(
+        simulation_option.kernel, state, parameter, mt, dist, total_pull_time,
+        batch_histogram, run_control);
+  } else {
+    while (completed_pull_time < total_pull_time && !run_control.should_stop()) {
+      const unsigned long long int chunk_pull_time = std::min(
+          run_chunk_pull_time, total_pull_time - completed_pull_time);
+      if (simulation_option.all_current_pull) {
+        simulate_current_pull_table(current_pull_table, state, parameter, mt,
+                                    dist, chunk_pull_time);
+      } else if (simulation_option.rarity) {
+        simulate_rarity(state, rarity_statistics, rarity_model, parameter, mt,
+                        dist, chunk_pull_time);
+      } else if (simulation_option.sensitivity) {
+        simulate_sensitivity(state, sensitivity_statistics, sensitivity_model,
+                             parameter, mt, dist, chunk_pull_time);
+      } else if (simulation_option.control_variates) {
+        simulate_control_variates(state, control_variate_statistics,
+                                  parameter, mt, dist, chunk_pull_time);
+      } else if (trace_writer.is_open()) {
+        simulate_trace(state, trace_writer, parameter, mt, dist,
+                       chunk_pull_time);
+      } else if (simulation_option.pipeline) {
+        pull_pipeline.simulate(simulation_option.kernel, state, parameter,
+                               chunk_pull_time);
+      } else if (simulation_option.recycle_bits) {
+        simulate_recycled(simulation_option.kernel, state, parameter,
+                          recycled_generator, chunk_pull_time);
+      } else {
+        simulate(simulation_option.kernel, state, parameter, mt, dist,
+                 chunk_pull_time);
       }
+      completed_pull_time += chunk_pull_time;
+      shared_result_writer.publish(state, completed_pull_time, false);
     }
   }
 
+  pull_pipeline.stop();
+  if (simulation_option.perf_stats) {
+    perf_counter.stop();
+  }
   clock_gettime(CLOCK_MONOTONIC, &end);
+  shared_result_writer.publish(state, completed_pull_time, true);
+  if (trace_writer.is_open() && !trace_writer.close()) {
+    std::cerr << "Note: The trace is incomplete ("
+              << trace_writer.get_unavailable_reason() << ")\n"
+              << std::endl;
+  }
+
+  if (is_stop_signal_received()) {
+    std::cout << "Note: Interrupted by a signal, the results below are of the "
+              << completed_pull_time << " pulls done so far\n"
+              << std::endl;
+  }
+  // From now on, the results are of the pulls actually done
+  total_pull_time = completed_pull_time;
+
+  // Resample the batches after the timing, so that the simulation time is
+  // comparable with the runs without --bootstrap
+  BootstrapInterval bootstrap_interval;
+  if (simulation_option.bootstrap_resample_num > 0) {
+    bootstrap_interval = calc_bootstrap_interval(
+        batch_histogram, simulation_option.bootstrap_resample_num, seed,
+        std::thread::hardware_concurrency());
+  }
 
   // Print the result
-  display_simulation_results(result, rare_event, star6_count,
-                             target_star6_count, seed, start, end);
+  if (simulation_option.all_current_pull) {
+    display_current_pull_table_results(
+        state, current_pull_table, seed, start, end, total_pull_time,
+        simulation_option.perf_stats ? &perf_counter : nullptr);
+    return 0;
+  }
+  display_simulation_results(
+      state, seed, start, end, total_pull_time,
+      simulation_option.perf_stats ? &perf_counter : nullptr,
+      simulation_option.bootstrap_resample_num > 0 ? &bootstrap_interval
+                                                   : nullptr);
+  if (simulation_option.rarity) {
+    display_rarity_results(rarity_statistics, probability_wrapper,
+                           total_pull_time);
+  }
+  if (simulation_option.sensitivity) {
+    display_sensitivity_results(state, sensitivity_statistics);
+  }
+  // The exact means of the controls are only needed for the correction
+  if (simulation_option.control_variates) {
+    const ControlVariateModel control_variate_model(parameter);
+    display_control_variate_results(state, control_variate_statistics,
+                                    control_variate_model);
+  }
+  if (simulation_option.recycle_bits) {
+    display_recycled_bits_results(recycled_generator, total_pull_time);
+  }
 
   return 0;
 }
\ No newline at end of file
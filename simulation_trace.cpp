@@ -0,0 +1,162 @@
+#include <algorithm>  // max
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pull_trace.h"
+
+// Stream a trace that a simulation started with --trace <file> recorded,
+// and print its statistics or every trial
+
+// Off-target star 6 operators per trial with their own row, trials with
+// more are counted in the last row
+const size_t off_target_showing_limit = 10;
+
+void display_trace_help_message() {
+  std::cout << "Usage: ./simulation_trace <file> [--dump]\n\n"
+               "Stream the trace that ./simulation_sequential --trace <file> records, and\n"
+               "print the statistics of the trials, i.e., the star 6 operators, the pity\n"
+               "counters reached and the pulls per trial by the off-target star 6 operators\n"
+               "--dump : Instead print one trial per line, as its pulls followed by the length\n"
+               "         of every run, where the last run ends with the target star 6 operator\n"
+            << std::endl;
+}
+
+// The statistics gathered while streaming the trials
+class TraceStatistics {
+ public:
+  unsigned long long int finished_trial_num;
+  unsigned long long int unfinished_trial_num;
+  unsigned long long int star6_count;
+  unsigned long long int finished_pull_num;
+  // The highest pity counter reached by any pull
+  unsigned long long int max_pity_count;
+  // Sum of the highest pity counter reached in every finished trial
+  unsigned long long int trial_max_pity_sum;
+  // Trials and their pulls by the off-target star 6 operators of the trial
+  std::vector<unsigned long long int> off_target_trial_num;
+  std::vector<unsigned long long int> off_target_pull_num;
+
+  TraceStatistics()
+      : finished_trial_num(0),
+        unfinished_trial_num(0),
+        star6_count(0),
+        finished_pull_num(0),
+        max_pity_count(0),
+        trial_max_pity_sum(0),
+        off_target_trial_num(off_target_showing_limit + 1, 0),
+        off_target_pull_num(off_target_showing_limit + 1, 0) {}
+};
+
+void add_trial(TraceStatistics& statistics, const TraceTrial& trial,
+               unsigned long long int current_pull) {
+  // The first run starts with the pity counter current_pull, and the others
+  // with 0. The last pull of a run is the one after the highest pity counter
+  unsigned long long int trial_max_pity = 0;
+  for (size_t i = 0; i < trial.run_length.size(); ++i) {
+    const unsigned long long int start_pity = i == 0 ? current_pull : 0;
+    trial_max_pity =
+        std::max(trial_max_pity, start_pity + trial.run_length[i] - 1);
+  }
+  statistics.max_pity_count = std::max(statistics.max_pity_count, trial_max_pity);
+
+  if (!trial.finished) {
+    statistics.unfinished_trial_num++;
+    statistics.star6_count += trial.run_length.size();
+    return;
+  }
+  const unsigned long long int pull_num = trial.calc_pull_num();
+  const size_t off_target_num =
+      std::min(trial.run_length.size() - 1, off_target_showing_limit);
+  statistics.finished_trial_num++;
+  statistics.star6_count += trial.run_length.size();
+  statistics.finished_pull_num += pull_num;
+  statistics.trial_max_pity_sum += trial_max_pity;
+  statistics.off_target_trial_num[off_target_num]++;
+  statistics.off_target_pull_num[off_target_num] += pull_num;
+}
+
+void display_trace_statistics(const std::string& path,
+                              const TraceReader& reader,
+                              const TraceStatistics& statistics) {
+  std::cout << "TRACE OF " << path << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Random seed for this simulation: " << reader.seed << std::endl;
+  std::cout << "Current pull of every trial: " << reader.current_pull
+            << std::endl;
+  std::cout << "Finished trials: " << statistics.finished_trial_num
+            << std::endl;
+  std::cout << "Unfinished trials: " << statistics.unfinished_trial_num
+            << std::endl;
+  std::cout << "Star 6 times: " << statistics.star6_count << std::endl;
+  std::cout << "Target star 6 times: " << statistics.finished_trial_num
+            << std::endl;
+  std::cout << "Highest pity counter reached: " << statistics.max_pity_count
+            << std::endl;
+  if (statistics.finished_trial_num == 0) {
+    return;
+  }
+  const double trial_num = static_cast<double>(statistics.finished_trial_num);
+  std::cout << "Mean pulls per trial: " << statistics.finished_pull_num / trial_num
+            << std::endl;
+  std::cout << "Mean highest pity counter per trial: "
+            << statistics.trial_max_pity_sum / trial_num << std::endl;
+  std::cout << std::endl;
+
+  std::cout << "OFF-TARGET STAR 6 PER TRIAL" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Off-target\tTrials\t\tShare\t\tMean pulls" << std::endl;
+  for (size_t k = 0; k <= off_target_showing_limit; ++k) {
+    if (statistics.off_target_trial_num[k] == 0) {
+      continue;
+    }
+    std::cout << k << (k == off_target_showing_limit ? "+" : "") << "\t\t"
+              << statistics.off_target_trial_num[k] << "\t\t"
+              << 100.0 * statistics.off_target_trial_num[k] / trial_num
+              << " %\t"
+              << static_cast<double>(statistics.off_target_pull_num[k]) /
+                     statistics.off_target_trial_num[k]
+              << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const bool dump = argc == 3 && std::string(argv[2]) == "--dump";
+  if ((argc != 2 && !dump) || std::string(argv[1]) == "--help") {
+    display_trace_help_message();
+    return argc == 2 ? 0 : 1;
+  }
+  const std::string path(argv[1]);
+
+  TraceReader reader;
+  std::string reason;
+  if (!reader.open(path, reason)) {
+    std::cerr << "Cannot read the trace (" << reason << ")" << std::endl;
+    return 1;
+  }
+
+  TraceStatistics statistics;
+  TraceTrial trial;
+  while (reader.next_trial(trial)) {
+    if (dump) {
+      std::cout << trial.calc_pull_num() << (trial.finished ? "" : "?")
+                << ":";
+      for (unsigned long long int length : trial.run_length) {
+        std::cout << " " << length;
+      }
+      std::cout << "\n";
+    } else {
+      add_trial(statistics, trial, reader.current_pull);
+    }
+  }
+  if (reader.is_corrupted()) {
+    std::cerr << "Cannot read the trace (" << path
+              << ": the trace is truncated)" << std::endl;
+    return 1;
+  }
+  if (!dump) {
+    display_trace_statistics(path, reader, statistics);
+  }
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+#include "strategy_solver.h"
+
+#include <algorithm>  // min
+#include <cmath>      // sqrt
+
+bool StrategyTable::is_pull(unsigned long long int b, unsigned int k,
+                            unsigned long long int p) const {
+  if (b == 0 || k >= target_num) {
+    return false;
+  }
+  return pull[(b * target_num + k) * state_num + p];
+}
+
+unsigned long long int calc_strategy_state_num(
+    const SimulationParameter& parameter, unsigned long long int budget,
+    unsigned int target_num, unsigned long long int start_pity) {
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  // No pity counter after start_pity + budget can be reached
+  unsigned long long int state_num = start_pity + budget + 1;
+  // The pull after the pity counter guaranteed_pity is a star 6 operator
+  if (parameter.has_pity_curve) {
+    if (parameter.star6_threshold_table.back() >= dist_size) {
+      state_num = std::min<unsigned long long int>(
+          state_num, parameter.star6_threshold_table.size());
+    }
+  } else if (parameter.delta_star6_threshold > 0) {
+    const unsigned long long int raise_num =
+        parameter.init_star6_threshold >= dist_size
+            ? 0
+            : (dist_size - parameter.init_star6_threshold +
+               parameter.delta_star6_threshold - 1) /
+                  parameter.delta_star6_threshold;
+    const unsigned long long int first_raise =
+        parameter.pity_starting_point > 0 ? parameter.pity_starting_point : 1;
+    const unsigned long long int guaranteed_pity =
+        raise_num > 0 ? raise_num + first_raise - 1 : 0;
+    state_num = std::min(state_num, guaranteed_pity + 1);
+  }
+  return state_num * (budget + 1) * (target_num + 1);
+}
+
+// The probabilities of a star 6 operator and of the target one at every
+// pity counter
+static void calc_pull_prob(const SimulationParameter& parameter,
+                           unsigned long long int state_num,
+                           std::vector<double>& star6_prob,
+                           std::vector<double>& target_star6_prob) {
+  const unsigned long long int dist_size =
+      dist_right_border - dist_left_border + 1;
+  star6_prob.assign(state_num, 0.0);
+  target_star6_prob.assign(state_num, 0.0);
+  for (unsigned long long int p = 0; p < state_num; ++p) {
+    const unsigned long long int star6_threshold =
+        std::min(parameter.calc_star6_threshold(p), dist_size);
+    const unsigned long long int target_star6_threshold =
+        std::min(parameter.calc_target_star6_threshold(p), star6_threshold);
+    star6_prob[p] = static_cast<double>(star6_threshold) / dist_size;
+    target_star6_prob[p] = static_cast<double>(target_star6_threshold) / dist_size;
+  }
+}
+
+StrategyTable solve_strategy(const SimulationParameter& parameter,
+                             unsigned long long int budget,
+                             unsigned int target_num,
+                             unsigned long long int start_pity,
+                             bool carry_pity) {
+  StrategyTable table;
+  table.budget = budget;
+  table.target_num = target_num;
+  table.carry_pity = carry_pity;
+  table.state_num =
+      calc_strategy_state_num(parameter, budget, target_num, start_pity) /
+      ((budget + 1) * (target_num + 1));
+  const unsigned long long int state_num = table.state_num;
+  const unsigned int k_num = target_num + 1;
+  table.pull.assign((budget + 1) * target_num * state_num, false);
+
+  std::vector<double> star6_prob;
+  std::vector<double> target_star6_prob;
+  calc_pull_prob(parameter, state_num, star6_prob, target_star6_prob);
+
+  // The expected wanted copies still to get, at budget b - 1 (prev) and b
+  // (curr), indexed by k * state_num + p:
+  //   next: on the next banner, pulling until target_num copies
+  //   optimal: on the current banner with the optimal decisions
+  //   all_in: on the current banner, pulling until target_num copies there
+  // At b = 0 nothing can be got
+  std::vector<double> next_prev(k_num * state_num, 0.0);
+  std::vector<double> next_curr(k_num * state_num, 0.0);
+  std::vector<double> optimal_prev(k_num * state_num, 0.0);
+  std::vector<double> optimal_curr(k_num * state_num, 0.0);
+  std::vector<double> all_in_prev(k_num * state_num, 0.0);
+  std::vector<double> all_in_curr(k_num * state_num, 0.0);
+
+  // The value of pulling once more from state (p, k), where prev holds the
+  // values at one less budget
+  auto pull_value = [&](const std::vector<double>& prev, unsigned int k,
+                        unsigned long long int p) {
+    const double star6 = star6_prob[p];
+    const double target = target_star6_prob[p];
+    const unsigned long long int next_p = std::min(p + 1, state_num - 1);
+    return target * (1.0 + prev[(k + 1) * state_num]) +
+           (star6 - target) * prev[k * state_num] +
+           (1.0 - star6) * prev[k * state_num + next_p];
+  };
+
+  for (unsigned long long int b = 1; b <= budget; ++b) {
+    // The next banner spends every pull until target_num copies are got
+    for (unsigned int k = 0; k < target_num; ++k) {
+      for (unsigned long long int p = 0; p < state_num; ++p) {
+        next_curr[k * state_num + p] = pull_value(next_prev, k, p);
+      }
+    }
+
+    // Saving moves the rest of the budget to the next banner
+    for (unsigned long long int p = 0; p < state_num; ++p) {
+      const double save = next_curr[carry_pity ? p : 0];
+      optimal_curr[target_num * state_num + p] = save;
+      all_in_curr[target_num * state_num + p] = save;
+    }
+    for (unsigned int k = 0; k < target_num; ++k) {
+      for (unsigned long long int p = 0; p < state_num; ++p) {
+        const double save = next_curr[carry_pity ? p : 0];
+        const double pull = pull_value(optimal_prev, k, p);
+        const bool is_pull = pull >= save;
+        table.pull[(b * target_num + k) * state_num + p] = is_pull;
+        optimal_curr[k * state_num + p] = is_pull ? pull : save;
+        all_in_curr[k * state_num + p] = pull_value(all_in_prev, k, p);
+        if (b == budget) {
+          table.pull_value.push_back(pull);
+          table.save_value.push_back(save);
+        }
+      }
+    }
+
+    next_prev.swap(next_curr);
+    optimal_prev.swap(optimal_curr);
+    all_in_prev.swap(all_in_curr);
+  }
+
+  // The values at the full budget are in the prev vectors after the swap
+  table.optimal_value = optimal_prev[start_pity];
+  table.all_in_value = all_in_prev[start_pity];
+  table.save_all_value = next_prev[carry_pity ? start_pity : 0];
+  return table;
+}
+
+StrategyEvaluation evaluate_strategy(const StrategyTable& table,
+                                     const SimulationParameter& parameter,
+                                     unsigned long long int start_pity,
+                                     std::mt19937_64& mt,
+                                     PullDistribution& dist,
+                                     unsigned long long int pull_time) {
+  const unsigned long long int state_num = table.state_num;
+  std::vector<unsigned long long int> star6_threshold(state_num);
+  std::vector<unsigned long long int> target_star6_threshold(state_num);
+  for (unsigned long long int p = 0; p < state_num; ++p) {
+    star6_threshold[p] = parameter.calc_star6_threshold(p);
+    target_star6_threshold[p] = parameter.calc_target_star6_threshold(p);
+  }
+
+  // A pull with the same comparisons as the kernels. Return true if it is
+  // the target star 6 operator
+  auto do_pull = [&](unsigned long long int& p) {
+    const unsigned int rand_num = dist(mt);
+    if (rand_num < star6_threshold[p]) {
+      const bool is_target = rand_num < target_star6_threshold[p];
+      p = 0;
+      return is_target;
+    }
+    p = std::min(p + 1, state_num - 1);
+    return false;
+  };
+
+  StrategyEvaluation evaluation;
+  evaluation.episode_num = 0;
+  evaluation.pull_count = 0;
+  double sum = 0.0;
+  double square_sum = 0.0;
+  unsigned long long int current_pull_count = 0;
+  do {
+    unsigned long long int b = table.budget;
+    unsigned long long int p = start_pity;
+    unsigned int k = 0;
+    while (table.is_pull(b, k, p)) {
+      k += do_pull(p) ? 1 : 0;
+      b--;
+      current_pull_count++;
+    }
+    evaluation.pull_count += table.budget - b;
+
+    // Spend the rest on the next banner
+    unsigned long long int next_b = b;
+    if (!table.carry_pity) {
+      p = 0;
+    }
+    unsigned int next_k = 0;
+    while (next_b > 0 && next_k < table.target_num) {
+      next_k += do_pull(p) ? 1 : 0;
+      next_b--;
+    }
+    evaluation.pull_count += b - next_b;
+
+    const double copies = static_cast<double>(k + next_k);
+    sum += copies;
+    square_sum += copies * copies;
+    evaluation.episode_num++;
+  } while (evaluation.pull_count < pull_time);
+
+  const double n = static_cast<double>(evaluation.episode_num);
+  evaluation.mean = sum / n;
+  const double variance =
+      n > 1 ? std::max(0.0, (square_sum - sum * sum / n) / (n - 1)) : 0.0;
+  evaluation.standard_error = std::sqrt(variance / n);
+  evaluation.mean_current_pull = current_pull_count / n;
+  return evaluation;
+}
@@ -0,0 +1,104 @@
+#ifndef STRATEGY_SOLVER_H
+#define STRATEGY_SOLVER_H
+
+#include <random>
+#include <vector>
+
+#include "simulation_kernel.h"
+
+// The optimal pulling strategy over a budget of pulls.
+//
+// The player has a budget of pulls for the current banner and the next one
+// (with the same settings), and wants target_num copies of the target star
+// 6 operator of each. Before every pull on the current banner, the player
+// either pulls once more, or stops and saves the rest of the budget for the
+// next banner, where every pull is spent until target_num copies are got.
+// The strategy maximizes the expected number of the wanted copies got on
+// both banners.
+//
+// The state of the current banner is (remaining budget b, pity counter p,
+// copies got k), and a pull moves it with the exact probabilities of the
+// integer thresholds of the kernels to
+//   (b - 1, 0, k + 1) if it is the target star 6 operator,
+//   (b - 1, 0, k)     if it is another star 6 operator,
+//   (b - 1, p + 1, k) otherwise.
+// The values of all states are found by dynamic programming from b = 0 up
+// to the budget, each budget only depends on the one below it.
+//
+// The pity counter is carried to the next banner only on the standard
+// banners; every limited banner starts with a zero pity counter.
+
+// The maximum valid value of --strategy
+const unsigned long long int max_strategy_budget = 100000;
+// The maximum valid value of --strategy-targets, i.e., a full potential
+const unsigned int max_strategy_target_num = 6;
+// The maximum number of states of a solver, which bounds its memory and time
+const unsigned long long int max_strategy_state_num = 400000000;
+
+class StrategyTable {
+ public:
+  unsigned long long int budget;
+  unsigned int target_num;
+  bool carry_pity;
+  // The valid pity counters are [0, state_num), either every pity counter
+  // until the guaranteed star 6 operator or every reachable one
+  unsigned long long int state_num;
+
+  // pull[(b * target_num + k) * state_num + p]: true if the optimal decision
+  // at remaining budget b, copies k and pity counter p is to pull once more
+  // on the current banner. Ties are broken towards pulling
+  std::vector<bool> pull;
+
+  // The expected wanted copies at the full budget if pulling once more
+  // (pull_value) or saving (save_value), i.e., index k * state_num + p
+  std::vector<double> pull_value;
+  std::vector<double> save_value;
+  // The expected wanted copies at the full budget of the optimal strategy,
+  // of pulling until target_num copies on the current banner, and of saving
+  // the whole budget, from the state (budget, start pity, 0)
+  double optimal_value;
+  double all_in_value;
+  double save_all_value;
+
+  // Return true if the optimal decision is to pull once more
+  bool is_pull(unsigned long long int b, unsigned int k,
+               unsigned long long int p) const;
+};
+
+// The Monte Carlo evaluation of a strategy
+class StrategyEvaluation {
+ public:
+  unsigned long long int episode_num;
+  unsigned long long int pull_count;
+  // Mean and standard error of the wanted copies got in an episode
+  double mean;
+  double standard_error;
+  // Mean pulls spent on the current banner in an episode
+  double mean_current_pull;
+};
+
+// Return the number of states that solve_strategy would use, i.e., the
+// number of pity counters times the budgets times the copies
+unsigned long long int calc_strategy_state_num(
+    const SimulationParameter& parameter, unsigned long long int budget,
+    unsigned int target_num, unsigned long long int start_pity);
+
+// Solve the optimal strategy for a budget and the wanted copies, starting
+// from the given pity counter
+StrategyTable solve_strategy(const SimulationParameter& parameter,
+                             unsigned long long int budget,
+                             unsigned int target_num,
+                             unsigned long long int start_pity,
+                             bool carry_pity);
+
+// Play the strategy with the random numbers of mt and dist until about
+// pull_time pulls are spent, one episode per budget, and return the
+// statistics of the wanted copies got
+StrategyEvaluation evaluate_strategy(const StrategyTable& table,
+                                     const SimulationParameter& parameter,
+                                     unsigned long long int start_pity,
+                                     std::mt19937_64& mt,
+                                     PullDistribution& dist,
+                                     unsigned long long int pull_time);
+
+#endif  // STRATEGY_SOLVER_H
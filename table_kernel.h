@@ -0,0 +1,136 @@
+#ifndef TABLE_KERNEL_H
+#define TABLE_KERNEL_H
+
+#include <algorithm>  // min
+
+#include "simulation_kernel.h"
+
+// The table kernel as a template, shared by simulate_table and the modes
+// that follow every star 6 operator of the trials (--trace, --sensitivity
+// and --control-variates), so that its state machine is written once.
+//
+// A PullSource hands the random numbers to the kernel block by block:
+//     const unsigned int* next_block(size_t n)
+// A TableKernelHook is told about the trials as they are simulated:
+//     void begin(unsigned long long int pity_index)
+//       before the first pull, with the pity index the kernel resumes from
+//     void star6(unsigned long long int pull_count,
+//                unsigned long long int star6_count,
+//                unsigned long long int pity_index, bool is_target)
+//       at every star 6 operator, with the pull of the trial that it is,
+//       the star 6 operators of the simulation including it, and the pity
+//       index (the index of the threshold tables) of the pull
+//     void end(unsigned long long int pity_index)
+//       after the last pull, with the pity index the next call resumes from
+// The calls are inlined, hence a hook costs only what it does.
+
+// Kept out of line so that the hot loops do not need to take the address of
+// their trial length, and so that the ISA variants do not inline the hash
+// map into every kernel
+__attribute__((noinline)) inline void record_rare_event(
+    SimulationState& state, unsigned long long int pull_count) {
+  if (state.rare_event.size() < max_rare_event_map_size) {
+    state.rare_event[pull_count]++;
+  }
+}
+
+// Draws the random numbers of every block by fill_pull_block, i.e., with the
+// instruction set variant selected for the CPU, for the kernels outside
+// simulation_kernel.cpp
+class FilledPullSource {
+ public:
+  std::mt19937_64& mt;
+  PullDistribution& dist;
+  unsigned int block[pull_block_size];
+
+  FilledPullSource(std::mt19937_64& _mt, PullDistribution& _dist)
+      : mt(_mt), dist(_dist) {}
+
+  inline const unsigned int* next_block(size_t n) {
+    fill_pull_block(mt, dist, block, n);
+    return block;
+  }
+};
+
+// The hook of the plain table kernel
+class NoTableKernelHook {
+ public:
+  inline void begin(unsigned long long int) {}
+  inline void star6(unsigned long long int, unsigned long long int,
+                    unsigned long long int, bool) {}
+  inline void end(unsigned long long int) {}
+};
+
+template <typename PullSource, typename TableKernelHook>
+inline void simulate_table_impl(SimulationState& state,
+                                const SimulationParameter& parameter,
+                                PullSource& source, TableKernelHook& hook,
+                                unsigned long long int pull_time) {
+  // Keep the state in local variables as simulate_branchless does. The
+  // branches are kept, since almost every pull fails and they are well
+  // predicted, which also keeps the lookup out of the chain of the pity
+  // counter
+  unsigned long long int star6_count = state.star6_count;
+  unsigned long long int target_star6_count = state.target_star6_count;
+  unsigned long long int pity_count = state.pity_count;
+  unsigned long long int current_pull_count = state.current_pull_count;
+  unsigned long long int* result = state.result.data();
+  const unsigned long long int result_length = state.result.size();
+  const unsigned long long int* star6_threshold_table =
+      parameter.star6_threshold_table.data();
+  const unsigned long long int* target_star6_threshold_table =
+      parameter.target_star6_threshold_table.data();
+  // The last thresholds hold for every larger pity counter
+  const unsigned long long int last_pity =
+      parameter.star6_threshold_table.size() - 1;
+  const unsigned long long int current_pull = parameter.current_pull;
+  const unsigned long long int start_pity_index =
+      std::min(current_pull, last_pity);
+  unsigned long long int pity_index = std::min(pity_count, last_pity);
+  hook.begin(pity_index);
+
+  for (unsigned long long int i = 0; i < pull_time;) {
+    const size_t block_size =
+        std::min<unsigned long long int>(pull_block_size, pull_time - i);
+    const unsigned int* block = source.next_block(block_size);
+    i += block_size;
+
+    for (size_t j = 0; j < block_size; ++j) {
+      const unsigned long long int rand_num = block[j];
+      current_pull_count++;
+      // One lookup replaces the raise of the thresholds
+      if (rand_num < star6_threshold_table[pity_index]) {
+        star6_count++;
+        if (rand_num < target_star6_threshold_table[pity_index]) {
+          hook.star6(current_pull_count, star6_count, pity_index, true);
+          target_star6_count++;
+          if (current_pull_count < result_length) {
+            result[current_pull_count]++;
+          } else {
+            record_rare_event(state, current_pull_count);
+          }
+          current_pull_count = 0;
+          pity_count = current_pull;
+          pity_index = start_pity_index;
+        } else {
+          hook.star6(current_pull_count, star6_count, pity_index, false);
+          pity_count = 0;
+          pity_index = 0;
+        }
+      } else {
+        pity_count++;
+        pity_index += pity_index < last_pity;
+      }
+    }
+  }
+  hook.end(pity_index);
+
+  state.star6_count = star6_count;
+  state.target_star6_count = target_star6_count;
+  state.pity_count = pity_count;
+  state.current_pull_count = current_pull_count;
+  state.star6_threshold = star6_threshold_table[pity_index];
+  state.target_star6_threshold = target_star6_threshold_table[pity_index];
+}
+
+#endif  // TABLE_KERNEL_H
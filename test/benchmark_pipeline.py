@@ -0,0 +1,48 @@
+#!/usr/bin/python3.6
+import subprocess
+import os
+import sys
+
+# Compare the throughput of every kernel with and without --pipeline on this
+# host, e.g., to decide whether --pipeline pays off on hyperthreaded cores.
+# Usage: python3 benchmark_pipeline.py [total pull time] [repeats]
+
+path = os.path.dirname(os.path.realpath(__file__))
+simulation = os.path.join(path, "..", "simulation_sequential")
+kernels = ["branchy", "branchless", "table"]
+
+
+# Return the simulation time of a run in seconds
+def run_time(args):
+    proc = subprocess.run([simulation] + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    output = proc.stdout.decode()
+    keyword = "Time spent: "
+    index = output.find(keyword)
+    if proc.returncode != 0 or index == -1:
+        print("Cannot run {args}".format(args=args))
+        sys.exit(1)
+    return float(output[index + len(keyword):].split()[0].rstrip("s"))
+
+
+if __name__ == "__main__":
+
+    total_pull_time = sys.argv[1] if len(sys.argv) > 1 else "200000000"
+    repeat_num = int(sys.argv[2]) if len(sys.argv) > 2 else 5
+    print("{pulls} pulls per run, median of {repeats} runs, {cpus} hardware thread(s)\n".format(
+        pulls=total_pull_time, repeats=repeat_num, cpus=os.cpu_count()))
+    print("Kernel\t\tPlain (Mpulls/s)\tPipelined (Mpulls/s)\tSpeedup")
+
+    for kernel in kernels:
+        # Interleave the runs so that both modes see the same noise of the
+        # host, then take the medians
+        plain_time = []
+        pipelined_time = []
+        for i in range(repeat_num):
+            args = ["-t", total_pull_time, "--kernel", kernel]
+            plain_time.append(run_time(args))
+            pipelined_time.append(run_time(args + ["--pipeline"]))
+        plain = sorted(plain_time)[repeat_num // 2]
+        pipelined = sorted(pipelined_time)[repeat_num // 2]
+        print("{kernel}\t{plain:.1f}\t\t\t{pipelined:.1f}\t\t\t{speedup:.2f}x".format(
+            kernel=kernel.ljust(10), plain=int(total_pull_time) / plain / 1e6,
+            pipelined=int(total_pull_time) / pipelined / 1e6, speedup=plain / pipelined))
@@ -0,0 +1,62 @@
+#!/usr/bin/python3.6
+import subprocess
+import os
+import sys
+
+# Compare the throughput of every kernel with and without --recycle-bits on
+# this host, and the generator calls that --recycle-bits saves per pull.
+# Usage: python3 benchmark_recycle_bits.py [total pull time] [repeats]
+
+path = os.path.dirname(os.path.realpath(__file__))
+simulation = os.path.join(path, "..", "simulation_sequential")
+kernels = ["branchy", "branchless", "table"]
+
+
+# Return the value after the keyword in the output of a run
+def find_value(output, keyword, args):
+    index = output.find(keyword)
+    if index == -1:
+        print("Cannot find \"{keyword}\" in the output of {args}".format(keyword=keyword, args=args))
+        sys.exit(1)
+    return float(output[index + len(keyword):].split()[0].rstrip("s"))
+
+
+# Return the simulation time of a run in seconds, and its generator calls
+# per pull
+def run(args):
+    proc = subprocess.run([simulation] + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    output = proc.stdout.decode()
+    if proc.returncode != 0:
+        print("Cannot run {args}".format(args=args))
+        sys.exit(1)
+    call_per_pull = 1.0
+    if "--recycle-bits" in args:
+        call_per_pull = find_value(output, "Generator calls per pull: ", args)
+    return find_value(output, "Time spent: ", args), call_per_pull
+
+
+if __name__ == "__main__":
+
+    total_pull_time = sys.argv[1] if len(sys.argv) > 1 else "200000000"
+    repeat_num = int(sys.argv[2]) if len(sys.argv) > 2 else 5
+    print("{pulls} pulls per run, median of {repeats} runs\n".format(
+        pulls=total_pull_time, repeats=repeat_num))
+    print("Kernel\t\tPlain (Mpulls/s)\tRecycled (Mpulls/s)\tSpeedup\t\tCalls per pull")
+
+    for kernel in kernels:
+        # Interleave the runs so that both modes see the same noise of the
+        # host, then take the medians
+        plain_time = []
+        recycled_time = []
+        call_per_pull = 1.0
+        for i in range(repeat_num):
+            args = ["-t", total_pull_time, "--kernel", kernel]
+            plain_time.append(run(args)[0])
+            time, call_per_pull = run(args + ["--recycle-bits"])
+            recycled_time.append(time)
+        plain = sorted(plain_time)[repeat_num // 2]
+        recycled = sorted(recycled_time)[repeat_num // 2]
+        print("{kernel}\t{plain:.1f}\t\t\t{recycled:.1f}\t\t\t{speedup:.2f}x\t\t1 -> {calls:.4f}".format(
+            kernel=kernel.ljust(10), plain=int(total_pull_time) / plain / 1e6,
+            recycled=int(total_pull_time) / recycled / 1e6, speedup=plain / recycled,
+            calls=call_per_pull))
@@ -7,6 +7,7 @@ int main(int argc, char* argv[]) {
   unsigned long long int dbg_total_pull_time = 0;
   unsigned int dbg_pity_starting_point = 50;
   unsigned long long int dbg_current_pull = 0;
+  SimulationOption dbg_simulation_option;
   std::cout << "argc = " << argc << std::endl;
   std::cout << "Initially:\n"
                "\ttotal pull time          = 0\n"
@@ -19,7 +20,8 @@ int main(int argc, char* argv[]) {
   std::cout << "\n----- Starting Processing the Arguments -----\n";
 
   bool dbg_can_continue = process_cmd_input_and_set_corres_var(argc, argv, dbg_pw, dbg_total_pull_time,
-                                       dbg_pity_starting_point, dbg_current_pull);
+                                       dbg_pity_starting_point, dbg_current_pull,
+                                       dbg_simulation_option);
   std::cout << "\n----- After Processing -----\n";
   std::cout << "\ttotal pull time          = " << dbg_total_pull_time << std::endl;
   std::cout << "\tpity starting point      = " << dbg_pity_starting_point << std::endl;
@@ -28,6 +30,46 @@ int main(int argc, char* argv[]) {
             << dbg_pw.get_on_banner_star6_conditional_rate() << std::endl;
   std::cout << "\ton banner operator num   = " << dbg_pw.get_banner_operator_num()
             << std::endl;
+  std::cout << "\tperf stats               = " << dbg_simulation_option.perf_stats
+            << std::endl;
+  std::cout << "\tkernel                   = " << dbg_simulation_option.kernel
+            << std::endl;
+  std::cout << "\tanalyze log path         = "
+            << dbg_simulation_option.analyze_log_path << std::endl;
+  std::cout << "\tbootstrap resample num   = "
+            << dbg_simulation_option.bootstrap_resample_num << std::endl;
+  std::cout << "\tall current pull         = "
+            << dbg_simulation_option.all_current_pull << std::endl;
+  std::cout << "\tkernel info              = "
+            << dbg_simulation_option.kernel_info << std::endl;
+  std::cout << "\trarity                   = "
+            << dbg_simulation_option.rarity << std::endl;
+  std::cout << "\ttime budget              = "
+            << dbg_simulation_option.time_budget << std::endl;
+  std::cout << "\tshm name                 = "
+            << dbg_simulation_option.shm_name << std::endl;
+  std::cout << "\tstrategy budget          = "
+            << dbg_simulation_option.strategy_budget << std::endl;
+  std::cout << "\tstrategy target num      = "
+            << dbg_simulation_option.strategy_target_num << std::endl;
+  std::cout << "\tpity curve path          = "
+            << dbg_simulation_option.pity_curve_path << std::endl;
+  std::cout << "\ttrace path               = "
+            << dbg_simulation_option.trace_path << std::endl;
+  std::cout << "\tpipeline                 = "
+            << dbg_simulation_option.pipeline << std::endl;
+  std::cout << "\tinstant                  = "
+            << dbg_simulation_option.instant << std::endl;
+  std::cout << "\trecycle bits             = "
+            << dbg_simulation_option.recycle_bits << std::endl;
+  std::cout << "\tsensitivity              = "
+            << dbg_simulation_option.sensitivity << std::endl;
+  std::cout << "\tcontrol variates         = "
+            << dbg_simulation_option.control_variates << std::endl;
+  std::cout << "\tworker address           = "
+            << dbg_simulation_option.worker_address << std::endl;
+  std::cout << "\tkernel isa               = "
+            << dbg_simulation_option.kernel_isa << std::endl;
   std::cout << "\nCan continue = " << dbg_can_continue << std::endl;
   std::cout << "*************** End Testing ***************\n"
             << std::endl;
@@ -0,0 +1,49 @@
+#!/usr/bin/python3.6
+# Generate a synthetic pull log for simulation_sequential --analyze
+# Usage: ./gen_pull_log.py <output file> <number of players> [<max trials per player>]
+# Each line is "<player id> <pulls of trial 1> ... <pulls of trial k>", where the
+# trial lengths follow a double-rate-up limited banner with pity starting point 50
+import random
+import sys
+
+star6_threshold = 20
+target_star6_threshold = 7
+delta_star6_threshold = 20
+delta_target_star6_threshold = 7
+pity_starting_point = 50
+
+
+def simulate_trial():
+    pulls = 0
+    pity = 0
+    star6 = star6_threshold
+    target = target_star6_threshold
+    while True:
+        pulls += 1
+        rand_num = random.randrange(1000)
+        if rand_num < star6:
+            if rand_num < target:
+                return pulls
+            pity = 0
+            star6 = star6_threshold
+            target = target_star6_threshold
+        else:
+            pity += 1
+            if pity >= pity_starting_point:
+                star6 += delta_star6_threshold
+                target += delta_target_star6_threshold
+
+
+if __name__ == "__main__":
+    path = sys.argv[1]
+    player_num = int(sys.argv[2])
+    max_trial_num = int(sys.argv[3]) if len(sys.argv) > 3 else 6
+
+    # Draw the trials from a pool, which is much faster than simulating
+    # every trial for millions of players
+    pool = [simulate_trial() for _ in range(100000)]
+    with open(path, "w") as f:
+        for i in range(player_num):
+            trials = random.choices(pool, k=random.randint(1, max_trial_num))
+            f.write("player_{id} {trials}\n".format(
+                id=i, trials=" ".join(map(str, trials))))
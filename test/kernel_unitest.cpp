@@ -0,0 +1,507 @@
+#include "../utils.h"
+
+// Return true if two simulations end in exactly the same state
+bool is_identical_state(const SimulationState& lhs, const SimulationState& rhs) {
+  return lhs.star6_count == rhs.star6_count &&
+         lhs.target_star6_count == rhs.target_star6_count &&
+         lhs.pity_count == rhs.pity_count &&
+         lhs.current_pull_count == rhs.current_pull_count &&
+         lhs.star6_threshold == rhs.star6_threshold &&
+         lhs.target_star6_threshold == rhs.target_star6_threshold &&
+         lhs.result == rhs.result && lhs.rare_event == rhs.rare_event;
+}
+
+// Run the kernel one pull at a time until it finishes its first trial, and
+// return true if the next trial starts with the pity counter current_pull
+// and the thresholds after current_pull failed pulls
+bool is_restarted_at_current_pull(const std::string& kernel_name,
+                                  const SimulationParameter& parameter,
+                                  uint_fast64_t seed) {
+  SimulationState state(parameter);
+  std::mt19937_64 mt(seed);
+  PullDistribution dist(dist_left_border, dist_right_border);
+  while (state.target_star6_count == 0) {
+    simulate(kernel_name, state, parameter, mt, dist, 1);
+  }
+  return state.pity_count == parameter.current_pull &&
+         state.star6_threshold ==
+             parameter.calc_star6_threshold(parameter.current_pull) &&
+         state.target_star6_threshold ==
+             parameter.calc_target_star6_threshold(parameter.current_pull);
+}
+
+// Return true if two runs of the lanes kernel end in exactly the same state
+bool is_identical_lanes_state(const SimulationState& lhs,
+                              const SimulationState& rhs) {
+  return is_identical_state(lhs, rhs) &&
+         lhs.lane_pity_count == rhs.lane_pity_count &&
+         lhs.lane_current_pull_count == rhs.lane_current_pull_count &&
+         lhs.next_lane == rhs.next_lane;
+}
+
+// Return true if the state of the lanes kernel is the sum of the states of
+// the trials that ran in its lanes one by one
+bool is_dealt_state(const SimulationState& lanes_state,
+                    const std::vector<SimulationState>& lane_states,
+                    const SimulationParameter& parameter) {
+  const unsigned long long int last_pity =
+      parameter.star6_threshold_table.size() - 1;
+  unsigned long long int star6_count = 0;
+  unsigned long long int target_star6_count = 0;
+  std::vector<unsigned long long int> result(result_size, 0);
+  std::unordered_map<unsigned long long int, unsigned long long int> rare_event;
+  for (unsigned int l = 0; l < kernel_lane_num; ++l) {
+    const SimulationState& lane_state = lane_states[l];
+    star6_count += lane_state.star6_count;
+    target_star6_count += lane_state.target_star6_count;
+    for (size_t k = 0; k < result_size; ++k) {
+      result[k] += lane_state.result[k];
+    }
+    for (const auto& event : lane_state.rare_event) {
+      rare_event[event.first] += event.second;
+    }
+    if (lanes_state.lane_pity_count[l] !=
+            std::min(lane_state.pity_count, last_pity) ||
+        lanes_state.lane_current_pull_count[l] !=
+            lane_state.current_pull_count) {
+      return false;
+    }
+  }
+  return lanes_state.star6_count == star6_count &&
+         lanes_state.target_star6_count == target_star6_count &&
+         lanes_state.result == result && lanes_state.rare_event == rare_event;
+}
+
+int main() {
+  std::cout << "\n*************** Start Testing ***************\n";
+
+  // test cases: {conditional rate, rate-up num, pity starting point,
+  //              current pull}
+  const double conditional_rate[] = {0.7, 0.7, 0.5, 0.5, 0.7, 0.5, 0.7};
+  const unsigned int banner_operator_num[] = {2, 1, 2, 1, 2, 1, 2};
+  const unsigned int pity_starting_point[] = {50, 50, 50, 50, 0, 20, 50};
+  const unsigned long long int current_pull[] = {0, 0, 0, 0, 0, 42, 98};
+  const size_t case_num = sizeof(conditional_rate) / sizeof(double);
+
+  // Run the simulation in several chunks to also check that the state is
+  // correctly carried between the calls of a kernel
+  const unsigned long long int chunk_pull_time = 1000000;
+  const int chunk_num = 4;
+  const uint_fast64_t seed = 20210101;
+
+  int failed_case_num = 0;
+  for (size_t i = 0; i < case_num; ++i) {
+    ProbabilityWrapper probability_wrapper(0.02, conditional_rate[i], 0.02,
+                                           banner_operator_num[i]);
+    SimulationParameter parameter(probability_wrapper, pity_starting_point[i],
+                                  current_pull[i]);
+
+    SimulationState branchy_state(parameter);
+    std::mt19937_64 branchy_mt(seed);
+    PullDistribution branchy_dist(dist_left_border, dist_right_border);
+    SimulationState branchless_state(parameter);
+    std::mt19937_64 branchless_mt(seed);
+    PullDistribution branchless_dist(dist_left_border, dist_right_border);
+
+    for (int chunk = 0; chunk < chunk_num; ++chunk) {
+      simulate(kernel_branchy, branchy_state, parameter, branchy_mt,
+               branchy_dist, chunk_pull_time);
+      simulate(kernel_branchless, branchless_state, parameter, branchless_mt,
+               branchless_dist, chunk_pull_time);
+    }
+
+    bool identical = is_identical_state(branchy_state, branchless_state);
+    std::cout << "Case " << i << ": branchy vs branchless, identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // Every instruction set variant that the CPU supports must also produce
+    // the same state
+    const std::string kernel_names[] = {kernel_branchy, kernel_branchless,
+                                         kernel_table};
+    for (const std::string& isa : get_supported_kernel_isas()) {
+      for (const std::string& kernel_name : kernel_names) {
+        SimulationState isa_state(parameter);
+        std::mt19937_64 isa_mt(seed);
+        PullDistribution isa_dist(dist_left_border, dist_right_border);
+        for (int chunk = 0; chunk < chunk_num; ++chunk) {
+          simulate_with_isa(isa, kernel_name, isa_state, parameter, isa_mt,
+                            isa_dist, chunk_pull_time);
+        }
+        identical = is_identical_state(branchy_state, isa_state);
+        std::cout << "Case " << i << ": branchy vs " << kernel_name << " ("
+                  << isa << "), identical = " << identical << ", "
+                  << (identical ? "Pass" : "Case failed!") << std::endl;
+        if (!identical) {
+          failed_case_num++;
+        }
+      }
+    }
+
+    // A pity curve of the same probabilities as the built-in rule must
+    // compile into the same thresholds and produce the same state
+    const unsigned long long int dist_size =
+        dist_right_border - dist_left_border + 1;
+    std::vector<double> star6_rate;
+    for (unsigned long long int p = 0;
+         star6_rate.empty() || star6_rate.back() < 1.0; ++p) {
+      star6_rate.push_back(
+          std::min(parameter.calc_star6_threshold(p), dist_size) /
+          static_cast<double>(dist_size));
+    }
+    SimulationParameter curve_parameter(probability_wrapper, star6_rate,
+                                        current_pull[i]);
+    SimulationState curve_state(curve_parameter);
+    std::mt19937_64 curve_mt(seed);
+    PullDistribution curve_dist(dist_left_border, dist_right_border);
+    for (int chunk = 0; chunk < chunk_num; ++chunk) {
+      simulate(kernel_table, curve_state, curve_parameter, curve_mt,
+               curve_dist, chunk_pull_time);
+    }
+    identical = is_identical_state(branchy_state, curve_state);
+    std::cout << "Case " << i << ": branchy vs pity curve, identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // The pipelined mode must produce the same state and leave the generator
+    // in the same state for every kernel, with one producer for all the
+    // chunks
+    for (const std::string& kernel_name : kernel_names) {
+      SimulationState pipelined_state(parameter);
+      std::mt19937_64 pipelined_mt(seed);
+      PullDistribution pipelined_dist(dist_left_border, dist_right_border);
+      PullPipeline pull_pipeline;
+      pull_pipeline.start(pipelined_mt, pipelined_dist,
+                          chunk_pull_time * chunk_num);
+      for (int chunk = 0; chunk < chunk_num; ++chunk) {
+        pull_pipeline.simulate(kernel_name, pipelined_state, parameter,
+                               chunk_pull_time);
+      }
+      pull_pipeline.stop();
+      identical = is_identical_state(branchy_state, pipelined_state) &&
+                  pipelined_mt == branchy_mt;
+      std::cout << "Case " << i << ": branchy vs " << kernel_name
+                << " (pipelined), identical = " << identical << ", "
+                << (identical ? "Pass" : "Case failed!") << std::endl;
+      if (!identical) {
+        failed_case_num++;
+      }
+    }
+
+    // A pipeline stopped before all its pulls are simulated, as by
+    // --time-budget, must stop its producer and keep the state of the pulls
+    // simulated
+    SimulationState first_chunk_state(parameter);
+    std::mt19937_64 first_chunk_mt(seed);
+    PullDistribution first_chunk_dist(dist_left_border, dist_right_border);
+    simulate(kernel_table, first_chunk_state, parameter, first_chunk_mt,
+             first_chunk_dist, chunk_pull_time);
+    SimulationState stopped_state(parameter);
+    std::mt19937_64 stopped_mt(seed);
+    PullDistribution stopped_dist(dist_left_border, dist_right_border);
+    PullPipeline stopped_pull_pipeline;
+    stopped_pull_pipeline.start(stopped_mt, stopped_dist,
+                                chunk_pull_time * chunk_num);
+    stopped_pull_pipeline.simulate(kernel_table, stopped_state, parameter,
+                                   chunk_pull_time);
+    stopped_pull_pipeline.stop();
+    identical = is_identical_state(first_chunk_state, stopped_state);
+    std::cout << "Case " << i << ": table vs table (pipeline stopped early), "
+              << "identical = " << identical << ", "
+              << (identical ? "Pass" : "Case failed!") << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // The lanes kernel must deal the pulls to its lanes in turn, i.e., end in
+    // the sum of the states of the branchy kernel on every kernel_lane_num-th
+    // pull. The chunks are not whole rows of lanes, so that the pulls left at
+    // the ends of the calls are also checked
+    const unsigned long long int lanes_chunk_pull_time = chunk_pull_time - 1;
+    const unsigned long long int lanes_pull_time =
+        lanes_chunk_pull_time * chunk_num;
+    std::vector<unsigned int> lanes_pulls(lanes_pull_time);
+    std::mt19937_64 lanes_drawn_mt(seed);
+    PullDistribution lanes_drawn_dist(dist_left_border, dist_right_border);
+    fill_pull_block(lanes_drawn_mt, lanes_drawn_dist, lanes_pulls.data(),
+                    lanes_pull_time);
+    std::vector<SimulationState> lane_states(kernel_lane_num,
+                                             SimulationState(parameter));
+    for (unsigned int l = 0; l < kernel_lane_num; ++l) {
+      std::vector<unsigned int> lane_pulls;
+      for (size_t j = l; j < lanes_pull_time; j += kernel_lane_num) {
+        lane_pulls.push_back(lanes_pulls[j]);
+      }
+      simulate_drawn(kernel_branchy, lane_states[l], parameter,
+                     lane_pulls.data(), lane_pulls.size());
+    }
+    SimulationState lanes_state(parameter);
+    for (const std::string& isa : get_supported_kernel_isas()) {
+      SimulationState isa_state(parameter);
+      std::mt19937_64 isa_mt(seed);
+      PullDistribution isa_dist(dist_left_border, dist_right_border);
+      for (int chunk = 0; chunk < chunk_num; ++chunk) {
+        simulate_with_isa(isa, kernel_lanes, isa_state, parameter, isa_mt,
+                          isa_dist, lanes_chunk_pull_time);
+      }
+      identical = is_dealt_state(isa_state, lane_states, parameter);
+      std::cout << "Case " << i << ": dealt branchy vs lanes (" << isa
+                << "), identical = " << identical << ", "
+                << (identical ? "Pass" : "Case failed!") << std::endl;
+      if (!identical) {
+        failed_case_num++;
+      }
+      lanes_state = isa_state;
+    }
+
+    // The lanes kernel must look up the thresholds of the pity curve and
+    // raise the ones of the built-in rule to the same values, and produce
+    // the same state pipelined
+    SimulationState lanes_curve_state(curve_parameter);
+    std::mt19937_64 lanes_curve_mt(seed);
+    PullDistribution lanes_curve_dist(dist_left_border, dist_right_border);
+    SimulationState lanes_pipelined_state(parameter);
+    std::mt19937_64 lanes_pipelined_mt(seed);
+    PullDistribution lanes_pipelined_dist(dist_left_border, dist_right_border);
+    PullPipeline lanes_pull_pipeline;
+    lanes_pull_pipeline.start(lanes_pipelined_mt, lanes_pipelined_dist,
+                              lanes_pull_time);
+    for (int chunk = 0; chunk < chunk_num; ++chunk) {
+      simulate(kernel_lanes, lanes_curve_state, curve_parameter,
+               lanes_curve_mt, lanes_curve_dist, lanes_chunk_pull_time);
+      lanes_pull_pipeline.simulate(kernel_lanes, lanes_pipelined_state,
+                                   parameter, lanes_chunk_pull_time);
+    }
+    lanes_pull_pipeline.stop();
+    identical = is_identical_lanes_state(lanes_state, lanes_curve_state);
+    std::cout << "Case " << i << ": lanes vs lanes (pity curve), identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+    identical = is_identical_lanes_state(lanes_state, lanes_pipelined_state);
+    std::cout << "Case " << i << ": lanes vs lanes (pipelined), identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // --recycle-bits must produce the same state with every kernel, and the
+    // same state as its numbers drawn in blocks of another size, since the
+    // generator keeps the digits left between the blocks
+    SimulationState recycled_state(parameter);
+    RecycledPullGenerator recycled_generator(seed);
+    for (int chunk = 0; chunk < chunk_num; ++chunk) {
+      simulate_recycled(kernel_branchy, recycled_state, parameter,
+                        recycled_generator, chunk_pull_time);
+    }
+    for (const std::string& kernel_name : kernel_names) {
+      SimulationState kernel_recycled_state(parameter);
+      RecycledPullGenerator kernel_recycled_generator(seed);
+      for (int chunk = 0; chunk < chunk_num; ++chunk) {
+        simulate_recycled(kernel_name, kernel_recycled_state, parameter,
+                          kernel_recycled_generator, chunk_pull_time);
+      }
+      identical = is_identical_state(recycled_state, kernel_recycled_state) &&
+                  kernel_recycled_generator.generator_call_count ==
+                      recycled_generator.generator_call_count;
+      std::cout << "Case " << i << ": recycled branchy vs " << kernel_name
+                << " (recycled), identical = " << identical << ", "
+                << (identical ? "Pass" : "Case failed!") << std::endl;
+      if (!identical) {
+        failed_case_num++;
+      }
+    }
+    const unsigned long long int recycled_pull_time =
+        chunk_pull_time * chunk_num;
+    const size_t recycled_block_size = 1001;
+    std::vector<unsigned int> recycled_pulls(recycled_pull_time);
+    RecycledPullGenerator drawn_generator(seed);
+    for (size_t j = 0; j < recycled_pull_time; j += recycled_block_size) {
+      fill_recycled_pull_block(
+          drawn_generator, recycled_pulls.data() + j,
+          std::min<size_t>(recycled_block_size, recycled_pull_time - j));
+    }
+    SimulationState drawn_state(parameter);
+    simulate_drawn(kernel_branchy, drawn_state, parameter,
+                   recycled_pulls.data(), recycled_pull_time);
+    identical = is_identical_state(recycled_state, drawn_state) &&
+                drawn_generator.generator_call_count ==
+                    recycled_generator.generator_call_count;
+    std::cout << "Case " << i
+              << ": recycled branchy vs drawn in other blocks, identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // Recording the trace must not change the state, and the trace must read
+    // back every star 6 operator of the simulation
+    const std::string trace_path = "kernel_unitest.trace";
+    SimulationState trace_state(parameter);
+    std::mt19937_64 trace_mt(seed);
+    PullDistribution trace_dist(dist_left_border, dist_right_border);
+    TraceWriter trace_writer;
+    bool traced = trace_writer.open(trace_path, seed, parameter);
+    for (int chunk = 0; traced && chunk < chunk_num; ++chunk) {
+      simulate_trace(trace_state, trace_writer, parameter, trace_mt, trace_dist,
+                     chunk_pull_time);
+    }
+    traced = traced && trace_writer.close();
+    TraceReader trace_reader;
+    std::string reason;
+    TraceTrial trial;
+    unsigned long long int trace_star6_count = 0;
+    unsigned long long int trace_target_star6_count = 0;
+    traced = traced && trace_reader.open(trace_path, reason) &&
+             trace_reader.seed == seed &&
+             trace_reader.current_pull == current_pull[i];
+    while (traced && trace_reader.next_trial(trial)) {
+      trace_star6_count += trial.run_length.size();
+      trace_target_star6_count += trial.finished;
+    }
+    identical = is_identical_state(branchy_state, trace_state) && traced &&
+                !trace_reader.is_corrupted() &&
+                trace_star6_count == branchy_state.star6_count &&
+                trace_target_star6_count == branchy_state.target_star6_count;
+    remove(trace_path.c_str());
+    std::cout << "Case " << i << ": branchy vs trace, identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // The sensitivity kernel must produce the same state, and count every
+    // trial into its scores
+    SensitivityModel sensitivity_model(probability_wrapper, parameter);
+    SensitivityStatistics sensitivity_statistics;
+    SimulationState sensitivity_state(parameter);
+    std::mt19937_64 sensitivity_mt(seed);
+    PullDistribution sensitivity_dist(dist_left_border, dist_right_border);
+    for (int chunk = 0; chunk < chunk_num; ++chunk) {
+      simulate_sensitivity(sensitivity_state, sensitivity_statistics,
+                           sensitivity_model, parameter, sensitivity_mt,
+                           sensitivity_dist, chunk_pull_time);
+    }
+    identical = is_identical_state(branchy_state, sensitivity_state) &&
+                sensitivity_statistics.trial_num ==
+                    sensitivity_state.target_star6_count;
+    std::cout << "Case " << i << ": branchy vs sensitivity, identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // The control variate kernel must produce the same state, and sum up the
+    // pulls and the star 6 operators of every finished trial
+    ControlVariateStatistics control_variate_statistics;
+    SimulationState control_variate_state(parameter);
+    std::mt19937_64 control_variate_mt(seed);
+    PullDistribution control_variate_dist(dist_left_border, dist_right_border);
+    for (int chunk = 0; chunk < chunk_num; ++chunk) {
+      simulate_control_variates(control_variate_state,
+                                control_variate_statistics, parameter,
+                                control_variate_mt, control_variate_dist,
+                                chunk_pull_time);
+    }
+    identical =
+        is_identical_state(branchy_state, control_variate_state) &&
+        control_variate_statistics.trial_num ==
+            control_variate_state.target_star6_count &&
+        control_variate_statistics.control_sum[control_variate_pull] ==
+            chunk_pull_time * chunk_num -
+                control_variate_state.current_pull_count &&
+        control_variate_statistics.control_sum[control_variate_star6] ==
+            control_variate_statistics.trial_start_star6_count;
+    std::cout << "Case " << i << ": branchy vs control variates, identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+
+    // The rarity model must produce the same state, and its outcome classes
+    // must add up to the pulls and the star 6 counters
+    RarityModel rarity_model(probability_wrapper, parameter);
+    RarityStatistics rarity_statistics;
+    SimulationState rarity_state(parameter);
+    std::mt19937_64 rarity_mt(seed);
+    PullDistribution rarity_dist(dist_left_border, dist_right_border);
+    for (int chunk = 0; chunk < chunk_num; ++chunk) {
+      simulate_rarity(rarity_state, rarity_statistics, rarity_model, parameter,
+                      rarity_mt, rarity_dist, chunk_pull_time);
+    }
+    unsigned long long int outcome_count[outcome_num];
+    unsigned long long int pull_count = 0;
+    for (unsigned int outcome = 0; outcome < outcome_num; ++outcome) {
+      outcome_count[outcome] = rarity_statistics.outcome_count[outcome] +
+                               rarity_statistics.trial_outcome_count[outcome];
+      pull_count += outcome_count[outcome];
+    }
+    identical = is_identical_state(branchy_state, rarity_state) &&
+                pull_count == chunk_pull_time * chunk_num &&
+                outcome_count[outcome_target_star6] ==
+                    rarity_state.target_star6_count &&
+                outcome_count[outcome_target_star6] +
+                        outcome_count[outcome_other_rate_up_star6] +
+                        outcome_count[outcome_off_banner_star6] ==
+                    rarity_state.star6_count;
+    std::cout << "Case " << i << ": branchy vs rarity, identical = "
+              << identical << ", " << (identical ? "Pass" : "Case failed!")
+              << std::endl;
+    if (!identical) {
+      failed_case_num++;
+    }
+  }
+
+  // A trial that starts at or beyond the pity starting point must keep the
+  // raised thresholds, not restart from the base rate
+  for (size_t i = 0; i < case_num; ++i) {
+    ProbabilityWrapper probability_wrapper(0.02, conditional_rate[i], 0.02,
+                                           banner_operator_num[i]);
+    SimulationParameter parameter(probability_wrapper, pity_starting_point[i],
+                                  current_pull[i]);
+    const std::string kernel_names[] = {kernel_branchy, kernel_branchless};
+    for (const std::string& kernel_name : kernel_names) {
+      const bool restarted =
+          is_restarted_at_current_pull(kernel_name, parameter, seed);
+      std::cout << "Case " << i << ": " << kernel_name
+                << " restarts at current pull = " << restarted << ", "
+                << (restarted ? "Pass" : "Case failed!") << std::endl;
+      if (!restarted) {
+        failed_case_num++;
+      }
+    }
+  }
+
+  // --isa must select every supported variant and reject the others, and the
+  // default must stay the most advanced one
+  const std::string default_isa = get_kernel_isa();
+  bool selected = default_isa == get_supported_kernel_isas().back();
+  for (const std::string& isa : get_supported_kernel_isas()) {
+    selected = selected && select_kernel_isa(isa) && get_kernel_isa() == isa;
+  }
+  selected = selected && !select_kernel_isa("avx") &&
+             select_kernel_isa(default_isa) && get_kernel_isa() == default_isa;
+  std::cout << "Selected isa variants = " << selected << ", "
+            << (selected ? "Pass" : "Case failed!") << std::endl;
+  if (!selected) {
+    failed_case_num++;
+  }
+
+  std::cout << "\nFailed cases = " << failed_case_num << std::endl;
+  std::cout << "*************** End Testing ***************\n" << std::endl;
+
+  return failed_case_num == 0 ? 0 : 1;
+}
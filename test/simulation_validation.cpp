@@ -0,0 +1,690 @@
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+#include "../markov_chain.h"
+#include "../utils.h"
+
+// Validate every simulation engine and kernel variant against the exact
+// probabilities of the pity system (markov_chain.h) and against the
+// reference results under res/.
+//
+// Usage: ./simulation_validation [<total pull time of each run>] [<res directory>]
+
+// A test fails if its p-value is smaller than this value. Kept tiny because
+// every run of the validation performs dozens of tests
+const double significance_level = 1e-6;
+// A bin fails the comparison with the reference results if its z-score is
+// greater than this value
+const double max_abs_z_score = 6.0;
+// Bins with fewer expected events are merged (chi-squared test) or skipped
+// (z-score) since the normal approximation does not hold for them
+const double min_expected_count = 25.0;
+// The tables of --instant are computed in another order than the Markov
+// chain, hence may only differ by the rounding errors
+const double max_instant_difference = 1e-12;
+// The exact mean pulls per trial of --control-variates and the one of the
+// exact distribution, truncated at control_mean_length pulls, where the
+// tail is negligible
+const double max_control_mean_difference = 1e-6;
+const size_t control_mean_length = 20000;
+
+// A simulation engine or kernel variant to be validated
+class ValidationVariant {
+ public:
+  std::string name;
+  std::function<void(SimulationState&, const SimulationParameter&,
+                     uint_fast64_t, unsigned long long int)>
+      run;
+};
+
+// All variants that can produce the result histogram
+std::vector<ValidationVariant> get_validation_variants() {
+  std::vector<ValidationVariant> variants;
+  const std::string kernel_names[] = {kernel_branchy, kernel_branchless,
+                                       kernel_table, kernel_lanes};
+  for (const std::string& kernel_name : kernel_names) {
+    ValidationVariant variant;
+    variant.name = "kernel " + kernel_name;
+    variant.run = [kernel_name](SimulationState& state,
+                                const SimulationParameter& parameter,
+                                uint_fast64_t seed,
+                                unsigned long long int pull_time) {
+      std::mt19937_64 mt(seed);
+      PullDistribution dist(dist_left_border, dist_right_border);
+      simulate(kernel_name, state, parameter, mt, dist, pull_time);
+    };
+    variants.push_back(variant);
+  }
+  // --recycle-bits draws another random stream, which must follow the same
+  // distribution
+  for (const std::string& kernel_name : kernel_names) {
+    ValidationVariant variant;
+    variant.name = "kernel " + kernel_name + " (recycled bits)";
+    variant.run = [kernel_name](SimulationState& state,
+                                const SimulationParameter& parameter,
+                                uint_fast64_t seed,
+                                unsigned long long int pull_time) {
+      RecycledPullGenerator generator(seed);
+      simulate_recycled(kernel_name, state, parameter, generator, pull_time);
+    };
+    variants.push_back(variant);
+  }
+  return variants;
+}
+
+// The settings of a banner to be validated, and optionally the reference
+// result of the same settings loaded from res/
+class BannerSetting {
+ public:
+  double on_banner_star6_conditional_rate;
+  unsigned int banner_operator_num;
+  unsigned int pity_starting_point;
+  unsigned long long int current_pull;
+
+  std::string reference_path;
+  // Pr(S_i) in the reference result, the index 0 is unused
+  std::vector<double> reference_prob;
+  unsigned long long int reference_target_star6_count;
+
+  BannerSetting(double _on_banner_star6_conditional_rate,
+                unsigned int _banner_operator_num,
+                unsigned int _pity_starting_point,
+                unsigned long long int _current_pull)
+      : on_banner_star6_conditional_rate(_on_banner_star6_conditional_rate),
+        banner_operator_num(_banner_operator_num),
+        pity_starting_point(_pity_starting_point),
+        current_pull(_current_pull),
+        reference_target_star6_count(0) {}
+};
+
+// The histogram of the trials that start with current pull c in a
+// CurrentPullTable, as a SimulationState so that the tests can be reused
+SimulationState get_current_pull_table_row(const CurrentPullTable& table,
+                                           const SimulationParameter& parameter,
+                                           unsigned long long int c) {
+  SimulationState state(parameter);
+  state.target_star6_count = table.trial_count[c];
+  for (size_t i = 1; i < result_size; ++i) {
+    state.result[i] = table.result[c * result_size + i];
+  }
+  return state;
+}
+
+// Return the number after the given key in a line of a result file
+bool find_value_after(const std::string& line, const std::string& key,
+                      double& value) {
+  size_t pos = line.find(key);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  value = strtod(line.c_str() + pos + key.size(), nullptr);
+  return true;
+}
+
+// Load the settings and Pr(S_i) from a result file printed by
+// simulation_sequential
+bool load_reference_result(const std::string& path, BannerSetting& setting) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  setting.reference_path = path;
+  setting.reference_prob.assign(result_size, 0.0);
+
+  std::string line;
+  double value = 0.0;
+  while (std::getline(file, line)) {
+    if (find_value_after(line, "Pity System Starting Point: ", value)) {
+      setting.pity_starting_point = static_cast<unsigned int>(value);
+    } else if (find_value_after(line, "Current Pull Times: ", value)) {
+      setting.current_pull = static_cast<unsigned long long int>(value);
+    } else if (find_value_after(line, "the conditional rate is ", value)) {
+      setting.on_banner_star6_conditional_rate = value / 100.0;
+    } else if (find_value_after(line, "Rate-Up Operator(s): ", value)) {
+      setting.banner_operator_num = static_cast<unsigned int>(value);
+    } else if (find_value_after(line, "Target star 6 times: ", value)) {
+      setting.reference_target_star6_count =
+          static_cast<unsigned long long int>(value);
+    } else if (line.compare(0, 5, "Pr(S_") == 0) {
+      size_t i = strtoul(line.c_str() + 5, nullptr, 10);
+      if (i < result_size && find_value_after(line, ") = ", value)) {
+        setting.reference_prob[i] = value / 100.0;
+      }
+    }
+  }
+  return setting.reference_target_star6_count > 0;
+}
+
+// Upper tail probability of the chi-squared distribution, using the
+// Wilson-Hilferty approximation which is accurate for the hundreds of
+// degrees of freedom used here
+double calc_chi_squared_p_value(double statistic, double degree_of_freedom) {
+  const double k = degree_of_freedom;
+  const double z = (std::cbrt(statistic / k) - (1.0 - 2.0 / (9.0 * k))) /
+                   std::sqrt(2.0 / (9.0 * k));
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+// Upper tail probability of the Kolmogorov distribution. Conservative for
+// the discrete distribution of the trial length
+double calc_ks_p_value(double statistic, double sample_size) {
+  const double sqrt_n = std::sqrt(sample_size);
+  const double lambda = (sqrt_n + 0.12 + 0.11 / sqrt_n) * statistic;
+  double p_value = 0.0;
+  for (int j = 1; j <= 100; ++j) {
+    p_value += 2.0 * ((j % 2 == 1) ? 1.0 : -1.0) *
+               std::exp(-2.0 * j * j * lambda * lambda);
+  }
+  return std::min(1.0, std::max(0.0, p_value));
+}
+
+// Pearson's chi-squared test of the result histogram against the exact
+// distribution. The trials longer than the histogram form the last bin, and
+// adjacent bins are merged until every bin expects enough events
+double chi_squared_test(const SimulationState& state,
+                        const std::vector<double>& exact) {
+  const double n = state.target_star6_count;
+  double statistic = 0.0;
+  int bin_num = 0;
+  double observed = 0.0;
+  double expected = 0.0;
+  double observed_sum = 0.0;
+  double expected_sum = 0.0;
+  for (size_t i = 1; i < exact.size(); ++i) {
+    observed += state.result[i];
+    expected += n * exact[i];
+    if (expected >= min_expected_count) {
+      statistic += (observed - expected) * (observed - expected) / expected;
+      bin_num++;
+      observed_sum += observed;
+      expected_sum += expected;
+      observed = 0.0;
+      expected = 0.0;
+    }
+  }
+  // The remaining bins and the tail
+  observed = n - observed_sum;
+  expected = n - expected_sum;
+  if (expected > 0.0) {
+    statistic += (observed - expected) * (observed - expected) / expected;
+    bin_num++;
+  }
+  double p_value = calc_chi_squared_p_value(statistic, bin_num - 1);
+  std::cout << "\t\tchi-squared = " << statistic << " (" << bin_num - 1
+            << " degrees of freedom), p-value = " << p_value << std::endl;
+  return p_value;
+}
+
+// Kolmogorov-Smirnov test of the cumulated probability Pr(W_i)
+double ks_test(const SimulationState& state, const std::vector<double>& exact) {
+  const double n = state.target_star6_count;
+  double statistic = 0.0;
+  double observed_cdf = 0.0;
+  double exact_cdf = 0.0;
+  for (size_t i = 1; i < exact.size(); ++i) {
+    observed_cdf += state.result[i] / n;
+    exact_cdf += exact[i];
+    statistic = std::max(statistic, std::abs(observed_cdf - exact_cdf));
+  }
+  double p_value = calc_ks_p_value(statistic, n);
+  std::cout << "\t\tKS statistic = " << statistic << ", p-value = " << p_value
+            << std::endl;
+  return p_value;
+}
+
+// The maximum |z-score| between two estimations of Pr(S_i) from n1 and n2
+// trials. n2 == 0 means the second one is the exact probability
+double calc_max_abs_z_score(const std::vector<double>& prob1, double n1,
+                            const std::vector<double>& prob2, double n2,
+                            const std::vector<double>& exact) {
+  double max_z = 0.0;
+  for (size_t i = 1; i < exact.size(); ++i) {
+    if (exact[i] * std::min(n1, n2 > 0.0 ? n2 : n1) < min_expected_count) {
+      continue;
+    }
+    double variance = exact[i] * (1.0 - exact[i]) / n1;
+    if (n2 > 0.0) {
+      variance += exact[i] * (1.0 - exact[i]) / n2;
+    }
+    // The reference results are printed with 6 significant digits
+    double rounding_error = 5e-6 * exact[i];
+    double z =
+        std::abs(prob1[i] - prob2[i]) / (std::sqrt(variance) + rounding_error);
+    max_z = std::max(max_z, z);
+  }
+  return max_z;
+}
+
+// Pr(S_i) of a trial that starts with the pity counter c, with the
+// probabilities of the model moved by h times their derivatives by the given
+// parameter, i.e., the distribution at the parameter + h
+std::vector<double> calc_moved_trial_distribution(
+    const SensitivityModel& model, unsigned int sensitivity_parameter,
+    double h, unsigned long long int c) {
+  const unsigned long long int pity_num = model.pity_num;
+  std::vector<double> star6(pity_num);
+  std::vector<double> target_star6(pity_num);
+  for (unsigned long long int p = 0; p < pity_num; ++p) {
+    star6[p] =
+        model.star6_prob[p] +
+        h * model.star6_derivative[sensitivity_parameter * pity_num + p];
+    target_star6[p] =
+        model.target_star6_prob[p] +
+        h * model.target_star6_derivative[sensitivity_parameter * pity_num + p];
+  }
+  // prob[p * result_size + i] is Pr(S_i) from the pity counter p
+  std::vector<double> prob(pity_num * result_size, 0.0);
+  for (size_t i = 1; i < result_size; ++i) {
+    for (unsigned long long int p = 0; p < pity_num; ++p) {
+      const unsigned long long int next = std::min(p + 1, pity_num - 1);
+      prob[p * result_size + i] =
+          i == 1 ? target_star6[p]
+                 : (1.0 - star6[p]) * prob[next * result_size + i - 1] +
+                       (star6[p] - target_star6[p]) * prob[i - 1];
+    }
+  }
+  return std::vector<double>(
+      prob.begin() + std::min(c, pity_num - 1) * result_size,
+      prob.begin() + (std::min(c, pity_num - 1) + 1) * result_size);
+}
+
+// The maximum |z-score| between the estimated derivatives of Pr(S_i) and
+// Pr(W_i) and the exact ones, skipping the bins with too few expected trials
+double calc_max_sensitivity_z_score(const SensitivityEstimate& estimate,
+                                    const std::vector<double>& exact_derivative,
+                                    const std::vector<double>& exact,
+                                    double trial_num) {
+  double max_z = 0.0;
+  double exact_derivative_w = 0.0;
+  for (size_t i = 1; i < result_size; ++i) {
+    exact_derivative_w += exact_derivative[i];
+    if (exact[i] * trial_num < min_expected_count) {
+      continue;
+    }
+    const double z_s = std::abs(estimate.derivative_s[i] - exact_derivative[i]) /
+                       estimate.standard_error_s[i];
+    const double z_w = std::abs(estimate.derivative_w[i] - exact_derivative_w) /
+                       estimate.standard_error_w[i];
+    max_z = std::max(max_z, std::max(z_s, z_w));
+  }
+  return max_z;
+}
+
+// The maximum |z-score| between the probabilities corrected by the control
+// variates and the exact ones, skipping the bins with too few expected
+// trials
+double calc_max_control_variate_z_score(const ControlVariateEstimate& estimate,
+                                        const std::vector<double>& exact,
+                                        double trial_num) {
+  double max_z = 0.0;
+  double exact_w = 0.0;
+  for (size_t i = 1; i < result_size; ++i) {
+    exact_w += exact[i];
+    if (exact[i] * trial_num < min_expected_count) {
+      continue;
+    }
+    const double z_s =
+        std::abs(estimate.prob_s[i] - exact[i]) / estimate.standard_error_s[i];
+    const double z_w =
+        std::abs(estimate.prob_w[i] - exact_w) / estimate.standard_error_w[i];
+    max_z = std::max(max_z, std::max(z_s, z_w));
+  }
+  return max_z;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned long long int total_pull_time = 50000000;
+  std::string res_dir = "../res";
+  if (argc > 1) {
+    total_pull_time = strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    res_dir = argv[2];
+  }
+  // Fixed seed so that the validation is reproducible
+  const uint_fast64_t seed = 20210101;
+
+  std::cout << "\n*************** Start Validation ***************\n";
+  std::cout << "Total pull time of each run: " << total_pull_time << std::endl;
+  std::cout << "Random seed: " << seed << std::endl;
+
+  std::vector<BannerSetting> settings;
+  const std::string reference_files[] = {
+      "limited_500000000000_double_up_simu_1.res",
+      "limited_500000000000_single_up_simu_1.res",
+      "standard_500000000000_double_up_simu_1.res",
+      "standard_500000000000_single_up_simu_1.res"};
+  for (const std::string& file : reference_files) {
+    BannerSetting setting(0.0, 0, 0, 0);
+    if (load_reference_result(res_dir + "/" + file, setting)) {
+      settings.push_back(setting);
+    } else {
+      std::cout << "Note: Cannot load the reference result " << res_dir << "/"
+                << file << std::endl;
+    }
+  }
+  // Settings without reference results
+  settings.push_back(BannerSetting(0.5, 1, 20, 42));
+  settings.push_back(BannerSetting(0.7, 2, 50, 60));
+
+  std::vector<std::string> failures;
+  const std::vector<ValidationVariant> variants = get_validation_variants();
+  for (BannerSetting& setting : settings) {
+    ProbabilityWrapper probability_wrapper(
+        0.02, setting.on_banner_star6_conditional_rate, 0.02,
+        setting.banner_operator_num);
+    SimulationParameter parameter(probability_wrapper,
+                                  setting.pity_starting_point,
+                                  setting.current_pull);
+    const std::vector<double> exact = calc_exact_trial_distribution(
+        parameter, setting.current_pull, result_size);
+
+    std::ostringstream description;
+    description << "conditional rate " << setting.on_banner_star6_conditional_rate
+                << ", " << setting.banner_operator_num << " rate-up, pity "
+                << setting.pity_starting_point << ", current pull "
+                << setting.current_pull;
+    std::cout << "\nBanner setting: " << description.str() << std::endl;
+
+    if (!setting.reference_path.empty()) {
+      double z = calc_max_abs_z_score(
+          setting.reference_prob, setting.reference_target_star6_count, exact,
+          0.0, exact);
+      std::cout << "\treference " << setting.reference_path
+                << " vs exact: max |z| = " << z << std::endl;
+      if (z > max_abs_z_score) {
+        failures.push_back(description.str() + ": reference vs exact");
+      }
+    }
+
+    for (const ValidationVariant& variant : variants) {
+      SimulationState state(parameter);
+      variant.run(state, parameter, seed, total_pull_time);
+      std::cout << "\t" << variant.name << " (" << state.target_star6_count
+                << " trials):" << std::endl;
+
+      const std::string failure = description.str() + ": " + variant.name;
+      if (chi_squared_test(state, exact) < significance_level) {
+        failures.push_back(failure + " chi-squared test");
+      }
+      if (ks_test(state, exact) < significance_level) {
+        failures.push_back(failure + " KS test");
+      }
+      if (!setting.reference_path.empty()) {
+        std::vector<double> prob(result_size, 0.0);
+        for (size_t i = 1; i < result_size; ++i) {
+          prob[i] = static_cast<double>(state.result[i]) /
+                    state.target_star6_count;
+        }
+        double z = calc_max_abs_z_score(prob, state.target_star6_count,
+                                        setting.reference_prob,
+                                        setting.reference_target_star6_count,
+                                        exact);
+        std::cout << "\t\tvs reference: max |z| = " << z << std::endl;
+        if (z > max_abs_z_score) {
+          failures.push_back(failure + " vs reference");
+        }
+      }
+    }
+
+    // --sensitivity must match the central differences of the exact
+    // distribution by every parameter
+    {
+      SensitivityModel model(probability_wrapper, parameter);
+      SensitivityStatistics statistics;
+      SimulationState state(parameter);
+      std::mt19937_64 mt(seed);
+      PullDistribution dist(dist_left_border, dist_right_border);
+      simulate_sensitivity(state, statistics, model, parameter, mt, dist,
+                           total_pull_time);
+      std::cout << "\tsensitivity (" << statistics.trial_num
+                << " trials):" << std::endl;
+      const double h = 1e-6;
+      for (unsigned int k = 0; k < sensitivity_parameter_num; ++k) {
+        const std::vector<double> upper = calc_moved_trial_distribution(
+            model, k, h, setting.current_pull);
+        const std::vector<double> lower = calc_moved_trial_distribution(
+            model, k, -h, setting.current_pull);
+        std::vector<double> exact_derivative(result_size, 0.0);
+        for (size_t i = 1; i < result_size; ++i) {
+          exact_derivative[i] = (upper[i] - lower[i]) / (2.0 * h);
+        }
+        const double z = calc_max_sensitivity_z_score(
+            estimate_sensitivity(state, statistics, k), exact_derivative,
+            exact, static_cast<double>(statistics.trial_num));
+        std::cout << "\t\tby " << sensitivity_parameter_name[k]
+                  << ": max |z| = " << z << std::endl;
+        if (z > max_abs_z_score) {
+          failures.push_back(description.str() + ": sensitivity by " +
+                             sensitivity_parameter_name[k]);
+        }
+      }
+    }
+
+    // --control-variates: the exact means of the controls must be the ones
+    // of the exact distribution, and the corrected probabilities must match
+    // the exact ones within their standard errors
+    {
+      const ControlVariateModel model(parameter);
+      ControlVariateStatistics statistics;
+      SimulationState state(parameter);
+      std::mt19937_64 mt(seed);
+      PullDistribution dist(dist_left_border, dist_right_border);
+      simulate_control_variates(state, statistics, parameter, mt, dist,
+                                total_pull_time);
+      const ControlVariateEstimate estimate =
+          estimate_control_variates(state, statistics, model);
+      const std::vector<double> long_exact = calc_exact_trial_distribution(
+          parameter, setting.current_pull, control_mean_length);
+      double exact_mean_pull = 0.0;
+      for (size_t i = 1; i < control_mean_length; ++i) {
+        exact_mean_pull += i * long_exact[i];
+      }
+      double variance_ratio_w = 0.0;
+      for (size_t i = 1; i < result_size; ++i) {
+        variance_ratio_w += estimate.variance_ratio_w[i];
+      }
+      const double mean_difference =
+          std::abs(model.mean[control_variate_pull] - exact_mean_pull);
+      const double z = calc_max_control_variate_z_score(
+          estimate, exact, static_cast<double>(statistics.trial_num));
+      std::cout << "\tcontrol variates (" << statistics.trial_num
+                << " trials):" << std::endl;
+      std::cout << "\t\texact mean pulls per trial = "
+                << model.mean[control_variate_pull]
+                << ", |difference| = " << mean_difference << std::endl;
+      std::cout << "\t\tvs exact: max |z| = " << z
+                << ", mean variance left of Pr(W_i) = "
+                << variance_ratio_w / (result_size - 1) << std::endl;
+      if (mean_difference > max_control_mean_difference) {
+        failures.push_back(description.str() + ": control variate means");
+      }
+      if (z > max_abs_z_score) {
+        failures.push_back(description.str() + ": control variates");
+      }
+    }
+
+    // --all-current-pull measures every current pull in one run, check some
+    // of its rows against the exact distribution of the same current pull
+    if (setting.current_pull == 0) {
+      CurrentPullTable table(parameter);
+      SimulationState state(parameter);
+      std::mt19937_64 mt(seed);
+      PullDistribution dist(dist_left_border, dist_right_border);
+      simulate_current_pull_table(table, state, parameter, mt, dist,
+                                  total_pull_time);
+      const unsigned long long int checked_rows[] = {
+          0, setting.pity_starting_point / 2, setting.pity_starting_point,
+          table.state_num - 1};
+      for (unsigned long long int c : checked_rows) {
+        const SimulationState row = get_current_pull_table_row(table, parameter, c);
+        const std::vector<double> row_exact =
+            calc_exact_trial_distribution(parameter, c, result_size);
+        std::cout << "\tall current pull, row " << c << " ("
+                  << row.target_star6_count << " trials):" << std::endl;
+
+        std::ostringstream failure;
+        failure << description.str() << ": all current pull row " << c;
+        if (chi_squared_test(row, row_exact) < significance_level) {
+          failures.push_back(failure.str() + " chi-squared test");
+        }
+        if (ks_test(row, row_exact) < significance_level) {
+          failures.push_back(failure.str() + " KS test");
+        }
+      }
+    }
+
+    // --strategy: saving the whole budget for the next limited banner gets
+    // the copy with exactly Pr(W_budget) of a trial from pity counter 0, and
+    // playing the optimal strategy must get its expected wanted copies
+    {
+      const unsigned long long int budget = 150;
+      const StrategyTable table =
+          solve_strategy(parameter, budget, 2, setting.current_pull, false);
+      const std::vector<double> exact_from_zero =
+          calc_exact_trial_distribution(parameter, 0, budget + 1);
+      const StrategyTable single_table =
+          solve_strategy(parameter, budget, 1, setting.current_pull, false);
+      double exact_save_all_value = 0.0;
+      for (size_t i = 1; i <= budget; ++i) {
+        exact_save_all_value += exact_from_zero[i];
+      }
+      std::mt19937_64 mt(seed);
+      PullDistribution dist(dist_left_border, dist_right_border);
+      const StrategyEvaluation evaluation = evaluate_strategy(
+          table, parameter, setting.current_pull, mt, dist, total_pull_time);
+      const double z = std::fabs(evaluation.mean - table.optimal_value) /
+                       evaluation.standard_error;
+      std::cout << "	strategy (" << evaluation.episode_num
+                << " episodes): |z| = " << z << ", save all error = "
+                << std::fabs(single_table.save_all_value - exact_save_all_value)
+                << std::endl;
+      if (std::fabs(single_table.save_all_value - exact_save_all_value) >
+          1e-9) {
+        failures.push_back(description.str() + ": strategy vs exact");
+      }
+      if (z > max_abs_z_score) {
+        failures.push_back(description.str() + ": strategy vs Monte Carlo");
+      }
+    }
+  }
+
+  // --pity-curve: the curve of the built-in rule must compile into its
+  // thresholds, and the table kernel must match the exact distribution of a
+  // soft pity curve that the built-in rule cannot express
+  const std::string curve_files[] = {"arknights.pity_curve",
+                                     "soft_pity.pity_curve"};
+  for (const std::string& file : curve_files) {
+    PityCurve pity_curve;
+    std::string reason;
+    if (!load_pity_curve(res_dir + "/" + file, pity_curve, reason)) {
+      std::cout << "\nNote: Cannot load the pity curve (" << reason << ")"
+                << std::endl;
+      continue;
+    }
+    ProbabilityWrapper probability_wrapper(0.02, 0.5, 0.02, 1);
+    SimulationParameter parameter(probability_wrapper, pity_curve.star6_rate,
+                                  0);
+    const std::string description = "pity curve " + file;
+    std::cout << "\nBanner setting: " << description << std::endl;
+
+    if (file == "arknights.pity_curve") {
+      SimulationParameter builtin_parameter(probability_wrapper, 50, 0);
+      const bool identical = parameter.star6_threshold_table ==
+                                 builtin_parameter.star6_threshold_table &&
+                             parameter.target_star6_threshold_table ==
+                                 builtin_parameter.target_star6_threshold_table;
+      std::cout << "\tvs built-in rule: identical thresholds = " << identical
+                << std::endl;
+      if (!identical) {
+        failures.push_back(description + ": thresholds vs built-in rule");
+      }
+    }
+
+    const std::vector<double> exact =
+        calc_exact_trial_distribution(parameter, 0, result_size);
+    // Both kernels that look the thresholds up
+    const std::string curve_kernel_names[] = {kernel_table, kernel_lanes};
+    for (const std::string& kernel_name : curve_kernel_names) {
+      SimulationState state(parameter);
+      std::mt19937_64 mt(seed);
+      PullDistribution dist(dist_left_border, dist_right_border);
+      simulate(kernel_name, state, parameter, mt, dist, total_pull_time);
+      std::cout << "\tkernel " << kernel_name << " ("
+                << state.target_star6_count << " trials):" << std::endl;
+      if (chi_squared_test(state, exact) < significance_level) {
+        failures.push_back(description + ": kernel " + kernel_name +
+                           " chi-squared test");
+      }
+      if (ks_test(state, exact) < significance_level) {
+        failures.push_back(description + ": kernel " + kernel_name +
+                           " KS test");
+      }
+    }
+  }
+
+  // --instant: the tables built into the program must be the exact
+  // distributions of the default banners for every current pull, and must
+  // not answer any other setting
+  const double conditional_rates[] = {
+      limited_banner_on_banner_star6_conditional_rate,
+      standard_banner_on_banner_star6_conditional_rate};
+  const unsigned int banner_operator_nums[] = {1, 2};
+  for (double conditional_rate : conditional_rates) {
+    for (unsigned int banner_operator_num : banner_operator_nums) {
+      ProbabilityWrapper probability_wrapper(0.02, conditional_rate, 0.02,
+                                             banner_operator_num);
+      std::ostringstream description;
+      description << "instant table of conditional rate " << conditional_rate
+                  << ", " << banner_operator_num << " rate-up";
+      std::cout << "\nBanner setting: " << description.str() << std::endl;
+
+      double max_difference = 0.0;
+      bool complete = true;
+      for (unsigned long long int c = 0; c < instant_pity_num; ++c) {
+        SimulationParameter parameter(probability_wrapper,
+                                      instant_pity_starting_point, c);
+        const double* distribution = find_instant_distribution(parameter);
+        if (distribution == nullptr) {
+          complete = false;
+          continue;
+        }
+        const std::vector<double> exact =
+            calc_exact_trial_distribution(parameter, c, result_size);
+        for (size_t i = 1; i < result_size; ++i) {
+          max_difference =
+              std::max(max_difference, std::fabs(distribution[i] - exact[i]));
+        }
+      }
+      SimulationParameter unreachable_parameter(
+          probability_wrapper, instant_pity_starting_point, instant_pity_num);
+      SimulationParameter custom_parameter(probability_wrapper, 20, 0);
+      const bool exclusive =
+          find_instant_distribution(unreachable_parameter) == nullptr &&
+          find_instant_distribution(custom_parameter) == nullptr;
+      std::cout << "\tvs exact: every current pull = " << complete
+                << ", max |difference| = " << max_difference
+                << ", other settings excluded = " << exclusive << std::endl;
+      if (!complete || max_difference > max_instant_difference || !exclusive) {
+        failures.push_back(description.str() + ": vs exact");
+      }
+    }
+  }
+
+  std::cout << std::endl;
+  if (!failures.empty()) {
+    std::cout << "!!!!!!!!!!!!!!! VALIDATION FAILED !!!!!!!!!!!!!!!" << std::endl;
+    std::cout << "The following results do not match the expected distribution:"
+              << std::endl;
+    for (const std::string& failure : failures) {
+      std::cout << "\t" << failure << std::endl;
+    }
+    std::cout << std::endl;
+    return 1;
+  }
+  std::cout << "All variants match the expected distribution" << std::endl;
+  std::cout << "*************** End Validation ***************\n" << std::endl;
+  return 0;
+}
@@ -139,6 +139,270 @@ test_case = [["./cmd_parse_unitest", "1"]
     , ["./cmd_parse_unitest -help", "0"]
     , ["./cmd_parse_unitest --", "0"]
     , ["./cmd_parse_unitest --help 2", "0"]
+
+    # Test cases for --perf-stats
+    , ["./cmd_parse_unitest --perf-stats", "1"]
+    , ["./cmd_parse_unitest --perf-stats 2", "0"]
+    , ["./cmd_parse_unitest --perf-stats --perf-stats", "0"]
+    , ["./cmd_parse_unitest --perf-stat", "0"]
+    , ["./cmd_parse_unitest --perf-stats -t 20 --standard", "1"]
+    , ["./cmd_parse_unitest --perf-stats --help", "0"]
+
+    # Test cases for --kernel
+    , ["./cmd_parse_unitest --kernel branchy", "1"]
+    , ["./cmd_parse_unitest --kernel branchless", "1"]
+    , ["./cmd_parse_unitest --kernel table", "1"]
+    , ["./cmd_parse_unitest --kernel lanes", "1"]
+    , ["./cmd_parse_unitest --kernel lane", "0"]
+    , ["./cmd_parse_unitest --kernel", "0"]
+    , ["./cmd_parse_unitest --kernel branchy branchless", "0"]
+    , ["./cmd_parse_unitest --kernel kaltsit_is_my_waifu", "0"]
+    , ["./cmd_parse_unitest --kernel 1", "0"]
+    , ["./cmd_parse_unitest --kernel branchless --kernel branchy", "0"]
+    , ["./cmd_parse_unitest --kernel branchless --perf-stats -t 20 -p 50 -n 1 -c 3", "1"]
+
+    # Test cases for --analyze
+    , ["./cmd_parse_unitest --analyze pull_log.txt", "1"]
+    , ["./cmd_parse_unitest --analyze", "0"]
+    , ["./cmd_parse_unitest --analyze pull_log.txt pull_log.txt", "0"]
+    , ["./cmd_parse_unitest --analyze a.txt --analyze b.txt", "0"]
+    , ["./cmd_parse_unitest --analyze --perf-stats", "0"]
+    , ["./cmd_parse_unitest --analyze pull_log.txt -p 50 -n 1 -c 3", "1"]
+
+    # Test cases for --bootstrap
+    , ["./cmd_parse_unitest --bootstrap 1", "1"]
+    , ["./cmd_parse_unitest --bootstrap 1000", "1"]
+    , ["./cmd_parse_unitest --bootstrap 100000", "1"]
+    , ["./cmd_parse_unitest --bootstrap 100001", "0"]
+    , ["./cmd_parse_unitest --bootstrap 0", "0"]
+    , ["./cmd_parse_unitest --bootstrap -1", "0"]
+    , ["./cmd_parse_unitest --bootstrap 2.0", "0"]
+    , ["./cmd_parse_unitest --bootstrap kaltsit_is_my_waifu", "0"]
+    , ["./cmd_parse_unitest --bootstrap", "0"]
+    , ["./cmd_parse_unitest --bootstrap 10 20", "0"]
+    , ["./cmd_parse_unitest --bootstrap 10 --bootstrap 20", "0"]
+    , ["./cmd_parse_unitest --bootstrap 1000 --kernel branchless --perf-stats -t 20 -p 50 -n 1 -c 3", "1"]
+
+    # Test cases for --all-current-pull
+    , ["./cmd_parse_unitest --all-current-pull", "1"]
+    , ["./cmd_parse_unitest --all-current-pull 1", "0"]
+    , ["./cmd_parse_unitest --all-current-pull --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --all-current-pul", "0"]
+    , ["./cmd_parse_unitest --all-current-pull -c 3", "0"]
+    , ["./cmd_parse_unitest --all-current-pull --current-pull 3", "0"]
+    , ["./cmd_parse_unitest --all-current-pull --kernel branchy", "0"]
+    , ["./cmd_parse_unitest --all-current-pull --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --all-current-pull --analyze pull_log.txt", "0"]
+    , ["./cmd_parse_unitest --all-current-pull --perf-stats -t 20 -p 50 -n 1 --standard", "1"]
+
+    # Test cases for --kernel-info
+    , ["./cmd_parse_unitest --kernel-info", "1"]
+    , ["./cmd_parse_unitest --kernel-info 1", "0"]
+    , ["./cmd_parse_unitest --kernel-info --kernel-info", "0"]
+    , ["./cmd_parse_unitest --kernel-inf", "0"]
+    , ["./cmd_parse_unitest --kernel-info --kernel branchless", "1"]
+
+    # Test cases for --rarity
+    , ["./cmd_parse_unitest --rarity", "1"]
+    , ["./cmd_parse_unitest --rarity 1", "0"]
+    , ["./cmd_parse_unitest --rarity --rarity", "0"]
+    , ["./cmd_parse_unitest --rarit", "0"]
+    , ["./cmd_parse_unitest --rarity --kernel branchless", "0"]
+    , ["./cmd_parse_unitest --rarity --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --rarity --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --rarity --analyze pull_log.txt", "0"]
+    , ["./cmd_parse_unitest --rarity --perf-stats -t 20 -p 50 -n 1 -c 3 --standard", "1"]
+
+    # Test cases for --time-budget
+    , ["./cmd_parse_unitest --time-budget 60", "1"]
+    , ["./cmd_parse_unitest --time-budget 1", "1"]
+    , ["./cmd_parse_unitest --time-budget 31536000", "1"]
+    , ["./cmd_parse_unitest --time-budget 31536001", "0"]
+    , ["./cmd_parse_unitest --time-budget 0", "0"]
+    , ["./cmd_parse_unitest --time-budget -5", "0"]
+    , ["./cmd_parse_unitest --time-budget 1.5", "0"]
+    , ["./cmd_parse_unitest --time-budget abc", "0"]
+    , ["./cmd_parse_unitest --time-budget", "0"]
+    , ["./cmd_parse_unitest --time-budget 60 70", "0"]
+    , ["./cmd_parse_unitest --time-budget 60 --time-budget 70", "0"]
+    , ["./cmd_parse_unitest --time-budget 60 -t 100", "0"]
+    , ["./cmd_parse_unitest --time-budget 60 --total-pull-time 100", "0"]
+    , ["./cmd_parse_unitest --time-budget 60 --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --time-budget 60 --rarity -p 50 -n 1 -c 3 --standard", "1"]
+    , ["./cmd_parse_unitest --time-budget 60 --all-current-pull --perf-stats", "1"]
+
+    # Test cases for --shm
+    , ["./cmd_parse_unitest --shm arknights", "1"]
+    , ["./cmd_parse_unitest --shm arknights_run-1.v2", "1"]
+    , ["./cmd_parse_unitest --shm", "0"]
+    , ["./cmd_parse_unitest --shm a b", "0"]
+    , ["./cmd_parse_unitest --shm a/b", "0"]
+    , ["./cmd_parse_unitest --shm ..", "0"]
+    , ["./cmd_parse_unitest --shm 'a b'", "0"]
+    , ["./cmd_parse_unitest --shm " + "a" * 201, "0"]
+    , ["./cmd_parse_unitest --shm arknights --shm other", "0"]
+    , ["./cmd_parse_unitest --shm arknights --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --shm arknights --analyze pull_log.txt", "0"]
+    , ["./cmd_parse_unitest --shm arknights --time-budget 60 --rarity -p 50 -n 1 -c 3 --standard", "1"]
+    , ["./cmd_parse_unitest --shm arknights --all-current-pull --perf-stats", "1"]
+
+    # Test cases for --strategy and --strategy-targets
+    , ["./cmd_parse_unitest --strategy 300", "1"]
+    , ["./cmd_parse_unitest --strategy 1", "1"]
+    , ["./cmd_parse_unitest --strategy 100000", "1"]
+    , ["./cmd_parse_unitest --strategy 100001", "0"]
+    , ["./cmd_parse_unitest --strategy 0", "0"]
+    , ["./cmd_parse_unitest --strategy -3", "0"]
+    , ["./cmd_parse_unitest --strategy x", "0"]
+    , ["./cmd_parse_unitest --strategy", "0"]
+    , ["./cmd_parse_unitest --strategy 300 400", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --strategy-targets 6", "1"]
+    , ["./cmd_parse_unitest --strategy 300 --strategy-targets 7", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --strategy-targets 0", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --strategy-targets", "0"]
+    , ["./cmd_parse_unitest --strategy-targets 2", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --kernel branchy", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --rarity", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --analyze pull_log.txt", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --time-budget 60", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --shm arknights", "0"]
+    , ["./cmd_parse_unitest --strategy 300 --strategy-targets 2 -t 1000 -p 50 -n 1 -c 3 --standard --perf-stats", "1"]
+
+    # Test cases for --pity-curve (the file is loaded after the parsing)
+    , ["./cmd_parse_unitest --pity-curve curve.txt", "1"]
+    , ["./cmd_parse_unitest --pity-curve", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt other.txt", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --pity-curve other.txt", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt -p 50", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --pity 50", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --rarity", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --kernel branchy", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --kernel table", "1"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --kernel lanes", "1"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt -c 500", "1"]
+    , ["./cmd_parse_unitest --kernel table -c 500", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --strategy 300 --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --strategy 300 -t 1000 -n 1 -c 3 --standard", "1"]
+    , ["./cmd_parse_unitest --pity-curve curve.txt --bootstrap 100 --kernel table -t 1000 -n 1 --limited", "1"]
+
+    # Test cases for --trace (the file is created after the parsing)
+    , ["./cmd_parse_unitest --trace trace.bin", "1"]
+    , ["./cmd_parse_unitest --trace", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin other.bin", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --trace other.bin", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --kernel branchy", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --rarity", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --strategy 300", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --analyze pulls.log", "0"]
+    , ["./cmd_parse_unitest --trace trace.bin --pity-curve curve.txt", "1"]
+    , ["./cmd_parse_unitest --trace trace.bin --pity-curve curve.txt --shm seg --time-budget 3 -n 1 -c 3 --standard --perf-stats", "1"]
+
+    # Test cases for --pipeline
+    , ["./cmd_parse_unitest --pipeline", "1"]
+    , ["./cmd_parse_unitest --pipeline 2", "0"]
+    , ["./cmd_parse_unitest --pipeline --kernel table", "1"]
+    , ["./cmd_parse_unitest --pipeline --pity-curve curve.txt --shm seg --time-budget 3 -n 1 -c 3 --perf-stats", "1"]
+    , ["./cmd_parse_unitest --pipeline --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --pipeline --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --pipeline --rarity", "0"]
+    , ["./cmd_parse_unitest --pipeline --trace trace.bin", "0"]
+    , ["./cmd_parse_unitest --pipeline --strategy 300", "0"]
+    , ["./cmd_parse_unitest --pipeline --analyze pulls.log", "0"]
+
+    # Test cases for --instant (other settings fall back to the simulation)
+    , ["./cmd_parse_unitest --instant", "1"]
+    , ["./cmd_parse_unitest --instant 2", "0"]
+    , ["./cmd_parse_unitest --instant --standard -n 1 -c 98", "1"]
+    , ["./cmd_parse_unitest --instant -p 20 -t 1000 --kernel table --pipeline", "1"]
+    , ["./cmd_parse_unitest --instant --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --instant --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --instant --rarity", "0"]
+    , ["./cmd_parse_unitest --instant --trace trace.bin", "0"]
+    , ["./cmd_parse_unitest --instant --strategy 300", "0"]
+    , ["./cmd_parse_unitest --instant --analyze pulls.log", "0"]
+    , ["./cmd_parse_unitest --instant --pity-curve curve.txt", "0"]
+
+    # Test cases for --recycle-bits
+    , ["./cmd_parse_unitest --recycle-bits", "1"]
+    , ["./cmd_parse_unitest --recycle-bits 6", "0"]
+    , ["./cmd_parse_unitest --recycle-bits --kernel table", "1"]
+    , ["./cmd_parse_unitest --recycle-bits --pity-curve curve.txt --shm seg --time-budget 3 -n 1 -c 3 --perf-stats", "1"]
+    , ["./cmd_parse_unitest --recycle-bits --instant --standard", "1"]
+    , ["./cmd_parse_unitest --recycle-bits --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --recycle-bits --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --recycle-bits --rarity", "0"]
+    , ["./cmd_parse_unitest --recycle-bits --trace trace.bin", "0"]
+    , ["./cmd_parse_unitest --recycle-bits --pipeline", "0"]
+    , ["./cmd_parse_unitest --recycle-bits --strategy 300", "0"]
+    , ["./cmd_parse_unitest --recycle-bits --analyze pulls.log", "0"]
+
+    # Test cases for --sensitivity
+    , ["./cmd_parse_unitest --sensitivity", "1"]
+    , ["./cmd_parse_unitest --sensitivity 3", "0"]
+    , ["./cmd_parse_unitest --sensitivity --shm seg --time-budget 3 --standard -n 1 -c 3 -p 20 --perf-stats", "1"]
+    , ["./cmd_parse_unitest --sensitivity --kernel table", "0"]
+    , ["./cmd_parse_unitest --sensitivity --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --sensitivity --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --sensitivity --rarity", "0"]
+    , ["./cmd_parse_unitest --sensitivity --trace trace.bin", "0"]
+    , ["./cmd_parse_unitest --sensitivity --pipeline", "0"]
+    , ["./cmd_parse_unitest --sensitivity --strategy 300", "0"]
+    , ["./cmd_parse_unitest --sensitivity --analyze pulls.log", "0"]
+    , ["./cmd_parse_unitest --sensitivity --pity-curve curve.txt", "0"]
+    , ["./cmd_parse_unitest --sensitivity --instant", "0"]
+    , ["./cmd_parse_unitest --sensitivity --recycle-bits", "0"]
+
+    # Test cases for --control-variates
+    , ["./cmd_parse_unitest --control-variates", "1"]
+    , ["./cmd_parse_unitest --control-variates 3", "0"]
+    , ["./cmd_parse_unitest --control-variates --control-variates", "0"]
+    , ["./cmd_parse_unitest --control-variates --shm seg --time-budget 3 --standard -n 1 -c 3 -p 20 --perf-stats", "1"]
+    , ["./cmd_parse_unitest --control-variates --pity-curve curve.txt -c 3", "1"]
+    , ["./cmd_parse_unitest --control-variates --kernel table", "0"]
+    , ["./cmd_parse_unitest --control-variates --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --control-variates --all-current-pull", "0"]
+    , ["./cmd_parse_unitest --control-variates --rarity", "0"]
+    , ["./cmd_parse_unitest --control-variates --trace trace.bin", "0"]
+    , ["./cmd_parse_unitest --control-variates --pipeline", "0"]
+    , ["./cmd_parse_unitest --control-variates --strategy 300", "0"]
+    , ["./cmd_parse_unitest --control-variates --analyze pulls.log", "0"]
+    , ["./cmd_parse_unitest --control-variates --instant", "0"]
+    , ["./cmd_parse_unitest --control-variates --recycle-bits", "0"]
+    , ["./cmd_parse_unitest --control-variates --sensitivity", "0"]
+
+    # Test cases for --worker
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650", "1"]
+    , ["./cmd_parse_unitest --worker [::1]:7650 --standard -n 1 -c 3 --kernel table --recycle-bits", "1"]
+    , ["./cmd_parse_unitest --worker", "0"]
+    , ["./cmd_parse_unitest --worker localhost", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:0", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:70000", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --worker 127.0.0.1:7651", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 127.0.0.1:7651", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 -t 5", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --perf-stats", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --bootstrap 100", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --time-budget 3", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --trace trace.bin", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --pipeline", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --shm seg", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --analyze pulls.log", "0"]
+    , ["./cmd_parse_unitest --worker 127.0.0.1:7650 --control-variates", "0"]
+
+    # Test cases for --isa, scalar is supported by every CPU
+    , ["./cmd_parse_unitest --isa scalar", "1"]
+    , ["./cmd_parse_unitest --isa scalar --kernel branchless -t 20 -n 1 -c 3", "1"]
+    , ["./cmd_parse_unitest --isa scalar --kernel-info", "1"]
+    , ["./cmd_parse_unitest --isa scalar --worker 127.0.0.1:7650", "1"]
+    , ["./cmd_parse_unitest --isa", "0"]
+    , ["./cmd_parse_unitest --isa avx", "0"]
+    , ["./cmd_parse_unitest --isa scalar avx2", "0"]
+    , ["./cmd_parse_unitest --isa scalar --isa scalar", "0"]
 ]
 
 if __name__ == "__main__":
@@ -0,0 +1,64 @@
+#!/usr/bin/python3.6
+import subprocess
+import os
+
+path = os.path.dirname(os.path.realpath(__file__))
+log_path = os.path.join(path, "test_pull_log.txt")
+executable = os.path.join(path, "..", "simulation_sequential")
+
+# test cases: a list of ["content of the pull log", {"keyword": "expect_values"}]
+test_case = [["", {"Players: ": "0", "Malformed lines: ": "0"}]
+    , ["alice 10 20 30\n", {"Players: ": "1", "Target star 6 times: ": "3", "Pulling times: ": "60"}]
+    , ["alice 10 20 30", {"Players: ": "1", "Pulling times: ": "60"}]
+    , ["alice 10\nbob 20\n", {"Players: ": "2", "Pulling times: ": "30"}]
+    , ["alice,10,20\r\nbob\t5\t6\r\n", {"Players: ": "2", "Pulling times: ": "41", "Malformed lines: ": "0"}]
+    , ["# comment\n\n   \nalice 10\n", {"Players: ": "1", "Malformed lines: ": "0"}]
+    , ["alice 0\n", {"Players: ": "0", "Malformed lines: ": "1"}]
+    , ["alice x\n", {"Players: ": "0", "Malformed lines: ": "1"}]
+    , ["alice 10x\n", {"Players: ": "0", "Malformed lines: ": "1"}]
+    , ["alice\n", {"Players: ": "0", "Malformed lines: ": "1"}]
+    , ["alice -10\n", {"Players: ": "0", "Malformed lines: ": "1"}]
+    , ["alice 1234567890\n", {"Players: ": "0", "Malformed lines: ": "1"}]
+    , ["alice 10\nbob 0\ncarol 30\n", {"Players: ": "2", "Pulling times: ": "40", "Malformed lines: ": "1"}]
+    # A lucky player and an unlucky player
+    , ["lucky 1 1 1\nunlucky 900\n", {"The luckiest players:\n\tPlayer \"": "l", "The unluckiest players:\n\tPlayer \"": "u"}]
+]
+
+if __name__ == "__main__":
+
+    # Run all test cases
+    failed_case_index = []
+    for i in range(len(test_case)):
+        print("Test Case {case_num}".format(case_num=i))
+        with open(log_path, "w") as f:
+            f.write(test_case[i][0])
+        proc = subprocess.run(
+            [executable, "--analyze", log_path], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        output = proc.stdout.decode()
+        passed = True
+        for keyword, expect in test_case[i][1].items():
+            index = output.find(keyword)
+            result = output[index + len(keyword):].split()[0] if index != -1 else None
+            if keyword.endswith("\""):
+                result = result[0] if result else None
+            print("Case {case_num}: {keyword}{result}, expect {expect}".format(
+                case_num=i, keyword=keyword.strip(), result=result, expect=expect), end=", ")
+            if result != expect:
+                passed = False
+        if not passed:
+            print("Case failed!")
+            failed_case_index.append(i)
+        else:
+            print("Pass")
+    os.remove(log_path)
+
+    if failed_case_index:
+        print("Some test cases failed")
+        print("Failed test cases are:")
+        for i in failed_case_index:
+            print(repr(test_case[i][0]))
+
+        print("Please fix the bug(s)")
+    else:
+        print()
+        print("All test cases passed")
@@ -0,0 +1,154 @@
+#!/usr/bin/python3.6
+import subprocess
+import signal
+import time
+import os
+
+path = os.path.dirname(os.path.realpath(__file__))
+simulation = os.path.join(path, "..", "simulation_sequential")
+coordinator = os.path.join(path, "..", "simulation_coordinator")
+
+# The results that must not depend on the workers that ran the chunks
+result_keywords = ["Pulls completed: ", "Star 6 times: ", "Target star 6 times: ", "Rare events happend "]
+
+
+# Return the first word after keyword in output, or None
+def find_value(output, keyword):
+    index = output.find(keyword)
+    return output[index + len(keyword):].split()[0] if index != -1 else None
+
+
+# Start a coordinator and return it with the address that it listens to
+def start_coordinator(args):
+    proc = subprocess.Popen([coordinator] + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    address = None
+    for line in proc.stdout:
+        address = find_value(line, "Listening Address: ")
+        if address is not None:
+            break
+    return proc, address
+
+
+def start_worker(address, args=[]):
+    return subprocess.Popen([simulation, "--worker", address] + args, stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE)
+
+
+# Run a coordinator with the given workers, and return the output of the coordinator and the
+# exit codes of the workers. disturb is called with the workers after they started
+def run_simulation(coordinator_args, worker_args, disturb=None):
+    proc, address = start_coordinator(coordinator_args)
+    workers = []
+    for args in worker_args:
+        workers.append(start_worker(address, args))
+        # The first worker decides the banner settings
+        time.sleep(0.1)
+    if disturb is not None:
+        disturb(workers)
+    output = proc.communicate(timeout=120)[0]
+    codes = []
+    for worker in workers:
+        # Resume a stopped worker, which then finds the coordinator gone
+        worker.send_signal(signal.SIGCONT)
+        try:
+            worker.communicate(timeout=10)
+        except subprocess.TimeoutExpired:
+            worker.kill()
+            worker.communicate()
+        codes.append(worker.returncode)
+    return output, codes
+
+
+def kill_worker(workers):
+    time.sleep(0.2)
+    workers[0].send_signal(signal.SIGKILL)
+
+
+def stop_worker(workers):
+    time.sleep(0.2)
+    workers[0].send_signal(signal.SIGSTOP)
+
+
+def compare_results(output, expect_output):
+    passed = True
+    for keyword in result_keywords:
+        result = find_value(output, keyword)
+        expect = find_value(expect_output, keyword)
+        print("{keyword}{result}, expect {expect}".format(keyword=keyword.strip(), result=result, expect=expect),
+              end=", ")
+        if result is None or result != expect:
+            passed = False
+    return passed
+
+
+if __name__ == "__main__":
+
+    failed_case = []
+    coordinator_args = ["-t", "200000000", "--chunk-pull-time", "4194304", "--seed", "7"]
+
+    # Case 0: a single worker gives the reference results of the seed, and the pulls of -t although
+    # they are not a multiple of the chunk
+    expect_output, codes = run_simulation(coordinator_args, [[]])
+    passed = codes == [0] and find_value(expect_output, "Chunks merged: ") == "47" and \
+        find_value(expect_output, "Pulls completed: ") == coordinator_args[1]
+    print("Case 0: one worker, exit codes {codes}".format(codes=codes), end=", ")
+    print("Pass" if passed else "Case failed!")
+    if not passed:
+        failed_case.append("one worker")
+
+    # Case 1: a killed worker loses its chunk, which another worker runs with the same seed
+    output, codes = run_simulation(coordinator_args, [[], [], []], kill_worker)
+    print("Case 1: three workers, one of them killed, exit codes {codes}".format(codes=codes), end=", ")
+    passed = compare_results(output, expect_output) and codes[1:] == [0, 0] and \
+        find_value(output, "Leases reissued: ") not in [None, "0"]
+    print("Pass" if passed else "Case failed!")
+    if not passed:
+        failed_case.append("three workers, one of them killed")
+
+    # Case 2: the lease of a stopped worker expires and its chunk is leased again
+    output, codes = run_simulation(coordinator_args + ["--lease-timeout", "1"], [[], []], stop_worker)
+    print("Case 2: two workers, one of them stopped, exit codes {codes}".format(codes=codes), end=", ")
+    passed = compare_results(output, expect_output) and codes[1] == 0 and \
+        find_value(output, "Leases reissued: ") not in [None, "0"]
+    print("Pass" if passed else "Case failed!")
+    if not passed:
+        failed_case.append("two workers, one of them stopped")
+
+    # Case 3: a worker with other banner settings or another random stream is rejected, the others
+    # still finish
+    output, codes = run_simulation(coordinator_args, [[], ["--standard"], ["--kernel", "lanes"], ["--recycle-bits"],
+                                                      ["--kernel", "table"]])
+    print("Case 3: workers with other banner settings, exit codes {codes}".format(codes=codes), end=", ")
+    passed = compare_results(output, expect_output) and codes == [0, 1, 1, 1, 0]
+    print("Pass" if passed else "Case failed!")
+    if not passed:
+        failed_case.append("a worker with other banner settings")
+
+    # Invalid arguments of the coordinator and a missing coordinator are reported with a non-zero
+    # exit code
+    test_case = [[coordinator, "--lease-timeout", "0"], [coordinator, "--chunk-pull-time", "x"],
+                 [coordinator, "--chunk-pull-time", "1048575"],
+                 [coordinator, "--listen", "localhost"], [coordinator, "--seed", "-1"], [coordinator, "-t"],
+                 [coordinator, "-t", "1", "--total-pull-time", "2"], [coordinator, "--bogus", "1"],
+                 [simulation, "--worker", "127.0.0.1:1"]]
+    for i in range(len(test_case)):
+        proc = subprocess.run(test_case[i], stdout=subprocess.PIPE, stderr=subprocess.PIPE, timeout=10)
+        print("Case {case_num}: {args}, exit code {code}, expect non-zero".format(
+            case_num=i + 4, args=test_case[i][1:], code=proc.returncode), end=", ")
+        if proc.returncode == 0:
+            print("Case failed!")
+            failed_case.append(repr(test_case[i][1:]))
+        else:
+            print("Pass")
+
+    if failed_case:
+        print("Some test cases failed")
+        print("Failed test cases are:")
+        for case in failed_case:
+            print(case)
+
+        print("Please fix the bug(s)")
+    else:
+        print()
+        print("All test cases passed")
@@ -0,0 +1,62 @@
+#!/usr/bin/python3.6
+import subprocess
+import os
+
+path = os.path.dirname(os.path.realpath(__file__))
+simulation = os.path.join(path, "..", "simulation_sequential")
+peek = os.path.join(path, "..", "simulation_peek")
+segment_name = "arknights_test_simulation_peek_{pid}".format(pid=os.getpid())
+
+
+# Return the first word after keyword in output, or None
+def find_value(output, keyword):
+    index = output.find(keyword)
+    return output[index + len(keyword):].split()[0] if index != -1 else None
+
+
+if __name__ == "__main__":
+
+    failed_case = []
+
+    # The final snapshot must match the results that the simulation prints
+    proc = subprocess.run(
+        [simulation, "-t", "10000000", "--shm", segment_name], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    simulation_output = proc.stdout.decode()
+    proc = subprocess.run([peek, segment_name], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    peek_output = proc.stdout.decode()
+    print("Case 0: peek the finished simulation, exit code {code}".format(code=proc.returncode), end=", ")
+    passed = proc.returncode == 0 and find_value(peek_output, "Status: ") == "finished"
+    for keyword in ["Pulls completed: ", "Star 6 times: ", "Target star 6 times: ", "Rare events happend "]:
+        result = find_value(peek_output, keyword)
+        expect = find_value(simulation_output, keyword)
+        print("{keyword}{result}, expect {expect}".format(keyword=keyword.strip(), result=result, expect=expect),
+              end=", ")
+        if result is None or result != expect:
+            passed = False
+    print("Pass" if passed else "Case failed!")
+    if not passed:
+        failed_case.append("peek the finished simulation")
+    os.remove(os.path.join("/dev/shm", segment_name))
+
+    # Invalid names and missing segments are reported with a non-zero exit code
+    test_case = [[peek, segment_name], [peek, "../passwd"], [peek, ""], [peek], [peek, "a", "b"]]
+    for i in range(len(test_case)):
+        proc = subprocess.run(test_case[i], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        print("Case {case_num}: {args}, exit code {code}, expect non-zero".format(
+            case_num=i + 1, args=test_case[i][1:], code=proc.returncode), end=", ")
+        if proc.returncode == 0:
+            print("Case failed!")
+            failed_case.append(repr(test_case[i][1:]))
+        else:
+            print("Pass")
+
+    if failed_case:
+        print("Some test cases failed")
+        print("Failed test cases are:")
+        for case in failed_case:
+            print(case)
+
+        print("Please fix the bug(s)")
+    else:
+        print()
+        print("All test cases passed")
@@ -0,0 +1,98 @@
+#!/usr/bin/python3.6
+import subprocess
+import os
+
+path = os.path.dirname(os.path.realpath(__file__))
+simulation = os.path.join(path, "..", "simulation_sequential")
+reader = os.path.join(path, "..", "simulation_trace")
+trace_path = os.path.join(path, "test_simulation_trace_{pid}.trace".format(pid=os.getpid()))
+truncated_path = trace_path + ".truncated"
+
+
+# Return the first word after keyword in output, or None
+def find_value(output, keyword):
+    index = output.find(keyword)
+    return output[index + len(keyword):].split()[0] if index != -1 else None
+
+
+if __name__ == "__main__":
+
+    failed_case = []
+
+    # The statistics of the trace must match the results that the simulation
+    # prints, with -c carried in the header
+    proc = subprocess.run(
+        [simulation, "-t", "10000000", "-c", "30", "--trace", trace_path], stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE)
+    simulation_output = proc.stdout.decode()
+    proc = subprocess.run([reader, trace_path], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    reader_output = proc.stdout.decode()
+    print("Case 0: read the trace, exit code {code}".format(code=proc.returncode), end=", ")
+    passed = proc.returncode == 0 and find_value(reader_output, "Current pull of every trial: ") == "30"
+    for keyword in ["Random seed for this simulation: ", "Star 6 times: ", "Target star 6 times: "]:
+        result = find_value(reader_output, keyword)
+        expect = find_value(simulation_output, keyword)
+        print("{keyword}{result}, expect {expect}".format(keyword=keyword.strip(), result=result, expect=expect),
+              end=", ")
+        if result is None or result != expect:
+            passed = False
+    print("Pass" if passed else "Case failed!")
+    if not passed:
+        failed_case.append("read the trace")
+
+    # Every finished trial of the dump must add up to its pulls
+    proc = subprocess.run([reader, trace_path, "--dump"], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    lines = proc.stdout.decode().splitlines()
+    passed = proc.returncode == 0 and len(lines) > 0
+    for line in lines:
+        pulls, runs = line.split(":")
+        passed = passed and (pulls.endswith("?") or int(pulls) == sum(int(run) for run in runs.split()))
+    print("Case 1: dump the trace, {num} trials, {result}".format(
+        num=len(lines), result="Pass" if passed else "Case failed!"))
+    if not passed:
+        failed_case.append("dump the trace")
+
+    # Missing, foreign and truncated traces are reported with a non-zero
+    # exit code
+    with open(trace_path, "rb") as trace_file:
+        content = trace_file.read()
+    with open(truncated_path, "wb") as truncated_file:
+        # Cut the trace right after the last byte that continues a varint,
+        # i.e., in the middle of the run of a trial longer than 63 pulls
+        cut = max(i for i in range(len(content)) if content[i] & 0x80)
+        truncated_file.write(content[:cut + 1])
+    test_case = [[reader, trace_path + ".missing"], [reader, simulation], [reader, truncated_path],
+                 [reader], [reader, trace_path, "--all"]]
+    for i in range(len(test_case)):
+        proc = subprocess.run(test_case[i], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        print("Case {case_num}: {args}, exit code {code}, expect non-zero".format(
+            case_num=i + 2, args=test_case[i][1:], code=proc.returncode), end=", ")
+        if proc.returncode == 0:
+            print("Case failed!")
+            failed_case.append(repr(test_case[i][1:]))
+        else:
+            print("Pass")
+    os.remove(trace_path)
+    os.remove(truncated_path)
+
+    # The simulation fails before it starts if the trace cannot be created
+    proc = subprocess.run([simulation, "-t", "1000", "--trace", os.path.join(path, "missing_dir", "trace")],
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    print("Case {case_num}: uncreatable trace, exit code {code}, expect non-zero".format(
+        case_num=len(test_case) + 2, code=proc.returncode), end=", ")
+    if proc.returncode == 0:
+        print("Case failed!")
+        failed_case.append("uncreatable trace")
+    else:
+        print("Pass")
+
+    if failed_case:
+        print("Some test cases failed")
+        print("Failed test cases are:")
+        for case in failed_case:
+            print(case)
+
+        print("Please fix the bug(s)")
+    else:
+        print()
+        print("All test cases passed")
@@ -4,19 +4,35 @@
 #include <assert.h>
 #include <time.h>
 
-#include <algorithm>  // min
+#include <algorithm>  // min, find
 #include <cctype>     // isdigit
 #include <iostream>
 #include <random>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "bootstrap.h"
+#include "chunk_lease.h"
+#include "control_variate.h"
+#include "current_pull_table.h"
 #include "error_flag.h"
+#include "instant_table.h"
+#include "perf_counter.h"
+#include "pity_curve.h"
+#include "pull_pipeline.h"
+#include "pull_trace.h"
 #include "probability_wrapper.h"
+#include "pull_log_analyzer.h"
+#include "rarity_model.h"
+#include "run_control.h"
+#include "sensitivity.h"
+#include "shared_result.h"
+#include "simulation_kernel.h"
+#include "simulation_option.h"
+#include "strategy_solver.h"
 
 // Pre-defined parameters for Arknights
-const double limited_banner_on_banner_star6_conditional_rate = 0.7;
-const double standard_banner_on_banner_star6_conditional_rate = 0.5;
 // Numbers of pulls that you are guaranteed to get a star6 operator
 // it is equals to (100% - 2%)/2%
 //      ~~~~~~~~~~~~~^     ^   ^~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -81,7 +97,7 @@ uint_fast64_t get_random_seed() {
 
 // Display the help message
 void display_help_message() {
-  std::cout << "Usage: [--help] [-t|--total-pull-time <value>] [--standard|--limited] [-p|--pity <value>] [-n|--num-rate-up <value>] [-c|--current-pull <value>]\n\n"
+  std::cout << "Usage: [--help] [-t|--total-pull-time <value>] [--standard|--limited] [-p|--pity <value>] [-n|--num-rate-up <value>] [-c|--current-pull <value>] [--perf-stats] [--kernel <name>] [--analyze <file>] [--bootstrap <value>] [--all-current-pull] [--kernel-info] [--rarity] [--time-budget <value>] [--shm <name>] [--strategy <value>] [--strategy-targets <value>] [--pity-curve <file>] [--trace <file>] [--pipeline] [--instant] [--recycle-bits] [--sensitivity] [--control-variates] [--worker <address>] [--isa <name>]\n\n"
                "--help : Display the help message\n"
                "-t|--total-pull-time : Set the time of pulling in a simulation\n"
                "                        Valid value is an integer between [1, 18446744073709551615] (inclusive) on Linux 64bit/C++11\n"
@@ -101,6 +117,99 @@ void display_help_message() {
                "                        The valid values are 1 and 2\n"
                "    -c|--current-pull : Set how many times that you have already pulled without getting a star-6 operator\n"
                "                        Valid value is an integer between [0, <-p|--pity value> + 49) (inclusive, exclusive)\n"
+               "         --perf-stats : Count the hardware events (cycles, instructions, branch-misses, cache-misses)\n"
+               "                        during the simulation and report IPC, misses per pull and ns per pull\n"
+               "                        Note: Requires perf_event_open, the counters may be unavailable in a container\n"
+               "             --kernel : Select the kernel that runs the simulation loop\n"
+               "                        Valid values are branchy (default), branchless, table and lanes\n"
+               "                        Note: All kernels but lanes produce identical results for the same random seed,\n"
+               "                              lanes deals the pulls to 16 trials in turn\n"
+               "            --analyze : Analyze the pull log of real players instead of running a simulation\n"
+               "                        Each line of the log is \"<player id> <pulls of trial 1> ... <pulls of trial k>\",\n"
+               "                        i.e., how many pulls the player spent to get each copy of the target star 6 operator\n"
+               "                        Reports how lucky each player is under the banner settings given by other arguments\n"
+               "          --bootstrap : Report a 95% confidence interval next to each estimated probability, calculated from\n"
+               "                        the given number of bootstrap resamples of the batches of the simulation\n"
+               "                        Valid value is an integer between [1, 100000]\n"
+               "   --all-current-pull : Report the distribution of the pulls to get the target star 6 operator for every\n"
+               "                        valid value of -c|--current-pull (at most 1000 values) in a single run\n"
+               "                        Cannot be specified with -c|--current-pull, --kernel, --bootstrap or --analyze\n"
+               "        --kernel-info : Print the instruction set variants of the kernels (scalar, sse4.2, avx2, avx512),\n"
+               "                        the ones supported by this CPU and the selected one, then exit\n"
+               "             --rarity : Also report the distribution of every outcome of a pull (the target, the other\n"
+               "                        rate-up and the off-banner star 6 operators, star 5, star 4 and star 3 operators)\n"
+               "                        Cannot be specified with --kernel, --bootstrap, --all-current-pull or --analyze\n"
+               "        --time-budget : Simulate until the given number of seconds have passed instead of a fixed number of\n"
+               "                        pulls, and report the pulls actually done with the usual results\n"
+               "                        Valid value is an integer between [1, 31536000]\n"
+               "                        Cannot be specified with -t|--total-pull-time or --bootstrap\n"
+               "                        Note: SIGINT (Ctrl+C) and SIGTERM also stop any simulation cleanly and still report\n"
+               "                              the results of the pulls done so far\n"
+               "                --shm : Publish the live results into the POSIX shared memory segment /<name> during the\n"
+               "                        simulation, which ./simulation_peek <name> renders\n"
+               "                        Valid value is a name of at most 200 letters, digits, '_', '-' or '.'\n"
+               "                        Cannot be specified with --bootstrap or --analyze\n"
+               "           --strategy : Solve when to keep pulling on the current banner and when to save the rest of the\n"
+               "                        given budget of pulls for the next banner, starting from -c|--current-pull, and\n"
+               "                        evaluate the strategy with -t|--total-pull-time simulated pulls\n"
+               "                        Valid value is an integer between [1, 100000]\n"
+               "                        Cannot be specified with --kernel, --bootstrap, --all-current-pull, --rarity,\n"
+               "                        --analyze, --time-budget or --shm\n"
+               "   --strategy-targets : Set the copies of the target star 6 operator wanted on each banner for --strategy\n"
+               "                        Valid value is an integer between [1, 6], the default value is 1\n"
+               "         --pity-curve : Load the probability of getting a star 6 operator after every number of failed\n"
+               "                        pulls from a file instead of the built-in pity rule, and run the table kernel\n"
+               "                        (or the lanes kernel with --kernel lanes)\n"
+               "                        Each line of the file is \"<pity counter> <probability>\", e.g., \"0 0.02\", and a\n"
+               "                        point holds until the next one. -c|--current-pull must be a reachable pity counter\n"
+               "                        Cannot be specified with -p|--pity, --all-current-pull, --rarity or --kernel other\n"
+               "                        than table or lanes\n"
+               "              --trace : Record every star 6 operator of every trial into a compact binary trace file,\n"
+               "                        which ./simulation_trace <file> streams back\n"
+               "                        Cannot be specified with --kernel, --bootstrap, --all-current-pull, --rarity,\n"
+               "                        --strategy or --analyze\n"
+               "           --pipeline : Draw the random numbers on a producer thread and run the kernel on them on this\n"
+               "                        thread, which pays off if the two threads get separate cores or hyperthreads\n"
+               "                        Note: The results are identical to the ones without --pipeline for the same seed\n"
+               "                        Cannot be specified with --bootstrap, --all-current-pull, --rarity, --trace,\n"
+               "                        --strategy or --analyze\n"
+               "            --instant : Print the exact probabilities of a default banner (--standard|--limited, -n 1 or 2,\n"
+               "                        any -c|--current-pull) from the tables built into the program without simulating,\n"
+               "                        and run the simulation as usual for other settings\n"
+               "                        Cannot be specified with --bootstrap, --all-current-pull, --rarity, --trace,\n"
+               "                        --strategy, --analyze or --pity-curve\n"
+               "       --recycle-bits : Draw 6 pulls from every output of the random number generator instead of one,\n"
+               "                        by splitting it into exactly uniform digits in [0, 999]\n"
+               "                        Note: The results differ from the ones without --recycle-bits for the same seed,\n"
+               "                        but follow exactly the same distribution\n"
+               "                        Cannot be specified with --bootstrap, --all-current-pull, --rarity, --trace,\n"
+               "                        --pipeline, --strategy or --analyze\n"
+               "        --sensitivity : Also estimate the derivatives of every Pr(S_i) and Pr(W_i) by the base star 6\n"
+               "                        rate, the raise of the pity system and the conditional rate of the banner from\n"
+               "                        the trials of the same simulation (score function method), with their standard\n"
+               "                        errors\n"
+               "                        Cannot be specified with --kernel, --bootstrap, --all-current-pull, --rarity,\n"
+               "                        --trace, --pipeline, --strategy, --analyze, --pity-curve, --instant or\n"
+               "                        --recycle-bits\n"
+               "   --control-variates : Also correct every Pr(S_i) and Pr(W_i) by the deviation of the pulls and the star 6\n"
+               "                        operators per trial from their exact means, and report the standard errors and\n"
+               "                        the share of the variance that is left, i.e., of the pulls needed for the same\n"
+               "                        precision\n"
+               "                        Cannot be specified with --kernel, --bootstrap, --all-current-pull, --rarity,\n"
+               "                        --trace, --pipeline, --strategy, --analyze, --instant, --recycle-bits or\n"
+               "                        --sensitivity\n"
+               "             --worker : Simulate the chunks of pulls that ./simulation_coordinator listening at the given\n"
+               "                        address leases, and send their results back instead of running a simulation of\n"
+               "                        our own. Every worker of a coordinator must use the same banner settings, and\n"
+               "                        either all or none of them --kernel lanes and --recycle-bits\n"
+               "                        Valid value is \"<host>:<port>\", e.g., 127.0.0.1:7650\n"
+               "                        Cannot be specified with -t|--total-pull-time, --perf-stats, --bootstrap,\n"
+               "                        --all-current-pull, --rarity, --time-budget, --shm, --strategy, --trace,\n"
+               "                        --pipeline, --instant, --sensitivity, --control-variates or --analyze\n"
+               "                --isa : Run the kernels with the given instruction set variant instead of the most\n"
+               "                        advanced one that this CPU supports, e.g., when another one is faster on it\n"
+               "                        Valid value is a variant that this CPU supports, see --kernel-info\n"
+               "                        Note: Every variant produces identical results for the same random seed\n"
                "Note that the order of these arguments does not matter.\n"
                << std::endl;
 
@@ -148,6 +257,48 @@ void display_error_detail(const ErrorFlag& error_flag) {
     if (error_flag.err_conflict_ctrl_arg_flag) {
       std::cerr << "\tConflict arguments: \"--standard\" and \"--limited\" are specified at the same time\n";
     }
+    if (error_flag.err_conflict_all_current_pull_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--all-current-pull\" cannot be specified with \"-c\", \"--current-pull\", \"--kernel\", \"--bootstrap\" or \"--analyze\"\n";
+    }
+    if (error_flag.err_conflict_rarity_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--rarity\" cannot be specified with \"--kernel\", \"--bootstrap\", \"--all-current-pull\" or \"--analyze\"\n";
+    }
+    if (error_flag.err_conflict_time_budget_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--time-budget\" cannot be specified with \"-t\", \"--total-pull-time\" or \"--bootstrap\"\n";
+    }
+    if (error_flag.err_conflict_shm_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--shm\" cannot be specified with \"--bootstrap\" or \"--analyze\"\n";
+    }
+    if (error_flag.err_conflict_strategy_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--strategy\" cannot be specified with \"--kernel\", \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--analyze\", \"--time-budget\" or \"--shm\"\n";
+    }
+    if (error_flag.err_strategy_targets_without_strategy) {
+      std::cerr << "\t\"--strategy-targets\" is specified without \"--strategy\"\n";
+    }
+    if (error_flag.err_conflict_pity_curve_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--pity-curve\" cannot be specified with \"-p\", \"--pity\", \"--all-current-pull\", \"--rarity\" or \"--kernel\" other than table or lanes\n";
+    }
+    if (error_flag.err_conflict_trace_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--trace\" cannot be specified with \"--kernel\", \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--strategy\" or \"--analyze\"\n";
+    }
+    if (error_flag.err_conflict_pipeline_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--pipeline\" cannot be specified with \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--trace\", \"--strategy\" or \"--analyze\"\n";
+    }
+    if (error_flag.err_conflict_instant_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--instant\" cannot be specified with \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--trace\", \"--strategy\", \"--analyze\" or \"--pity-curve\"\n";
+    }
+    if (error_flag.err_conflict_recycle_bits_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--recycle-bits\" cannot be specified with \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--trace\", \"--pipeline\", \"--strategy\" or \"--analyze\"\n";
+    }
+    if (error_flag.err_conflict_sensitivity_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--sensitivity\" cannot be specified with \"--kernel\", \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--trace\", \"--pipeline\", \"--strategy\", \"--analyze\", \"--pity-curve\", \"--instant\" or \"--recycle-bits\"\n";
+    }
+    if (error_flag.err_conflict_control_variates_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--control-variates\" cannot be specified with \"--kernel\", \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--trace\", \"--pipeline\", \"--strategy\", \"--analyze\", \"--instant\", \"--recycle-bits\" or \"--sensitivity\"\n";
+    }
+    if (error_flag.err_conflict_worker_ctrl_arg) {
+      std::cerr << "\tConflict arguments: \"--worker\" cannot be specified with \"-t|--total-pull-time\", \"--perf-stats\", \"--bootstrap\", \"--all-current-pull\", \"--rarity\", \"--time-budget\", \"--shm\", \"--strategy\", \"--trace\", \"--pipeline\", \"--instant\", \"--sensitivity\", \"--control-variates\" or \"--analyze\"\n";
+    }
     // Missing detail value
     if (error_flag.err_missing_value_for_total_pull_time_ctrl_arg) {
       std::cerr << "\tMissing value for \"-t\"\n";
@@ -173,6 +324,39 @@ void display_error_detail(const ErrorFlag& error_flag) {
     if (error_flag.err_missing_value_for_current_pull_long_name_ctrl_arg) {
       std::cerr << "\tMissing value for \"--current-pull\"\n";
     }
+    if (error_flag.err_missing_value_for_kernel_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--kernel\"\n";
+    }
+    if (error_flag.err_missing_value_for_analyze_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--analyze\"\n";
+    }
+    if (error_flag.err_missing_value_for_bootstrap_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--bootstrap\"\n";
+    }
+    if (error_flag.err_missing_value_for_time_budget_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--time-budget\"\n";
+    }
+    if (error_flag.err_missing_value_for_shm_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--shm\"\n";
+    }
+    if (error_flag.err_missing_value_for_strategy_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--strategy\"\n";
+    }
+    if (error_flag.err_missing_value_for_strategy_targets_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--strategy-targets\"\n";
+    }
+    if (error_flag.err_missing_value_for_pity_curve_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--pity-curve\"\n";
+    }
+    if (error_flag.err_missing_value_for_trace_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--trace\"\n";
+    }
+    if (error_flag.err_missing_value_for_worker_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--worker\"\n";
+    }
+    if (error_flag.err_missing_value_for_isa_ctrl_arg) {
+      std::cerr << "\tMissing value for \"--isa\"\n";
+    }
     // Invalid value
     if (error_flag.err_invalid_value_for_total_pull_time_ctrl_arg) {
       std::cerr << "\tInvalid value for \"-t\" - it must be a positive integer\n";
@@ -198,6 +382,39 @@ void display_error_detail(const ErrorFlag& error_flag) {
     if (error_flag.err_invalid_value_for_current_pull_long_name_ctrl_arg) {
       std::cerr << "\tInvalid value for \"--current-pull\" - it must be an integer between [0, <-p|--pity value> + 49) (inclusive, exclusive)\n";
     }
+    if (error_flag.err_invalid_value_for_kernel_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--kernel\" - it must be branchy, branchless, table or lanes\n";
+    }
+    if (error_flag.err_invalid_value_for_analyze_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--analyze\" - it must be a single file path\n";
+    }
+    if (error_flag.err_invalid_value_for_bootstrap_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--bootstrap\" - it must be an integer between [1, 100000]\n";
+    }
+    if (error_flag.err_invalid_value_for_time_budget_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--time-budget\" - it must be an integer between [1, 31536000]\n";
+    }
+    if (error_flag.err_invalid_value_for_shm_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--shm\" - it must be a single name of at most 200 letters, digits, '_', '-' or '.'\n";
+    }
+    if (error_flag.err_invalid_value_for_strategy_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--strategy\" - it must be an integer between [1, 100000]\n";
+    }
+    if (error_flag.err_invalid_value_for_strategy_targets_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--strategy-targets\" - it must be an integer between [1, 6]\n";
+    }
+    if (error_flag.err_invalid_value_for_pity_curve_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--pity-curve\" - it must be a single file\n";
+    }
+    if (error_flag.err_invalid_value_for_trace_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--trace\" - it must be a single file\n";
+    }
+    if (error_flag.err_invalid_value_for_worker_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--worker\" - it must be a single \"<host>:<port>\" address with a port between [1, 65535]\n";
+    }
+    if (error_flag.err_invalid_value_for_isa_ctrl_arg) {
+      std::cerr << "\tInvalid value for \"--isa\" - it must be an instruction set variant that this CPU supports, see \"--kernel-info\"\n";
+    }
     // Unexpected value
     if (error_flag.err_unexpected_value_for_ctrl_arg_standard) {
       std::cerr << "\tUnexpected value for \"--standard\"\n";
@@ -205,6 +422,33 @@ void display_error_detail(const ErrorFlag& error_flag) {
     if (error_flag.err_unexpected_value_for_ctrl_arg_limited) {
       std::cerr << "\tUnexpected value for \"--limited\"\n";
     }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_perf_stats) {
+      std::cerr << "\tUnexpected value for \"--perf-stats\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_all_current_pull) {
+      std::cerr << "\tUnexpected value for \"--all-current-pull\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_kernel_info) {
+      std::cerr << "\tUnexpected value for \"--kernel-info\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_rarity) {
+      std::cerr << "\tUnexpected value for \"--rarity\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_pipeline) {
+      std::cerr << "\tUnexpected value for \"--pipeline\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_instant) {
+      std::cerr << "\tUnexpected value for \"--instant\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_recycle_bits) {
+      std::cerr << "\tUnexpected value for \"--recycle-bits\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_sensitivity) {
+      std::cerr << "\tUnexpected value for \"--sensitivity\"\n";
+    }
+    if (error_flag.err_unexpected_value_for_ctrl_arg_control_variates) {
+      std::cerr << "\tUnexpected value for \"--control-variates\"\n";
+    }
     std::cerr << "Please check and correct the error(s)\nYou can refer to help message, README, or visit the online repo:\n"
                  "https://github.com/zyLiu6707/Arknights-Gacha-Simulation\n" << std::endl;
 
@@ -221,8 +465,9 @@ void display_error_detail(const ErrorFlag& error_flag) {
 bool process_cmd_input_and_set_corres_var(
     int argc, char* argv[], ProbabilityWrapper& probability_wrapper,
     unsigned long long int& total_pull_time,
-    unsigned int& pity_starting_point, unsigned long long int& current_pull) {
-  const int expected_max_arg_num = 10;
+    unsigned int& pity_starting_point, unsigned long long int& current_pull,
+    SimulationOption& simulation_option) {
+  const int expected_max_arg_num = 39;
   if (argc > expected_max_arg_num) {
     std::cerr << "\nToo many arguments!\n" << std::endl;
     display_help_message();
@@ -238,7 +483,11 @@ bool process_cmd_input_and_set_corres_var(
   // a limited banner, etc. Starts with at lease one dash '-'
   std::unordered_set<std::string> expected_control_arg(
       {"--help", "-t", "--total-pull-time", "--limited", "--standard", "-p",
-       "--pity", "-n", "--num-rate-up", "-c", "--current-pull"});
+       "--pity", "-n", "--num-rate-up", "-c", "--current-pull",
+       "--perf-stats", "--kernel", "--analyze", "--bootstrap",
+       "--all-current-pull", "--kernel-info", "--rarity", "--time-budget", "--shm", "--strategy", "--strategy-targets", "--pity-curve",
+       "--trace", "--pipeline", "--instant", "--recycle-bits",
+       "--sensitivity", "--control-variates", "--worker", "--isa"});
 
   // Store control argument as arg_map's key, and ctrl arg's value as arg_map's
   // value. 
@@ -301,6 +550,17 @@ bool process_cmd_input_and_set_corres_var(
   const auto iter_num_rate_up_long_name = arg_map.find("--num-rate-up");
   const auto iter_current_pull = arg_map.find("-c");
   const auto iter_current_pull_long_name = arg_map.find("--current-pull");
+  const auto iter_kernel = arg_map.find("--kernel");
+  const auto iter_analyze = arg_map.find("--analyze");
+  const auto iter_bootstrap = arg_map.find("--bootstrap");
+  const auto iter_time_budget = arg_map.find("--time-budget");
+  const auto iter_shm = arg_map.find("--shm");
+  const auto iter_strategy = arg_map.find("--strategy");
+  const auto iter_strategy_targets = arg_map.find("--strategy-targets");
+  const auto iter_pity_curve = arg_map.find("--pity-curve");
+  const auto iter_trace = arg_map.find("--trace");
+  const auto iter_worker = arg_map.find("--worker");
+  const auto iter_isa = arg_map.find("--isa");
 
   // Check whether the first argument (i.e., argv[1]) is an unexpected arg
   if (argv[1][0] != '-' || isdigit(argv[1][1])) {
@@ -337,6 +597,142 @@ bool process_cmd_input_and_set_corres_var(
       arg_map.find("--limited") != arg_map.end()) {
     error_flag.err_conflict_ctrl_arg_flag = true;
   }
+  // --all-current-pull replaces -c|--current-pull, runs its own loop and does
+  // not record the batches for the bootstrap
+  if (arg_map.find("--all-current-pull") != arg_map.end() &&
+      (iter_current_pull != arg_map.end() ||
+       iter_current_pull_long_name != arg_map.end() ||
+       iter_kernel != arg_map.end() || iter_bootstrap != arg_map.end() ||
+       iter_analyze != arg_map.end())) {
+    error_flag.err_conflict_all_current_pull_ctrl_arg = true;
+  }
+  // --rarity runs its own lookup table kernel
+  if (arg_map.find("--rarity") != arg_map.end() &&
+      (iter_kernel != arg_map.end() || iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       iter_analyze != arg_map.end())) {
+    error_flag.err_conflict_rarity_ctrl_arg = true;
+  }
+  // --time-budget replaces -t|--total-pull-time, while the batches of the
+  // bootstrap need the number of pulls beforehand
+  if (iter_time_budget != arg_map.end() &&
+      (iter_total_pull_time != arg_map.end() ||
+       iter_total_pull_time_long_name != arg_map.end() ||
+       iter_bootstrap != arg_map.end())) {
+    error_flag.err_conflict_time_budget_ctrl_arg = true;
+  }
+  // The snapshots are published between the chunks of pulls, which the
+  // batches of the bootstrap do not use
+  if (iter_shm != arg_map.end() &&
+      (iter_bootstrap != arg_map.end() || iter_analyze != arg_map.end())) {
+    error_flag.err_conflict_shm_ctrl_arg = true;
+  }
+  // --strategy solves and plays its own model instead of a simulation
+  if (iter_strategy != arg_map.end() &&
+      (iter_kernel != arg_map.end() || iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_analyze != arg_map.end() || iter_time_budget != arg_map.end() ||
+       iter_shm != arg_map.end())) {
+    error_flag.err_conflict_strategy_ctrl_arg = true;
+  }
+  if (iter_strategy_targets != arg_map.end() &&
+      iter_strategy == arg_map.end()) {
+    error_flag.err_strategy_targets_without_strategy = true;
+  }
+  // --pity-curve replaces -p|--pity, and only the table and the lanes
+  // kernels look the thresholds up instead of raising them
+  if (iter_pity_curve != arg_map.end() &&
+      (iter_pity != arg_map.end() || iter_pity_long_name != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       (iter_kernel != arg_map.end() && iter_kernel->second.size() == 1 &&
+        iter_kernel->second[0] != kernel_table &&
+        iter_kernel->second[0] != kernel_lanes))) {
+    error_flag.err_conflict_pity_curve_ctrl_arg = true;
+  }
+  // --trace runs its own kernel in the chunks of pulls
+  if (iter_trace != arg_map.end() &&
+      (iter_kernel != arg_map.end() || iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_strategy != arg_map.end() || iter_analyze != arg_map.end())) {
+    error_flag.err_conflict_trace_ctrl_arg = true;
+  }
+  // --pipeline splits the chunks of pulls of the selected kernel
+  if (arg_map.find("--pipeline") != arg_map.end() &&
+      (iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_trace != arg_map.end() || iter_strategy != arg_map.end() ||
+       iter_analyze != arg_map.end())) {
+    error_flag.err_conflict_pipeline_ctrl_arg = true;
+  }
+  // --instant only answers the plain results of the default banners
+  if (arg_map.find("--instant") != arg_map.end() &&
+      (iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_trace != arg_map.end() || iter_strategy != arg_map.end() ||
+       iter_analyze != arg_map.end() || iter_pity_curve != arg_map.end())) {
+    error_flag.err_conflict_instant_ctrl_arg = true;
+  }
+  // --recycle-bits draws the pulls of the selected kernel from its own
+  // generator
+  if (arg_map.find("--recycle-bits") != arg_map.end() &&
+      (iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_trace != arg_map.end() ||
+       arg_map.find("--pipeline") != arg_map.end() ||
+       iter_strategy != arg_map.end() || iter_analyze != arg_map.end())) {
+    error_flag.err_conflict_recycle_bits_ctrl_arg = true;
+  }
+  // --sensitivity runs its own kernel on the built-in pity rule
+  if (arg_map.find("--sensitivity") != arg_map.end() &&
+      (iter_kernel != arg_map.end() || iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_trace != arg_map.end() ||
+       arg_map.find("--pipeline") != arg_map.end() ||
+       iter_strategy != arg_map.end() || iter_analyze != arg_map.end() ||
+       iter_pity_curve != arg_map.end() ||
+       arg_map.find("--instant") != arg_map.end() ||
+       arg_map.find("--recycle-bits") != arg_map.end())) {
+    error_flag.err_conflict_sensitivity_ctrl_arg = true;
+  }
+  // --control-variates runs its own kernel, on the built-in pity rule or a
+  // pity curve
+  if (arg_map.find("--control-variates") != arg_map.end() &&
+      (iter_kernel != arg_map.end() || iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_trace != arg_map.end() ||
+       arg_map.find("--pipeline") != arg_map.end() ||
+       iter_strategy != arg_map.end() || iter_analyze != arg_map.end() ||
+       arg_map.find("--instant") != arg_map.end() ||
+       arg_map.find("--recycle-bits") != arg_map.end() ||
+       arg_map.find("--sensitivity") != arg_map.end())) {
+    error_flag.err_conflict_control_variates_ctrl_arg = true;
+  }
+  // --worker simulates the chunks that the coordinator leases, whose pulls
+  // and seeds are set by the coordinator
+  if (iter_worker != arg_map.end() &&
+      (iter_total_pull_time != arg_map.end() ||
+       iter_total_pull_time_long_name != arg_map.end() ||
+       arg_map.find("--perf-stats") != arg_map.end() ||
+       iter_bootstrap != arg_map.end() ||
+       arg_map.find("--all-current-pull") != arg_map.end() ||
+       arg_map.find("--rarity") != arg_map.end() ||
+       iter_time_budget != arg_map.end() || iter_shm != arg_map.end() ||
+       iter_strategy != arg_map.end() || iter_trace != arg_map.end() ||
+       arg_map.find("--pipeline") != arg_map.end() ||
+       arg_map.find("--instant") != arg_map.end() ||
+       arg_map.find("--sensitivity") != arg_map.end() ||
+       arg_map.find("--control-variates") != arg_map.end() ||
+       iter_analyze != arg_map.end())) {
+    error_flag.err_conflict_worker_ctrl_arg = true;
+  }
 
   // Check whether missing a specific value for control arguments that expect one,
   // i.e., -t/--total-pull-time, -p/--pity, -n/--num-rate-up and -c/--current-pull
@@ -371,6 +767,53 @@ bool process_cmd_input_and_set_corres_var(
     error_flag.err_missing_value_for_current_pull_long_name_ctrl_arg = true;
   }
 
+  if (iter_kernel != arg_map.cend() && iter_kernel->second.size() == 0) {
+    error_flag.err_missing_value_for_kernel_ctrl_arg = true;
+  }
+
+  if (iter_analyze != arg_map.cend() && iter_analyze->second.size() == 0) {
+    error_flag.err_missing_value_for_analyze_ctrl_arg = true;
+  }
+
+  if (iter_bootstrap != arg_map.cend() && iter_bootstrap->second.size() == 0) {
+    error_flag.err_missing_value_for_bootstrap_ctrl_arg = true;
+  }
+
+  if (iter_time_budget != arg_map.cend() &&
+      iter_time_budget->second.size() == 0) {
+    error_flag.err_missing_value_for_time_budget_ctrl_arg = true;
+  }
+
+  if (iter_shm != arg_map.cend() && iter_shm->second.size() == 0) {
+    error_flag.err_missing_value_for_shm_ctrl_arg = true;
+  }
+
+  if (iter_strategy != arg_map.cend() && iter_strategy->second.size() == 0) {
+    error_flag.err_missing_value_for_strategy_ctrl_arg = true;
+  }
+
+  if (iter_strategy_targets != arg_map.cend() &&
+      iter_strategy_targets->second.size() == 0) {
+    error_flag.err_missing_value_for_strategy_targets_ctrl_arg = true;
+  }
+
+  if (iter_pity_curve != arg_map.cend() &&
+      iter_pity_curve->second.size() == 0) {
+    error_flag.err_missing_value_for_pity_curve_ctrl_arg = true;
+  }
+
+  if (iter_trace != arg_map.cend() && iter_trace->second.size() == 0) {
+    error_flag.err_missing_value_for_trace_ctrl_arg = true;
+  }
+
+  if (iter_worker != arg_map.cend() && iter_worker->second.size() == 0) {
+    error_flag.err_missing_value_for_worker_ctrl_arg = true;
+  }
+
+  if (iter_isa != arg_map.cend() && iter_isa->second.size() == 0) {
+    error_flag.err_missing_value_for_isa_ctrl_arg = true;
+  }
+
   // Check the format of specific value for control arguments that expect one.
   // If the format is correct, then retrieve the argument value by converting
   // string to integer
@@ -502,8 +945,10 @@ bool process_cmd_input_and_set_corres_var(
         error_flag.err_invalid_value_for_current_pull_ctrl_arg = true;
       }
       // Now we need to check whether the value of -c|--current-pull exceeds its
-      // biggest valid value, i.e., <-p|--pity + 49>
-      if (current_pull_temp >= pity_starting_temp + steps_to_guaranteed_star6) {
+      // biggest valid value, i.e., <-p|--pity + 49>. The pity curve is
+      // checked after it is loaded
+      if (current_pull_temp >= pity_starting_temp + steps_to_guaranteed_star6 &&
+          iter_pity_curve == arg_map.cend()) {
         error_flag.err_invalid_value_for_current_pull_ctrl_arg = true;
       }
     }
@@ -522,12 +967,129 @@ bool process_cmd_input_and_set_corres_var(
           current_pull_temp_compare < 0) {
         error_flag.err_invalid_value_for_current_pull_ctrl_arg = true;
       }
-      if (current_pull_temp >= pity_starting_temp + steps_to_guaranteed_star6) {
+      if (current_pull_temp >= pity_starting_temp + steps_to_guaranteed_star6 &&
+          iter_pity_curve == arg_map.cend()) {
         error_flag.err_invalid_value_for_current_pull_long_name_ctrl_arg = true;
       }
     }
   }
 
+  if (iter_kernel != arg_map.cend() &&
+      (iter_kernel->second.size() > 1 ||
+       (iter_kernel->second.size() == 1 &&
+        !is_valid_kernel_name(iter_kernel->second[0])))) {
+    error_flag.err_invalid_value_for_kernel_ctrl_arg = true;
+  }
+  if (iter_analyze != arg_map.cend() && iter_analyze->second.size() > 1) {
+    error_flag.err_invalid_value_for_analyze_ctrl_arg = true;
+  }
+  if (iter_pity_curve != arg_map.cend() && iter_pity_curve->second.size() > 1) {
+    error_flag.err_invalid_value_for_pity_curve_ctrl_arg = true;
+  }
+  if (iter_trace != arg_map.cend() && iter_trace->second.size() > 1) {
+    error_flag.err_invalid_value_for_trace_ctrl_arg = true;
+  }
+  if (iter_worker != arg_map.cend() &&
+      (iter_worker->second.size() > 1 ||
+       (iter_worker->second.size() == 1 &&
+        !is_valid_worker_address(iter_worker->second[0])))) {
+    error_flag.err_invalid_value_for_worker_ctrl_arg = true;
+  }
+  if (iter_isa != arg_map.cend()) {
+    const std::vector<std::string> supported_isas =
+        get_supported_kernel_isas();
+    if (iter_isa->second.size() > 1 ||
+        (iter_isa->second.size() == 1 &&
+         std::find(supported_isas.begin(), supported_isas.end(),
+                   iter_isa->second[0]) == supported_isas.end())) {
+      error_flag.err_invalid_value_for_isa_ctrl_arg = true;
+    }
+  }
+  if (iter_shm != arg_map.cend() &&
+      (iter_shm->second.size() > 1 ||
+       (iter_shm->second.size() == 1 &&
+        !is_valid_shared_result_name(iter_shm->second[0])))) {
+    error_flag.err_invalid_value_for_shm_ctrl_arg = true;
+  }
+
+  unsigned long long int bootstrap_temp = 0;
+  long long int bootstrap_temp_compare = 0;
+  if (iter_bootstrap != arg_map.cend()) {
+    if (iter_bootstrap->second.size() > 1) {
+      error_flag.err_invalid_value_for_bootstrap_ctrl_arg = true;
+    } else if (iter_bootstrap->second.size() > 0) {
+      char* p_end = nullptr;
+      char* p_end_compare = nullptr;
+      bootstrap_temp =
+          strtoull(iter_bootstrap->second[0].c_str(), &p_end, 10);
+      bootstrap_temp_compare =
+          strtoll(iter_bootstrap->second[0].c_str(), &p_end_compare, 10);
+      if (*p_end != '\0' || *p_end_compare != '\0' ||
+          bootstrap_temp_compare <= 0 ||
+          bootstrap_temp > max_bootstrap_resample_num) {
+        error_flag.err_invalid_value_for_bootstrap_ctrl_arg = true;
+      }
+    }
+  }
+
+  unsigned long long int time_budget_temp = 0;
+  long long int time_budget_temp_compare = 0;
+  if (iter_time_budget != arg_map.cend()) {
+    if (iter_time_budget->second.size() > 1) {
+      error_flag.err_invalid_value_for_time_budget_ctrl_arg = true;
+    } else if (iter_time_budget->second.size() > 0) {
+      char* p_end = nullptr;
+      char* p_end_compare = nullptr;
+      time_budget_temp =
+          strtoull(iter_time_budget->second[0].c_str(), &p_end, 10);
+      time_budget_temp_compare =
+          strtoll(iter_time_budget->second[0].c_str(), &p_end_compare, 10);
+      if (*p_end != '\0' || *p_end_compare != '\0' ||
+          time_budget_temp_compare <= 0 ||
+          time_budget_temp > max_time_budget) {
+        error_flag.err_invalid_value_for_time_budget_ctrl_arg = true;
+      }
+    }
+  }
+
+  unsigned long long int strategy_temp = 0;
+  long long int strategy_temp_compare = 0;
+  if (iter_strategy != arg_map.cend()) {
+    if (iter_strategy->second.size() > 1) {
+      error_flag.err_invalid_value_for_strategy_ctrl_arg = true;
+    } else if (iter_strategy->second.size() > 0) {
+      char* p_end = nullptr;
+      char* p_end_compare = nullptr;
+      strategy_temp = strtoull(iter_strategy->second[0].c_str(), &p_end, 10);
+      strategy_temp_compare =
+          strtoll(iter_strategy->second[0].c_str(), &p_end_compare, 10);
+      if (*p_end != '\0' || *p_end_compare != '\0' ||
+          strategy_temp_compare <= 0 || strategy_temp > max_strategy_budget) {
+        error_flag.err_invalid_value_for_strategy_ctrl_arg = true;
+      }
+    }
+  }
+
+  unsigned long long int strategy_targets_temp = 0;
+  long long int strategy_targets_temp_compare = 0;
+  if (iter_strategy_targets != arg_map.cend()) {
+    if (iter_strategy_targets->second.size() > 1) {
+      error_flag.err_invalid_value_for_strategy_targets_ctrl_arg = true;
+    } else if (iter_strategy_targets->second.size() > 0) {
+      char* p_end = nullptr;
+      char* p_end_compare = nullptr;
+      strategy_targets_temp =
+          strtoull(iter_strategy_targets->second[0].c_str(), &p_end, 10);
+      strategy_targets_temp_compare = strtoll(
+          iter_strategy_targets->second[0].c_str(), &p_end_compare, 10);
+      if (*p_end != '\0' || *p_end_compare != '\0' ||
+          strategy_targets_temp_compare <= 0 ||
+          strategy_targets_temp > max_strategy_target_num) {
+        error_flag.err_invalid_value_for_strategy_targets_ctrl_arg = true;
+      }
+    }
+  }
+
   // Check whether there is unexpected values for the control
   // arguments --standard and --limited
   if (arg_map.count("--standard") == 1 && arg_map["--standard"].size() != 0) {
@@ -536,6 +1098,39 @@ bool process_cmd_input_and_set_corres_var(
   if (arg_map.count("--limited") == 1 && arg_map["--limited"].size() != 0) {
     error_flag.err_unexpected_value_for_ctrl_arg_limited = true;
   }
+  if (arg_map.count("--perf-stats") == 1 &&
+      arg_map["--perf-stats"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_perf_stats = true;
+  }
+  if (arg_map.count("--all-current-pull") == 1 &&
+      arg_map["--all-current-pull"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_all_current_pull = true;
+  }
+  if (arg_map.count("--kernel-info") == 1 &&
+      arg_map["--kernel-info"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_kernel_info = true;
+  }
+  if (arg_map.count("--rarity") == 1 && arg_map["--rarity"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_rarity = true;
+  }
+  if (arg_map.count("--pipeline") == 1 && arg_map["--pipeline"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_pipeline = true;
+  }
+  if (arg_map.count("--instant") == 1 && arg_map["--instant"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_instant = true;
+  }
+  if (arg_map.count("--recycle-bits") == 1 &&
+      arg_map["--recycle-bits"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_recycle_bits = true;
+  }
+  if (arg_map.count("--sensitivity") == 1 &&
+      arg_map["--sensitivity"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_sensitivity = true;
+  }
+  if (arg_map.count("--control-variates") == 1 &&
+      arg_map["--control-variates"].size() != 0) {
+    error_flag.err_unexpected_value_for_ctrl_arg_control_variates = true;
+  }
 
   display_error_detail(error_flag);
 
@@ -586,6 +1181,103 @@ bool process_cmd_input_and_set_corres_var(
       assert(iter_current_pull_long_name->second.size() == 1);
       current_pull = current_pull_temp;
     }
+    // Set the value of --perf-stats
+    if (arg_map.find("--perf-stats") != arg_map.end()) {
+      simulation_option.perf_stats = true;
+    }
+    // Set the value of --kernel
+    if (iter_kernel != arg_map.cend()) {
+      assert(iter_kernel->second.size() == 1);
+      simulation_option.kernel = iter_kernel->second[0];
+    }
+    // Set the value of --analyze
+    if (iter_analyze != arg_map.cend()) {
+      assert(iter_analyze->second.size() == 1);
+      simulation_option.analyze_log_path = iter_analyze->second[0];
+    }
+    // Set the value of --bootstrap
+    if (iter_bootstrap != arg_map.cend()) {
+      assert(iter_bootstrap->second.size() == 1);
+      simulation_option.bootstrap_resample_num = bootstrap_temp;
+    }
+    // Set the value of --all-current-pull
+    if (arg_map.find("--all-current-pull") != arg_map.end()) {
+      simulation_option.all_current_pull = true;
+    }
+    // Set the value of --kernel-info
+    if (arg_map.find("--kernel-info") != arg_map.end()) {
+      simulation_option.kernel_info = true;
+    }
+    // Set the value of --rarity
+    if (arg_map.find("--rarity") != arg_map.end()) {
+      simulation_option.rarity = true;
+    }
+    // Set the value of --pipeline
+    if (arg_map.find("--pipeline") != arg_map.end()) {
+      simulation_option.pipeline = true;
+    }
+    // Set the value of --instant
+    if (arg_map.find("--instant") != arg_map.end()) {
+      simulation_option.instant = true;
+    }
+    // Set the value of --recycle-bits
+    if (arg_map.find("--recycle-bits") != arg_map.end()) {
+      simulation_option.recycle_bits = true;
+    }
+    // Set the value of --sensitivity
+    if (arg_map.find("--sensitivity") != arg_map.end()) {
+      simulation_option.sensitivity = true;
+    }
+    // Set the value of --control-variates
+    if (arg_map.find("--control-variates") != arg_map.end()) {
+      simulation_option.control_variates = true;
+    }
+    // Set the value of --time-budget. The simulation runs until it is
+    // stopped, hence its number of pulls is unlimited
+    if (iter_time_budget != arg_map.cend()) {
+      assert(iter_time_budget->second.size() == 1);
+      simulation_option.time_budget = time_budget_temp;
+      total_pull_time = ~0ULL;
+    }
+    // Set the value of --shm
+    if (iter_shm != arg_map.cend()) {
+      assert(iter_shm->second.size() == 1);
+      simulation_option.shm_name = iter_shm->second[0];
+    }
+    // Set the value of --strategy and --strategy-targets
+    if (iter_strategy != arg_map.cend()) {
+      assert(iter_strategy->second.size() == 1);
+      simulation_option.strategy_budget = strategy_temp;
+    }
+    if (iter_strategy_targets != arg_map.cend()) {
+      assert(iter_strategy_targets->second.size() == 1);
+      simulation_option.strategy_target_num =
+          static_cast<unsigned int>(strategy_targets_temp);
+    }
+    // Set the value of --pity-curve, which runs the table kernel unless
+    // --kernel lanes is given
+    if (iter_pity_curve != arg_map.cend()) {
+      assert(iter_pity_curve->second.size() == 1);
+      simulation_option.pity_curve_path = iter_pity_curve->second[0];
+      if (simulation_option.kernel != kernel_lanes) {
+        simulation_option.kernel = kernel_table;
+      }
+    }
+    // Set the value of --trace
+    if (iter_trace != arg_map.cend()) {
+      assert(iter_trace->second.size() == 1);
+      simulation_option.trace_path = iter_trace->second[0];
+    }
+    // Set the value of --worker
+    if (iter_worker != arg_map.cend()) {
+      assert(iter_worker->second.size() == 1);
+      simulation_option.worker_address = iter_worker->second[0];
+    }
+    // Set the value of --isa
+    if (iter_isa != arg_map.cend()) {
+      assert(iter_isa->second.size() == 1);
+      simulation_option.kernel_isa = iter_isa->second[0];
+    }
   }
 
   return !error_flag.check_err();
@@ -595,11 +1287,30 @@ bool process_cmd_input_and_set_corres_var(
 void display_simulation_settings(const ProbabilityWrapper& probability_wrapper,
                                  const unsigned long long int total_pull_time,
                                  const unsigned int pity_starting_point,
-                                 const unsigned long long int current_pull) {
+                                 const unsigned long long int current_pull,
+                                 const SimulationOption& simulation_option) {
   std::cout << "The simulation settings are:\n";
-  std::cout << "\tTotal Pulling Times: " << total_pull_time << "\n";
-  std::cout << "\tPity System Starting Point: " << pity_starting_point << "\n";
-  std::cout << "\tCurrent Pull Times: " << current_pull << "\n";
+  if (simulation_option.instant) {
+    // No pull is simulated
+  } else if (!simulation_option.worker_address.empty()) {
+    std::cout << "\tCoordinator: " << simulation_option.worker_address
+              << "\n";
+  } else if (simulation_option.time_budget > 0) {
+    std::cout << "\tTime Budget: " << simulation_option.time_budget << " s\n";
+  } else {
+    std::cout << "\tTotal Pulling Times: " << total_pull_time << "\n";
+  }
+  if (!simulation_option.pity_curve_path.empty()) {
+    std::cout << "\tPity Curve: " << simulation_option.pity_curve_path << "\n";
+  } else {
+    std::cout << "\tPity System Starting Point: " << pity_starting_point
+              << "\n";
+  }
+  if (simulation_option.all_current_pull) {
+    std::cout << "\tCurrent Pull Times: All\n";
+  } else {
+    std::cout << "\tCurrent Pull Times: " << current_pull << "\n";
+  }
 
   if (probability_wrapper.get_on_banner_star6_conditional_rate() ==
       limited_banner_on_banner_star6_conditional_rate) {
@@ -613,30 +1324,149 @@ void display_simulation_settings(const ProbabilityWrapper& probability_wrapper,
               << " %\n";
   }
   std::cout << "\tRate-Up Operator(s): "
-            << probability_wrapper.get_banner_operator_num() << " operator(s)\n"
+            << probability_wrapper.get_banner_operator_num() << " operator(s)\n";
+  if (simulation_option.strategy_budget > 0) {
+    std::cout << "\tStrategy Budget: " << simulation_option.strategy_budget
+              << " pulls\n";
+    std::cout << "\tWanted Copies on Each Banner: "
+              << simulation_option.strategy_target_num << "\n";
+  } else if (simulation_option.rarity) {
+    std::cout << "\tSimulation Kernel: rarity (" << get_kernel_isa() << ")\n";
+  } else if (simulation_option.sensitivity) {
+    std::cout << "\tSimulation Kernel: sensitivity (" << get_kernel_isa()
+              << ")\n";
+  } else if (simulation_option.control_variates) {
+    std::cout << "\tSimulation Kernel: control variates (" << get_kernel_isa()
+              << ")\n";
+  } else if (!simulation_option.trace_path.empty()) {
+    std::cout << "\tSimulation Kernel: trace (" << get_kernel_isa() << ")\n";
+    std::cout << "\tTrace File: " << simulation_option.trace_path << "\n";
+  } else if (simulation_option.instant) {
+    std::cout << "\tSimulation Kernel: none, the exact probabilities are built "
+                 "into the program\n";
+  } else if (!simulation_option.all_current_pull) {
+    std::cout << "\tSimulation Kernel: " << simulation_option.kernel << " ("
+              << get_kernel_isa()
+              << (simulation_option.pipeline ? ", pipelined" : "")
+              << (simulation_option.recycle_bits ? ", recycled bits" : "")
+              << ")\n";
+  }
+  if (simulation_option.bootstrap_resample_num > 0) {
+    std::cout << "\tBootstrap Resamples: "
+              << simulation_option.bootstrap_resample_num << "\n";
+  }
+  if (!simulation_option.shm_name.empty()) {
+    std::cout << "\tShared Memory Segment: /" << simulation_option.shm_name
+              << "\n";
+  }
+  std::cout << std::endl;
+}
+
+// Display the instruction set variants of the kernels
+void display_kernel_info() {
+  std::cout << "KERNEL INFO" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Built instruction set variants:";
+  for (const std::string& isa : get_built_kernel_isas()) {
+    std::cout << " " << isa;
+  }
+  std::cout << std::endl;
+  std::cout << "Supported by this CPU:";
+  for (const std::string& isa : get_supported_kernel_isas()) {
+    std::cout << " " << isa;
+  }
+  std::cout << std::endl;
+  std::cout << "Selected variant: " << get_kernel_isa() << std::endl;
+}
+
+// Display the hardware event statistics collected during the simulation.
+// Fall back to the wall clock based statistics if no counter is available
+void display_perf_stats(const PerfCounter& perf_counter,
+                        const unsigned long long int total_pull_time,
+                        const struct timespec& start,
+                        const struct timespec& end) {
+  std::cout << "PERFORMANCE COUNTERS" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Time per pull: "
+            << calc_time(start, end) * 1000000000.0 / total_pull_time << " ns"
             << std::endl;
+  if (!perf_counter.get_unavailable_reason().empty()) {
+    std::cout << "Note: Some hardware counters are unavailable ("
+              << perf_counter.get_unavailable_reason() << ")" << std::endl;
+  }
+  if (perf_counter.is_cycles_available()) {
+    std::cout << "Cycles per pull: "
+              << static_cast<double>(perf_counter.get_cycles()) /
+                     total_pull_time
+              << std::endl;
+  }
+  if (perf_counter.is_cycles_available() &&
+      perf_counter.is_instructions_available() &&
+      perf_counter.get_cycles() != 0) {
+    std::cout << "Instructions per cycle (IPC): "
+              << static_cast<double>(perf_counter.get_instructions()) /
+                     perf_counter.get_cycles()
+              << std::endl;
+  }
+  if (perf_counter.is_branch_misses_available()) {
+    std::cout << "Branch misses per pull: "
+              << static_cast<double>(perf_counter.get_branch_misses()) /
+                     total_pull_time
+              << std::endl;
+  }
+  if (perf_counter.is_cache_misses_available()) {
+    std::cout << "Cache misses per pull: "
+              << static_cast<double>(perf_counter.get_cache_misses()) /
+                     total_pull_time
+              << std::endl;
+  }
 }
 
-// Display the simulation results
-void display_simulation_results(
-    const std::vector<unsigned long long int>& result,
-    std::unordered_map<unsigned long long int, unsigned long long int>&
-        rare_event,
-    unsigned long long int star6_count,
-    unsigned long long int target_star6_count, unsigned int seed,
-    const struct timespec& start, const struct timespec& end) {
+// Display the summary of a simulation
+// perf_counter is nullptr if the hardware events are not counted
+void display_simulation_summary(const SimulationState& state,
+                                uint_fast64_t seed,
+                                const struct timespec& start,
+                                const struct timespec& end,
+                                const unsigned long long int total_pull_time,
+                                const PerfCounter* perf_counter) {
   std::cout << "...finished\n" << std::endl;
 
   // Simulation summary
   std::cout << "SIMULATION SUMMARY" << std::endl;
   std::cout << "-------------------------" << std::endl;
   std::cout << "Time spent: " << calc_time(start, end) << "s" << std::endl;
+  std::cout << "Pulls completed: " << total_pull_time << std::endl;
   std::cout << "Random seed for this simulation: " << seed << std::endl;
-  std::cout << "Star 6 times: " << star6_count << std::endl;
-  std::cout << "Target star 6 times: " << target_star6_count << std::endl;
+  std::cout << "Star 6 times: " << state.star6_count << std::endl;
+  std::cout << "Target star 6 times: " << state.target_star6_count
+            << std::endl;
 
   std::cout << std::endl;
 
+  if (perf_counter != nullptr) {
+    display_perf_stats(*perf_counter, total_pull_time, start, end);
+    std::cout << std::endl;
+  }
+}
+
+// Display the simulation results
+// perf_counter is nullptr if the hardware events are not counted, and
+// bootstrap_interval is nullptr if the confidence intervals are not calculated
+void display_simulation_results(
+    const SimulationState& state, uint_fast64_t seed,
+    const struct timespec& start, const struct timespec& end,
+    const unsigned long long int total_pull_time,
+    const PerfCounter* perf_counter,
+    const BootstrapInterval* bootstrap_interval) {
+  const std::vector<unsigned long long int>& result = state.result;
+  const std::unordered_map<unsigned long long int, unsigned long long int>&
+      rare_event = state.rare_event;
+  const unsigned long long int target_star6_count = state.target_star6_count;
+
+  display_simulation_summary(state, seed, start, end, total_pull_time,
+                             perf_counter);
+
   // Displaying raw data
   std::cout << "RAW DATA" << std::endl;
   std::cout << "-------------------------" << std::endl;
@@ -697,13 +1527,25 @@ void display_simulation_results(
   // that you succeed *on* N-th pull
   std::cout << "ESTIMATED PROBABILITY" << std::endl;
   std::cout << "-------------------------" << std::endl;
+  if (bootstrap_interval != nullptr) {
+    std::cout << "Note: The brackets show the "
+              << bootstrap_confidence_level * 100
+              << " % percentile intervals of "
+              << bootstrap_interval->resample_num
+              << " bootstrap resamples of " << bootstrap_interval->batch_num
+              << " batches" << std::endl;
+  }
   for (unsigned int i = 1;
        i < std::min(estimated_prob_showing_limit, result.size());
        ++i) {  // skip the unused index 0
 
     std::cout << "Pr(S_" << i
-              << ") = " << (100.0 * result[i]) / target_star6_count << " %"
-              << std::endl;
+              << ") = " << (100.0 * result[i]) / target_star6_count << " %";
+    if (bootstrap_interval != nullptr) {
+      std::cout << "  [" << bootstrap_interval->lower_s[i] << " %, "
+                << bootstrap_interval->upper_s[i] << " %]";
+    }
+    std::cout << std::endl;
   }
 
   std::cout << std::endl;
@@ -718,8 +1560,345 @@ void display_simulation_results(
     cumulated_probability += result[i];
     std::cout << "Pr(W_" << i
               << ") = " << (100.0 * cumulated_probability) / target_star6_count
+              << " %";
+    if (bootstrap_interval != nullptr) {
+      std::cout << "  [" << bootstrap_interval->lower_w[i] << " %, "
+                << bootstrap_interval->upper_w[i] << " %]";
+    }
+    std::cout << std::endl;
+  }
+}
+
+// Display the exact probabilities of --instant, where distribution[i] is
+// Pr(S_i) for i in [1, result_size)
+void display_instant_results(const double* distribution) {
+  std::cout << "INSTANT RESULTS" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Note: The exact probabilities of this default banner are built "
+               "into the program, no\n      simulation is run"
+            << std::endl;
+  std::cout << std::endl;
+
+  std::cout << "EXACT PROBABILITY" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  for (size_t i = 1; i < std::min(estimated_prob_showing_limit, result_size);
+       ++i) {
+    std::cout << "Pr(S_" << i << ") = " << 100.0 * distribution[i] << " %"
+              << std::endl;
+  }
+
+  std::cout << std::endl;
+
+  double cumulated_probability = 0.0;
+  std::cout << "CUMULATED PROBABILITY" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  for (size_t i = 1; i < std::min(estimated_prob_showing_limit, result_size);
+       ++i) {
+    cumulated_probability += distribution[i];
+    std::cout << "Pr(W_" << i << ") = " << 100.0 * cumulated_probability
               << " %" << std::endl;
   }
 }
 
+// Display the results of --all-current-pull, one row per current pull
+// perf_counter is nullptr if the hardware events are not counted
+void display_current_pull_table_results(
+    const SimulationState& state, const CurrentPullTable& table,
+    uint_fast64_t seed, const struct timespec& start,
+    const struct timespec& end, const unsigned long long int total_pull_time,
+    const PerfCounter* perf_counter) {
+  display_simulation_summary(state, seed, start, end, total_pull_time,
+                             perf_counter);
+
+  // Pr(W_i) reported in the table
+  const size_t cumulated_prob_column[] = {10, 50, 100};
+  // Quantiles of the number of pulls reported in the table
+  const double quantile_column[] = {0.5, 0.9, 0.99};
+
+  std::cout << "ALL CURRENT PULL" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Each row is a trial that starts with the given current pull. "
+               "Pn is the smallest N that\nPr(W_N) >= n %"
+            << std::endl;
+  std::cout << "Current\tSamples\tMean\tP50\tP90\tP99";
+  for (size_t i : cumulated_prob_column) {
+    std::cout << "\tPr(W_" << i << ")";
+  }
+  std::cout << std::endl;
+
+  for (unsigned long long int c = 0; c < table.state_num; ++c) {
+    const unsigned long long int* result = &table.result[c * result_size];
+    const double n = static_cast<double>(table.trial_count[c]);
+    std::cout << c << '\t' << table.trial_count[c];
+    if (table.trial_count[c] == 0) {
+      std::cout << std::endl;
+      continue;
+    }
+
+    double mean = 0.0;
+    for (size_t i = 1; i < result_size; ++i) {
+      mean += static_cast<double>(i) * result[i] / n;
+    }
+    std::cout << '\t' << mean;
+
+    unsigned long long int cumulated = 0;
+    size_t i = 1;
+    for (double quantile : quantile_column) {
+      while (i < result_size && cumulated + result[i] < quantile * n) {
+        cumulated += result[i];
+        ++i;
+      }
+      std::cout << '\t' << i;
+    }
+
+    for (size_t column : cumulated_prob_column) {
+      cumulated = 0;
+      for (size_t j = 1; j <= column && j < result_size; ++j) {
+        cumulated += result[j];
+      }
+      std::cout << '\t' << 100.0 * cumulated / n << " %";
+    }
+    std::cout << std::endl;
+  }
+}
+
+// Display the outcome classes counted by --rarity, following the results of
+// the target star 6 operator
+void display_rarity_results(const RarityStatistics& statistics,
+                            const ProbabilityWrapper& probability_wrapper,
+                            const unsigned long long int total_pull_time) {
+  // Quantiles of the times of an outcome class in a trial
+  const double quantile_column[] = {0.5, 0.9, 0.99};
+
+  unsigned long long int trial_num = 0;
+  for (size_t k = 0; k < outcome_histogram_size; ++k) {
+    trial_num += statistics.histogram[k];
+  }
+
+  std::cout << std::endl;
+  std::cout << "RARITY DISTRIBUTION" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Share is the rate of all pulls. Mean and Pn are the times of "
+               "the outcome in a trial\n(until the target star 6 operator), "
+               "over "
+            << trial_num << " finished trials" << std::endl;
+  std::cout << "Outcome			Pulls		Share		Mean	P50	P90	P99"
+            << std::endl;
+  for (unsigned int outcome = 0; outcome < outcome_num; ++outcome) {
+    // Only one operator is rated up
+    if (outcome == outcome_other_rate_up_star6 &&
+        probability_wrapper.get_banner_operator_num() == 1) {
+      continue;
+    }
+    const unsigned long long int* histogram =
+        &statistics.histogram[outcome * outcome_histogram_size];
+    const unsigned long long int count =
+        statistics.outcome_count[outcome] +
+        statistics.trial_outcome_count[outcome];
+    // Align the names to the third tab stop
+    std::cout << outcome_name[outcome]
+              << std::string(1 + (23 - outcome_name[outcome].size()) / 8, '\t')
+              << count << (count < 10000000 ? "\t\t" : "\t")
+              << 100.0 * count / total_pull_time << " %";
+    if (trial_num == 0) {
+      std::cout << std::endl;
+      continue;
+    }
+
+    double mean = 0.0;
+    for (size_t k = 0; k < outcome_histogram_size; ++k) {
+      mean += static_cast<double>(k) * histogram[k] / trial_num;
+    }
+    std::cout << '\t' << mean;
+
+    unsigned long long int cumulated = histogram[0];
+    size_t k = 0;
+    for (double quantile : quantile_column) {
+      while (k + 1 < outcome_histogram_size && cumulated < quantile * trial_num) {
+        ++k;
+        cumulated += histogram[k];
+      }
+      std::cout << '\t' << k;
+    }
+    std::cout << std::endl;
+  }
+}
+
+// Display the generator calls of --recycle-bits, following the results of
+// the target star 6 operator. Without it, every pull takes one call
+void display_recycled_bits_results(const RecycledPullGenerator& generator,
+                                   const unsigned long long int total_pull_time) {
+  std::cout << std::endl;
+  std::cout << "RECYCLED BITS" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Generator calls: " << generator.generator_call_count
+            << std::endl;
+  if (total_pull_time > 0) {
+    std::cout << "Generator calls per pull: "
+              << static_cast<double>(generator.generator_call_count) /
+                     total_pull_time
+              << " (1 without --recycle-bits)" << std::endl;
+  }
+}
+
+// Display the derivatives estimated by --sensitivity, following the results
+// of the target star 6 operator
+void display_sensitivity_results(const SimulationState& state,
+                                 const SensitivityStatistics& statistics) {
+  for (unsigned int k = 0; k < sensitivity_parameter_num; ++k) {
+    const SensitivityEstimate estimate =
+        estimate_sensitivity(state, statistics, k);
+    std::cout << std::endl;
+    std::cout << "SENSITIVITY TO " << sensitivity_parameter_name[k]
+              << std::endl;
+    std::cout << "-------------------------" << std::endl;
+    std::cout << "Note: Changing " << sensitivity_parameter_name[k]
+              << " by d (e.g., 0.002 for 0.2 %) changes a probability by about d\n"
+                 "      times its derivative. The numbers after +- are the standard errors"
+              << std::endl;
+    std::cout << "d(Mean pulls per trial) = " << estimate.derivative_mean_pull
+              << std::endl;
+    for (size_t i = 1; i < std::min(estimated_prob_showing_limit, result_size);
+         ++i) {
+      std::cout << "dPr(S_" << i << ") = " << estimate.derivative_s[i]
+                << " +- " << estimate.standard_error_s[i] << "\tdPr(W_" << i
+                << ") = " << estimate.derivative_w[i] << " +- "
+                << estimate.standard_error_w[i] << std::endl;
+    }
+  }
+}
+
+// Display the probabilities corrected by --control-variates, following the
+// results of the target star 6 operator
+void display_control_variate_results(
+    const SimulationState& state, const ControlVariateStatistics& statistics,
+    const ControlVariateModel& model) {
+  const ControlVariateEstimate estimate =
+      estimate_control_variates(state, statistics, model);
+  const size_t showing_limit =
+      std::min(estimated_prob_showing_limit, result_size);
+
+  std::cout << std::endl;
+  std::cout << "CONTROL VARIATES" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  for (unsigned int a = 0; a < control_variate_num; ++a) {
+    std::cout << "Mean " << control_variate_name[a] << ": "
+              << estimate.observed_mean[a] << " (exact " << model.mean[a]
+              << ")" << std::endl;
+  }
+  // The variance left on average over the shown probabilities
+  double variance_ratio_s = 0.0;
+  double variance_ratio_w = 0.0;
+  for (size_t i = 1; i < showing_limit; ++i) {
+    variance_ratio_s += estimate.variance_ratio_s[i];
+    variance_ratio_w += estimate.variance_ratio_w[i];
+  }
+  variance_ratio_s /= showing_limit - 1;
+  variance_ratio_w /= showing_limit - 1;
+  std::cout << "Pulls needed for the same precision: "
+            << 100.0 * variance_ratio_s << " % for Pr(S_i), "
+            << 100.0 * variance_ratio_w << " % for Pr(W_i) on average"
+            << std::endl;
+  std::cout << "Note: The probabilities below are moved against the deviation of the means above.\n"
+               "      The numbers after +- are the standard errors, and the brackets show the\n"
+               "      variance left, i.e., the share of the pulls that the plain estimate needs for\n"
+               "      the same precision"
+            << std::endl;
+  for (size_t i = 1; i < showing_limit; ++i) {
+    std::cout << "Pr(S_" << i << ") = " << 100.0 * estimate.prob_s[i]
+              << " % +- " << 100.0 * estimate.standard_error_s[i] << " % ("
+              << 100.0 * estimate.variance_ratio_s[i] << " %)\tPr(W_" << i
+              << ") = " << 100.0 * estimate.prob_w[i] << " % +- "
+              << 100.0 * estimate.standard_error_w[i] << " % ("
+              << 100.0 * estimate.variance_ratio_w[i] << " %)" << std::endl;
+  }
+}
+
+// Display the strategy solved by --strategy and its Monte Carlo evaluation
+void display_strategy_results(const StrategyTable& table,
+                              const StrategyEvaluation& evaluation,
+                              unsigned long long int start_pity,
+                              uint_fast64_t seed, double solve_time,
+                              double evaluation_time) {
+  // Values closer than this are regarded as a tie
+  const double tie_tolerance = 1e-9;
+
+  std::cout << "STRATEGY" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Budget: " << table.budget << " pulls for the current and the "
+               "next banner" << std::endl;
+  std::cout << "Wanted copies of the target star 6 operator on each banner: "
+            << table.target_num << std::endl;
+  std::cout << "Pity counter carried to the next banner: "
+            << (table.carry_pity ? "yes (standard banner)"
+                                 : "no (limited banner)")
+            << std::endl;
+  std::cout << "Pity counters: " << table.state_num << std::endl;
+  std::cout << "Time spent solving: " << solve_time << "s" << std::endl;
+  std::cout << std::endl;
+
+  const double pull = table.pull_value[start_pity];
+  const double save = table.save_value[start_pity];
+  std::cout << "Recommendation at pity counter " << start_pity
+            << " without any copy: ";
+  if (pull - save > tie_tolerance) {
+    std::cout << "pull on the current banner";
+  } else if (save - pull > tie_tolerance) {
+    std::cout << "save for the next banner";
+  } else {
+    std::cout << "either";
+  }
+  std::cout << " (expected wanted copies " << pull << " if pulling, " << save
+            << " if saving)" << std::endl;
+  std::cout << "Expected wanted copies on both banners:" << std::endl;
+  std::cout << "\tOptimal strategy: " << table.optimal_value << std::endl;
+  std::cout << "\tPulling until " << table.target_num
+            << " copies on the current banner: " << table.all_in_value
+            << std::endl;
+  std::cout << "\tSaving the whole budget for the next banner: "
+            << table.save_all_value << std::endl;
+  std::cout << std::endl;
+
+  std::cout << "MONTE CARLO EVALUATION" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Time spent: " << evaluation_time << "s" << std::endl;
+  std::cout << "Random seed for this simulation: " << seed << std::endl;
+  std::cout << "Pulls completed: " << evaluation.pull_count << std::endl;
+  std::cout << "Episodes: " << evaluation.episode_num << std::endl;
+  std::cout << "Mean wanted copies of the optimal strategy: " << evaluation.mean
+            << " (standard error " << evaluation.standard_error << ")"
+            << std::endl;
+  std::cout << "Mean pulls on the current banner: "
+            << evaluation.mean_current_pull << std::endl;
+  std::cout << std::endl;
+
+  std::cout << "POLICY AT THE FULL BUDGET" << std::endl;
+  std::cout << "-------------------------" << std::endl;
+  std::cout << "Each row is a pity counter, each column is the copies got on "
+               "the current banner"
+            << std::endl;
+  std::cout << "Pity";
+  for (unsigned int k = 0; k < table.target_num; ++k) {
+    std::cout << '\t' << k;
+  }
+  std::cout << std::endl;
+  const unsigned long long int row_num = std::min<unsigned long long int>(
+      table.state_num, estimated_prob_showing_limit);
+  for (unsigned long long int p = 0; p < row_num; ++p) {
+    std::cout << p;
+    for (unsigned int k = 0; k < table.target_num; ++k) {
+      const double pull_value = table.pull_value[k * table.state_num + p];
+      const double save_value = table.save_value[k * table.state_num + p];
+      if (pull_value - save_value > tie_tolerance) {
+        std::cout << "\tpull";
+      } else if (save_value - pull_value > tie_tolerance) {
+        std::cout << "\tsave";
+      } else {
+        std::cout << "\teither";
+      }
+    }
+    std::cout << std::endl;
+  }
+}
+
 #endif  // UTILS_H
\ No newline at end of file